@@ -27,6 +27,8 @@
 #  include <ostream> // operator<<
 #  include <sstream> // forth::to_string()
 #  include <iomanip> // setprecision
+#  include <cstring> // memcpy
+#  include <type_traits> // is_same
 #  include <math.h>
 
 namespace forth
@@ -43,11 +45,27 @@ using Real = double;
 //! cells for passing parameters to words (aka functions). In classic Forth a
 //! cell size is 16 bits but in SimForth a Cell is an union between an integer
 //! and a real value and the integer shall be enough large to hold a C++ pointer.
+//!
+//! By default the union is completed by a tag and a Cell uses 16 bytes. When
+//! USE_PACKED_CELL is defined a Cell uses 8 bytes (NaN-boxing): floating point
+//! values are stored unchanged and integers are stored inside the payload of
+//! a NaN which is never produced by floating point operations. Integers are
+//! then 50-bit values (enough for holding pointers). Libraries and
+//! applications shall be compiled with the same mode.
 //******************************************************************************
 struct Cell // TODO routines for endian
 {
 public:
 
+#  ifdef USE_PACKED_CELL
+    //--------------------------------------------------------------------------
+    //! \brief Greatest integer value a cell can hold.
+    //--------------------------------------------------------------------------
+    static constexpr Int MAX_INTEGER = (Int(1) << 49) - 1;
+#  else
+    static constexpr Int MAX_INTEGER = INT64_MAX;
+#  endif
+
     //--------------------------------------------------------------------------
     //! \brief Static method for creating a new integer cell.
     //--------------------------------------------------------------------------
@@ -61,6 +79,21 @@ public:
     //--------------------------------------------------------------------------
     //! \brief Constructor. Initialize an integer cell set to 0.
     //--------------------------------------------------------------------------
+#  ifdef USE_PACKED_CELL
+    INLINE Cell()
+        : bits(INTEGER_TAG)
+    {}
+
+    //--------------------------------------------------------------------------
+    //! \brief Check if the cell is an integer value.
+    //--------------------------------------------------------------------------
+    INLINE bool isInteger() const { return (bits & INTEGER_TAG) == INTEGER_TAG; }
+
+    //--------------------------------------------------------------------------
+    //! \brief Check if the cell is a floating point value.
+    //--------------------------------------------------------------------------
+    INLINE bool isReal() const { return (bits & INTEGER_TAG) != INTEGER_TAG; }
+#  else // !USE_PACKED_CELL
     INLINE Cell()
         : i(0), tag(Cell::INTEGER)
     {}
@@ -74,22 +107,27 @@ public:
     //! \brief Check if the cell is a floating point value.
     //--------------------------------------------------------------------------
     INLINE bool isReal() const { return tag == Cell::REAL; }
+#  endif // USE_PACKED_CELL
 
     //--------------------------------------------------------------------------
     //! \brief Return the integer value. If the cell is a floating point value
     //! then return the nearest integer.
     //--------------------------------------------------------------------------
-    INLINE Int integer() const { return isInteger() ? i : nearest(r); }
+    INLINE Int integer() const { return isInteger() ? asInt() : nearest(asReal()); }
 
     //--------------------------------------------------------------------------
     //! \brief Return the floating point value.
     //--------------------------------------------------------------------------
-    INLINE Real real() const { return isReal() ? r : Real(i); }
+    INLINE Real real() const { return isReal() ? asReal() : Real(asInt()); }
 
     //--------------------------------------------------------------------------
     //! \brief Return nth byte of the value.
     //--------------------------------------------------------------------------
-    INLINE char byte(int const nth) { return b[nth]; }
+    INLINE char byte(int const nth) const
+    {
+        Int const v = asBits();
+        return reinterpret_cast<char const*>(&v)[nth];
+    }
 
     //--------------------------------------------------------------------------
     //! \brief Return the cell value converted as a string.
@@ -99,9 +137,9 @@ public:
         std::ostringstream ss;
 
         if (isInteger())
-            ss << i;
+            ss << asInt();
         else
-            ss << r;
+            ss << asReal();
 
         return ss.str();
     }
@@ -126,8 +164,8 @@ public:
     bool operator==(Cell const& n2) const { return doComp(n2, Eq()); }
     bool operator!=(Cell const& n2) const { return doComp(n2, Ne()); }
     Cell& operator&=(Cell const& n2) { doBoolOp(n2, And()); return *this; }
-    Cell& operator++() { if (isInteger()) { i += 1; } else { r += 1.0;} return *this; }
-    Cell& operator--() { if (isInteger()) { i -= 1; } else { r -= 1.0;} return *this; }
+    Cell& operator++() { doOp(Cell(Int(1)), Plus()); return *this; }
+    Cell& operator--() { doOp(Cell(Int(1)), Minus()); return *this; }
 
 private:
 
@@ -135,15 +173,94 @@ private:
     //! \brief Private constructor. Use instead integer(Int).
     //--------------------------------------------------------------------------
     INLINE explicit Cell(Int i_)
-        : i(i_), tag(Cell::INTEGER)
-    {}
+    {
+        setInt(i_);
+    }
 
     //--------------------------------------------------------------------------
     //! \brief Private constructor. Use instead real(r).
     //--------------------------------------------------------------------------
     INLINE explicit Cell(Real r_)
-        : r(r_), tag(Cell::REAL)
-    {}
+    {
+        setReal(r_);
+    }
+
+#  ifdef USE_PACKED_CELL
+    //--------------------------------------------------------------------------
+    //! \brief Return the integer value without checking the type.
+    //! \note arithmetic shift extends the sign of the payload.
+    //--------------------------------------------------------------------------
+    INLINE Int asInt() const { return Int(bits << INTEGER_SHIFT) >> INTEGER_SHIFT; }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the floating point value without checking the type.
+    //--------------------------------------------------------------------------
+    INLINE Real asReal() const
+    {
+        Real r_;
+        memcpy(&r_, &bits, sizeof(r_));
+        return r_;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Store an integer value (bits above the payload are lost).
+    //--------------------------------------------------------------------------
+    INLINE void setInt(Int const i_) { bits = INTEGER_TAG | (uint64_t(i_) & ~INTEGER_TAG); }
+
+    //--------------------------------------------------------------------------
+    //! \brief Store a floating point value. A NaN looking like an integer
+    //! (only possible from C functions) is replaced by the canonical NaN.
+    //--------------------------------------------------------------------------
+    INLINE void setReal(Real const r_)
+    {
+        memcpy(&bits, &r_, sizeof(bits));
+        if ((bits & INTEGER_TAG) == INTEGER_TAG)
+            bits = CANONICAL_NAN;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Does the two cells hold the same type of value ?
+    //--------------------------------------------------------------------------
+    INLINE bool sameType(Cell const& n2) const { return isInteger() == n2.isInteger(); }
+#  else // !USE_PACKED_CELL
+    INLINE Int asInt() const { return i; }
+    INLINE Real asReal() const { return r; }
+    INLINE void setInt(Int const i_) { i = i_; tag = Cell::INTEGER; }
+    INLINE void setReal(Real const r_) { r = r_; tag = Cell::REAL; }
+    INLINE bool sameType(Cell const& n2) const { return tag == n2.tag; }
+#  endif // USE_PACKED_CELL
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the bits of the value (integer or floating point value)
+    //! as an integer. Used by bitwise operations.
+    //--------------------------------------------------------------------------
+    INLINE Int asBits() const
+    {
+        if (isInteger())
+            return asInt();
+
+        Real const r_ = asReal();
+        Int i_;
+        memcpy(&i_, &r_, sizeof(i_));
+        return i_;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Store bits given by asBits() without changing the type.
+    //--------------------------------------------------------------------------
+    INLINE void setBits(Int const i_)
+    {
+        if (isInteger())
+        {
+            setInt(i_);
+        }
+        else
+        {
+            Real r_;
+            memcpy(&r_, &i_, sizeof(r_));
+            setReal(r_);
+        }
+    }
 
     //--------------------------------------------------------------------------
     // Template helpers
@@ -184,34 +301,43 @@ private:
     template<typename OP>
     void doOp(Cell const& n2, OP op)
     {
-        if (tag == n2.tag)
+        if (sameType(n2))
         {
             if (isInteger())
-                i = op.exec(i, n2.i);
+            {
+#  ifdef USE_PACKED_CELL
+                // Modular additions can be made directly on payloads.
+                if constexpr (std::is_same<OP, Plus>::value || std::is_same<OP, Minus>::value)
+                {
+                    bits = INTEGER_TAG | (op.exec(bits, n2.bits) & ~INTEGER_TAG);
+                    return ;
+                }
+#  endif
+                setInt(op.exec(asInt(), n2.asInt()));
+            }
             else
-                r = op.exec(r, n2.r);
+                setReal(op.exec(asReal(), n2.asReal()));
         }
         else
         {
-            r = op.exec(real(), n2.real());
-            tag = Cell::REAL;
+            setReal(op.exec(real(), n2.real()));
         }
     }
 
     template<typename OP>
     void doBoolOp(Cell const& n2, OP op)
     {
-        i = op.exec(i, n2.i);
+        setBits(op.exec(asBits(), n2.asBits()));
     }
 
     template<typename OP>
     bool doComp(Cell const& n2, OP op) const
     {
-        if (tag == n2.tag)
+        if (sameType(n2))
         {
             if (isInteger())
-                return op.exec(i, n2.i);
-            return op.exec(r, n2.r);
+                return op.exec(asInt(), n2.asInt());
+            return op.exec(asReal(), n2.asReal());
         }
         return op.exec(real(), n2.real());
     }
@@ -222,20 +348,31 @@ private:
     friend std::ostream& operator<<(std::ostream& os, const Cell& c)
     {
         if (c.isInteger())
-            os << c.i;
+            os << c.asInt();
         else
-            os << c.r;
+            os << c.asReal();
         return os;
     }
 
 private:
 
+#  ifdef USE_PACKED_CELL
+    //! \brief Number of bits of the tag.
+    static constexpr int INTEGER_SHIFT = 14;
+    //! \brief Negative quiet NaN with the bit 50 set: x86 and ARM FPUs never
+    //! produce it.
+    static constexpr uint64_t INTEGER_TAG = ~uint64_t(0) << (64 - INTEGER_SHIFT);
+    //! \brief NaN returned by 0.0/0.0 on ARM.
+    static constexpr uint64_t CANONICAL_NAN = UINT64_C(0x7ff8000000000000);
+    //! \brief Floating point value or integer boxed in a NaN.
+    uint64_t bits;
+#  else // !USE_PACKED_CELL
     union {
         Int  i; // integer
         Real r; // real
-        char b[sizeof(Real)]; // bytes
     };
     enum Tag { INTEGER, REAL } tag;
+#  endif // USE_PACKED_CELL
 };
 
 namespace size
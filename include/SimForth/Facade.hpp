@@ -38,8 +38,8 @@ class DataStack: public Stack<Cell>
 {
 public:
 
-    DataStack()
-        : Stack<Cell>("Data")
+    DataStack(size_t const depth = size::stack)
+        : Stack<Cell>("Data", depth)
     {}
 };
 
@@ -32,7 +32,20 @@ struct Options
     bool quiet;
     bool show_stack;
     bool traces;
+    bool pipeline;
     std::string path;
+    //! \brief Minimal depths of the data, auxiliary and return stacks.
+    size_t data_stack_depth;
+    size_t auxiliary_stack_depth;
+    size_t return_stack_depth;
+    //! \brief Number of threads running tasks (SPAWN). 0 for the number of
+    //! cores.
+    size_t workers;
+    //! \brief Limits of each call to interpretString() and interpretFile(),
+    //! 0 for no limit. The budget counts calls of secondary words, backward
+    //! branches (loops) and words interpreted. The timeout is in milliseconds.
+    size_t budget;
+    size_t timeout;
 };
 
 } // namespace forth
@@ -23,6 +23,9 @@
 
 #  include "SimForth/Facade.hpp"
 #  include "Interpreter.hpp"
+#  include "Channel.hpp"
+#  include "Binding.hpp"
+#  include "Script.hpp"
 
 //******************************************************************************
 //! \brief Facade class hiding the complexity of other classes such as the
@@ -45,6 +48,21 @@ public:
         m_dictionary->setCountPrimitives(m_interpreter->countPrimitives());
     }
 
+    //--------------------------------------------------------------------------
+    //! \brief Constructor. Start from a dictionary frozen by freeze() on an
+    //! already booted Forth: no boot is needed. Stacks, base, state, heap are
+    //! private to this instance, new definitions are stored in a private
+    //! overlay of the shared dictionary. Instances sharing the same dictionary
+    //! can run on different threads.
+    //--------------------------------------------------------------------------
+    SimForth(forth::SharedDictionary const& dictionary,
+             forth::Options const& options = forth::Options())
+    {
+        m_dictionary = std::make_unique<forth::Dictionary>(dictionary);
+        m_interpreter = std::make_unique<forth::Interpreter>(*m_dictionary, options);
+        m_interpreter->path().add(options.path);
+    }
+
     template<class D, class I>
     void extend(forth::Options const& options = forth::Options())
     {
@@ -92,6 +110,126 @@ public:
     //--------------------------------------------------------------------------
     virtual bool interactive() override;
 
+    //--------------------------------------------------------------------------
+    //! \brief Return a callable executing the given word with typed arguments
+    //! and results, without parsing any script. Signature is a function type
+    //! such as forth::Real(forth::Int, forth::Real); use std::tuple for words
+    //! returning several cells. See forth::Binding.
+    //! \throw forth::Exception if the word does not exist.
+    //--------------------------------------------------------------------------
+    template<typename Signature>
+    forth::Binding<Signature> bind(std::string const& word)
+    {
+        forth::Token xt;
+        bool immediate;
+
+        if (!find(word, xt, immediate))
+            throw forth::Exception("Unknown word " + word);
+        return forth::Binding<Signature>(*m_interpreter, xt);
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Make a function pointer or a lambda callable as the Forth word
+    //! name, with the cost of a primitive: no C compiler, no indirection
+    //! through C-LIB. Arguments and results are cells converted as for
+    //! bind(); a function taking a forth::DataStack& manages the stack
+    //! itself. The stack effect, i.e. "( x y -- z )", is checked at each call.
+    //! \return the execution token of the word.
+    //! \throw forth::Exception if the stack effect does not match the
+    //! signature or if the function cannot be registered.
+    //--------------------------------------------------------------------------
+    template<typename F>
+    forth::Token registerPrimitive(std::string const& name, F&& function,
+                                   std::string const& effect)
+    {
+        return forth::registerPrimitive(*m_interpreter, name,
+                                        std::forward<F>(function), effect);
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Parse and compile a Forth script once, to be executed many times
+    //! with forth::Script::run(). See forth::Script.
+    //! \throw forth::Exception if the script does not compile.
+    //--------------------------------------------------------------------------
+    forth::Script compile(std::string const& script)
+    {
+        return forth::Script(*m_interpreter, script);
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Open a Forth script to be executed by slices with run(), for
+    //! hosts interleaving Forth with their event loop. The script is copied.
+    //! \return false if the previous script is not finished.
+    //--------------------------------------------------------------------------
+    bool start(char const* script);
+
+    //--------------------------------------------------------------------------
+    //! \brief Execute the script given to start() during at most the given
+    //! number of steps (calls of secondary words, backward branches, words
+    //! interpreted), 0 for running until the end. The state of the script is
+    //! kept between slices and no thread is created. Other scripts cannot be
+    //! interpreted before the end of this one.
+    //! \return forth::Status::Running if run() shall be called again, else
+    //! how the script has ended.
+    //--------------------------------------------------------------------------
+    forth::Status run(size_t const steps);
+
+    //--------------------------------------------------------------------------
+    //! \brief Set the number of threads running the tasks created by the
+    //! Forth word SPAWN. 0 (default) for the number of cores. Tasks not yet
+    //! awaited are lost.
+    //--------------------------------------------------------------------------
+    void setWorkers(size_t const count);
+
+    //--------------------------------------------------------------------------
+    //! \brief Take an immutable image of the dictionary, to be shared by
+    //! other SimForth instances (see constructor).
+    //! \note C functions (C-LIB) are bound to this instance: they cannot be
+    //! called from the other instances.
+    //--------------------------------------------------------------------------
+    forth::SharedDictionary freeze() const;
+
+    //--------------------------------------------------------------------------
+    //! \brief Save the whole state of the Forth system (dictionary, stacks,
+    //! base, heap, C functions). Use it once the system is booted then call
+    //! rollback() after each what-if evaluation.
+    //! \return the identifier of the checkpoint.
+    //! \throw forth::Exception if the checkpoint cannot be created.
+    //--------------------------------------------------------------------------
+    size_t checkpoint();
+
+    //--------------------------------------------------------------------------
+    //! \brief Restore the state saved by checkpoint(). Only memory pages
+    //! modified since are copied back. Newer checkpoints are discarded.
+    //! \return false if the checkpoint does not exist.
+    //--------------------------------------------------------------------------
+    bool rollback(size_t const id);
+
+    //--------------------------------------------------------------------------
+    //! \brief Create a channel of cells (same as the Forth word CHANNEL).
+    //! The returned handle can be pushed on the data stack of any SimForth
+    //! instance of the process.
+    //! \return 0 if the channel cannot be created.
+    //--------------------------------------------------------------------------
+    forth::Int createChannel(size_t const capacity);
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the channel referred by the handle for exchanging cells
+    //! with Forth scripts from host threads, or nullptr if the handle is not
+    //! valid.
+    //--------------------------------------------------------------------------
+    forth::Channel* channel(forth::Int const handle);
+
+    //--------------------------------------------------------------------------
+    //! \brief Return how the last interpretation has ended or
+    //! forth::Status::Running while the script given to start() is not
+    //! finished. Set
+    //! options().budget and options().timeout for bounding the next ones:
+    //! scripts exceeding them are aborted with Status::OutOfBudget or
+    //! Status::Timeout and the interpreter stays usable.
+    //--------------------------------------------------------------------------
+    forth::Status status() const;
+
     //--------------------------------------------------------------------------
     //! \brief Get the last error when Forth has detected an error.
     //--------------------------------------------------------------------------
@@ -21,9 +21,17 @@
 #ifndef INTERNAL_FORTH_STACK_HPP
 #  define INTERNAL_FORTH_STACK_HPP
 
+#  include <algorithm> // copy
 #  include <ostream>
 #  include <iomanip> // setbase
 #  include <memory>  // unique_ptr
+#  include <new>     // bad_alloc
+#  include <string>
+#  include <typeinfo>
+#  include <utility> // swap
+#  include <type_traits>
+#  include <sys/mman.h>
+#  include <unistd.h>
 
 #define INLINE __attribute__((always_inline))
 
@@ -31,13 +39,19 @@ namespace forth
 {
 namespace size
 {
-//! \brief Stack depth (data stack, return stack ...)
+//! \brief Default stack depth (data stack, return stack ...)
 constexpr size_t stack = 1024u; // Tokens or Cells
 }
 
 // *****************************************************************************
 //! \brief Stack class holding elements of type T.
 //! \note: The stack has fixed size and therefore no reallocations are made.
+//! The memory segment is mapped with mmap() and surrounded by two PROT_NONE
+//! guard pages: an access just below the bottom or just above the top of the
+//! stack raises SIGSEGV instead of silently corrupting memory. The Forth
+//! interpreter catches this signal, opens the guard pages for replaying the
+//! faulting instruction and throws a Forth exception once the current word
+//! has returned (see Interpreter::executeToken()).
 //! \tparam T Can be Cell, int, smart pointers, ...
 // *****************************************************************************
 template<typename T>
@@ -45,23 +59,58 @@ class Stack
 {
 public:
 
-    //--------------------------------------------------------------------------
-    //! \brief Canari: unused extra memory for detecting stack overflow or
-    //! underflow.
-    //--------------------------------------------------------------------------
-    static constexpr size_t security_margin = 8;
-
     //--------------------------------------------------------------------------
     //! \brief Constructor. Initialize an empty stack. The name passed as param
     //! is used for error messages and logs.
-    //! \param[in] name_ the name of the stack (debug purpose only).
+    //! \param[in] name_ the name of the stack (debug purpose only).
+    //! \param[in] depth the minimal number of elements the stack can hold. It
+    //! is rounded up to fill whole memory pages (see capacity()).
+    //! \throw std::bad_alloc if the memory cannot be mapped.
     //--------------------------------------------------------------------------
-    Stack(const char *name_ = typeid(T).name())
+    Stack(const char *name_ = typeid(T).name(), size_t const depth = size::stack)
         : m_name(name_)
     {
-        // TODO init security_margin with canari values
+        m_page = size_t(::sysconf(_SC_PAGESIZE));
+        size_t const bytes = ((depth * sizeof(T) + m_page - 1u) / m_page) * m_page;
+        m_length = bytes + 2u * m_page;
+
+        void* mem = ::mmap(nullptr, m_length, PROT_NONE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED)
+            throw std::bad_alloc();
+
+        m_memory = static_cast<char*>(mem);
+        if (::mprotect(m_memory + m_page, bytes, PROT_READ | PROT_WRITE) != 0)
+        {
+            ::munmap(m_memory, m_length);
+            throw std::bad_alloc();
+        }
+
+        sp0 = sp = reinterpret_cast<T*>(m_memory + m_page);
+        spM = sp0 + bytes / sizeof(T);
+        if (!std::is_trivially_copyable<T>::value)
+        {
+            for (T* s = sp0; s != spM; ++s)
+                new (s) T();
+        }
     }
 
+    //--------------------------------------------------------------------------
+    //! \brief Destructor. Release elements and unmap the memory segment.
+    //--------------------------------------------------------------------------
+    ~Stack()
+    {
+        if (!std::is_trivially_copyable<T>::value)
+        {
+            for (T* s = sp0; s != spM; ++s)
+                s->~T();
+        }
+        ::munmap(m_memory, m_length);
+    }
+
+    Stack(Stack const&) = delete;
+    Stack& operator=(Stack const&) = delete;
+
     //--------------------------------------------------------------------------
     //! \brief Reset the stack to initial states.
     //! The top of Stack (TOS) is restored and the stack has no data and its
@@ -69,11 +118,36 @@ public:
     //--------------------------------------------------------------------------
     INLINE void reset() { sp = sp0; } // TODO zeros(m_data, sp0 - m_data);
 
+    //--------------------------------------------------------------------------
+    //! \brief Exchange the memory segments, and therefore the elements, of
+    //! two stacks. Names are not exchanged. Only pointers are swapped: this
+    //! is how the interpreter switches between cooperative tasks.
+    //--------------------------------------------------------------------------
+    INLINE void swap(Stack& other)
+    {
+        std::swap(m_memory, other.m_memory);
+        std::swap(m_length, other.m_length);
+        std::swap(sp0, other.sp0);
+        std::swap(spM, other.spM);
+        std::swap(sp, other.sp);
+    }
+
     //--------------------------------------------------------------------------
     //! \brief Return the current depth of the stack.
     //--------------------------------------------------------------------------
     INLINE int32_t depth() const { return int32_t(sp - sp0); }
 
+    //--------------------------------------------------------------------------
+    //! \brief Return the maximum number of elements the stack can hold.
+    //--------------------------------------------------------------------------
+    INLINE int32_t capacity() const { return int32_t(spM - sp0); }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the address of the bottom of the stack. It is the start
+    //! of a page aligned segment of capacity() elements.
+    //--------------------------------------------------------------------------
+    INLINE T* bottom() const { return sp0; }
+
     //--------------------------------------------------------------------------
     //! \brief Push an element which will be on the top of the stack.
     //! \note this routine does not check against stack overflow.
@@ -89,6 +163,33 @@ public:
     template<typename N>
     INLINE void push(std::unique_ptr<N> n) { *(sp++) = std::move(n); }
 
+    //--------------------------------------------------------------------------
+    //! \brief Push count elements at once, the first one being the deepest.
+    //! \return false if the stack has not enough room (nothing is pushed).
+    //--------------------------------------------------------------------------
+    bool push(T const* elements, size_t const count)
+    {
+        if (size_t(spM - sp) < count)
+            return false;
+        std::copy(elements, elements + count, sp);
+        sp += count;
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Pop count elements at once, the deepest one being stored first.
+    //! \return false if the stack does not hold enough elements (nothing is
+    //! popped).
+    //--------------------------------------------------------------------------
+    bool pop(T* elements, size_t const count)
+    {
+        if (size_t(sp - sp0) < count)
+            return false;
+        sp -= count;
+        std::copy(sp, sp + count, elements);
+        return true;
+    }
+
     //--------------------------------------------------------------------------
     //! \brief Remove the element place on the top of stack.
     //! \note this routine does not check against stack underflow.
@@ -146,6 +247,36 @@ public:
         return sp > spM;
     }
 
+    //--------------------------------------------------------------------------
+    //! \brief Check if the given address belongs to one of the guard pages
+    //! of this stack.
+    //! \return -1 if the address is inside the guard page below the bottom of
+    //! the stack (underflow), +1 if it is inside the guard page above the top
+    //! of the stack (overflow), else 0.
+    //--------------------------------------------------------------------------
+    int guarded(void const* address) const
+    {
+        char const* a = static_cast<char const*>(address);
+        char const* bottom = reinterpret_cast<char const*>(sp0);
+        if ((a >= m_memory) && (a < bottom))
+            return -1;
+        if ((a >= bottom) && (a < m_memory + m_length))
+            return (a >= reinterpret_cast<char const*>(spM)) ? 1 : 0;
+        return 0;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Make the guard pages accessible (protect = false) or trap again
+    //! their accesses (protect = true).
+    //! \note Called from a signal handler: only calls mprotect().
+    //--------------------------------------------------------------------------
+    void guard(bool const protect)
+    {
+        int const prot = protect ? PROT_NONE : (PROT_READ | PROT_WRITE);
+        ::mprotect(m_memory, m_page, prot);
+        ::mprotect(m_memory + m_length - m_page, m_page, prot);
+    }
+
     //--------------------------------------------------------------------------
     //! \brief Check if the stack has underflowed.
     //! \return true if the stack has underflowed.
@@ -226,20 +357,26 @@ public:
 private:
 
     //--------------------------------------------------------------------------
-    //! \brief A stack is a fixed-size memory segment of elements.
+    //! \brief A stack is a fixed-size memory segment of elements surrounded
+    //! by two guard pages.
     //--------------------------------------------------------------------------
-    T data[size::stack];
+    char* m_memory;
+    //! \brief Size of the mapped segment (guard pages included).
+    size_t m_length;
+    //! \brief Size of a memory page.
+    size_t m_page;
 
     //--------------------------------------------------------------------------
-    //! \brief Initial address of the top of the stack (fix address).
+    //! \brief Initial address of the top of the stack (fix address) and
+    //! address just after the last element (start of the upper guard page).
     //--------------------------------------------------------------------------
-    T* const sp0 = data + security_margin;
-    T* const spM = data + size::stack - security_margin;
+    T* sp0;
+    T* spM;
 
     //--------------------------------------------------------------------------
     //! \brief Stack pointer (refers to the top element of the stack).
     //--------------------------------------------------------------------------
-    T* sp = sp0;
+    T* sp;
 
     //--------------------------------------------------------------------------
     //! \brief Name of the stack for logs and c++ exceptions.
@@ -0,0 +1,325 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+#ifndef INTERNAL_FORTH_BINDING_HPP
+#  define INTERNAL_FORTH_BINDING_HPP
+
+#  include "Interpreter.hpp"
+#  include "Exceptions.hpp"
+#  include <sstream>
+#  include <tuple>
+#  include <type_traits>
+
+namespace forth
+{
+
+//******************************************************************************
+//! \brief Conversions between C++ values and cells. Integers, enums and
+//! floating points are supported, booleans are Forth flags (-1 or 0).
+//******************************************************************************
+template<typename T, typename Enable = void>
+struct CellCast;
+
+template<>
+struct CellCast<Cell>
+{
+    static INLINE Cell to(Cell const& value) { return value; }
+    static INLINE Cell from(Cell const& cell) { return cell; }
+};
+
+template<>
+struct CellCast<bool>
+{
+    static INLINE Cell to(bool const value) { return Cell::integer(value ? -1 : 0); }
+    static INLINE bool from(Cell const& cell) { return cell.integer() != 0; }
+};
+
+template<typename T>
+struct CellCast<T, std::enable_if_t<(std::is_integral_v<T> || std::is_enum_v<T>)
+                                    && !std::is_same_v<T, bool>>>
+{
+    static INLINE Cell to(T const value) { return Cell::integer(Int(value)); }
+    static INLINE T from(Cell const& cell) { return T(cell.integer()); }
+};
+
+template<typename T>
+struct CellCast<T, std::enable_if_t<std::is_floating_point_v<T>>>
+{
+    static INLINE Cell to(T const value) { return Cell::real(Real(value)); }
+    static INLINE T from(Cell const& cell) { return T(cell.real()); }
+};
+
+//******************************************************************************
+//! \brief Number of cells returned by a word bound with the C++ type R: 0
+//! for void, the size of the tuple for std::tuple, else 1.
+//******************************************************************************
+template<typename R>
+struct Results
+{
+    static constexpr int32_t count = 1;
+    static INLINE R pop(DataStack& ds) { return CellCast<R>::from(ds.pop()); }
+    static INLINE void push(DataStack& ds, R const& r) { ds.push(CellCast<R>::to(r)); }
+};
+
+template<>
+struct Results<void>
+{
+    static constexpr int32_t count = 0;
+    static INLINE void pop(DataStack&) {}
+};
+
+template<typename... Ts>
+struct Results<std::tuple<Ts...>>
+{
+    static constexpr int32_t count = int32_t(sizeof...(Ts));
+
+    //! \brief The last element of the tuple is the top of the stack.
+    static INLINE std::tuple<Ts...> pop(DataStack& ds)
+    {
+        Cell const* cells = ds.top() - count;
+        ds.top() -= count;
+        return get(cells, std::index_sequence_for<Ts...>{});
+    }
+
+    //! \brief The first element of the tuple is pushed first.
+    static INLINE void push(DataStack& ds, std::tuple<Ts...> const& r)
+    {
+        std::apply([&ds](Ts const&... values)
+                   { (ds.push(CellCast<Ts>::to(values)), ...); }, r);
+    }
+
+private:
+
+    template<size_t... I>
+    static INLINE std::tuple<Ts...> get(Cell const* cells, std::index_sequence<I...>)
+    {
+        return std::tuple<Ts...>(CellCast<Ts>::from(cells[I])...);
+    }
+};
+
+//******************************************************************************
+//! \brief Callable executing a Forth word from C++ without parsing any script
+//! (see SimForth::bind()). The execution token is resolved once. Arguments
+//! are pushed on the data stack, the first one being the deepest, and results
+//! are popped from it.
+//!
+//! Example: for the word AREA ( width height -- area ) with float values:
+//! \code
+//! auto area = forth.bind<double(double, double)>("AREA");
+//! double a = area(2.0, 3.0);
+//! \endcode
+//!
+//! \throw forth::Exception on Forth errors or if the word does not leave
+//! enough results. The interpreter is then aborted (see Interpreter::call()).
+//******************************************************************************
+template<typename Signature>
+class Binding;
+
+template<typename R, typename... Args>
+class Binding<R(Args...)>
+{
+public:
+
+    Binding(Interpreter& forth, Token const xt)
+        : m_forth(&forth), m_xt(xt)
+    {}
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the execution token of the bound word.
+    //--------------------------------------------------------------------------
+    inline Token xt() const
+    {
+        return m_xt;
+    }
+
+    R operator()(Args... args) const
+    {
+        DataStack& ds = m_forth->dataStack();
+        int32_t const depth = ds.depth();
+
+        if (depth + int32_t(sizeof...(Args)) > ds.capacity())
+        {
+            m_forth->fail();
+            throw forth::Exception(ds.name() + "-Stack overflow caused by the arguments of "
+                                   + m_forth->dictionary().token2name(m_xt));
+        }
+        (ds.push(CellCast<std::decay_t<Args>>::to(args)), ...);
+
+        m_forth->call(m_xt);
+
+        if (ds.depth() < depth + Results<R>::count)
+        {
+            std::string const name = m_forth->dictionary().token2name(m_xt);
+            m_forth->fail();
+            throw forth::Exception(name + " did not leave its "
+                                   + std::to_string(Results<R>::count)
+                                   + " results on the " + ds.name() + "-Stack");
+        }
+        return Results<R>::pop(ds);
+    }
+
+private:
+
+    Interpreter* m_forth;
+    Token m_xt;
+};
+
+//******************************************************************************
+//! \brief Call a C++ function registered as a primitive (see
+//! registerPrimitive()) with the cells on the top of the data stack, the
+//! deepest one being the first argument, and push its results. The depth of
+//! the stack has already been checked by the interpreter.
+//******************************************************************************
+template<typename F, typename R, typename Args>
+struct NativeCall;
+
+template<typename F, typename R, typename... Args>
+struct NativeCall<F, R, std::tuple<Args...>>
+{
+    static constexpr int32_t inputs = int32_t(sizeof...(Args));
+    static constexpr int32_t outputs = Results<R>::count;
+
+    static void call(void* context, DataStack& ds)
+    {
+        call(*static_cast<F*>(context), ds, std::index_sequence_for<Args...>{});
+    }
+
+private:
+
+    template<size_t... I>
+    static INLINE void call(F& function, DataStack& ds, std::index_sequence<I...>)
+    {
+        Cell const* cells = ds.top() - inputs;
+        ds.top() -= inputs;
+        if constexpr (std::is_void_v<R>)
+        {
+            function(CellCast<Args>::from(cells[I])...);
+        }
+        else
+        {
+            // Arguments are read before results overwrite them
+            Results<R>::push(ds, function(CellCast<Args>::from(cells[I])...));
+        }
+        (void) cells;
+    }
+};
+
+//******************************************************************************
+//! \brief Result and arguments of a function pointer or of a lambda. Functions
+//! only taking the data stack are called as is: they manage their parameters.
+//******************************************************************************
+template<typename F>
+struct Callable: Callable<decltype(&F::operator())>
+{};
+
+template<typename R, typename... Args>
+struct Callable<R(*)(Args...)>
+{
+    using Result = R;
+    using Arguments = std::tuple<std::decay_t<Args>...>;
+    static constexpr bool raw = std::is_same_v<Arguments, std::tuple<DataStack>>;
+};
+
+template<typename C, typename R, typename... Args>
+struct Callable<R(C::*)(Args...)>: Callable<R(*)(Args...)>
+{};
+
+template<typename C, typename R, typename... Args>
+struct Callable<R(C::*)(Args...) const>: Callable<R(*)(Args...)>
+{};
+
+//------------------------------------------------------------------------------
+//! \brief Count the cells before and after "--" of a stack effect such as
+//! "( a b -- c )".
+//! \throw forth::Exception if the stack effect has no "--".
+//------------------------------------------------------------------------------
+inline void stackEffect(std::string const& effect, int32_t& inputs, int32_t& outputs)
+{
+    std::istringstream stream(effect);
+    std::string word;
+    int32_t* count = &inputs;
+
+    inputs = outputs = 0;
+    while (stream >> word)
+    {
+        if (word == "--")
+        {
+            if (count == &outputs)
+                break;
+            count = &outputs;
+        }
+        else if ((word != "(") && (word != ")"))
+        {
+            ++(*count);
+        }
+    }
+    if (count != &outputs)
+    {
+        throw forth::Exception("Malformed stack effect '" + effect + "'");
+    }
+}
+
+//------------------------------------------------------------------------------
+//! \brief Register a function pointer or a lambda as a Forth primitive (see
+//! Interpreter::registerPrimitive()). Arguments and results are converted
+//! with CellCast and shall match the declared stack effect. A function only
+//! taking a DataStack& manages the stack itself and is checked against the
+//! stack effect after each call.
+//!
+//! Example:
+//! \code
+//! registerPrimitive(forth, "HYPOT", [](Real x, Real y) { return std::hypot(x, y); },
+//!                   "( x y -- z )");
+//! \endcode
+//------------------------------------------------------------------------------
+template<typename F>
+Token registerPrimitive(Interpreter& forth, std::string const& name, F&& function,
+                        std::string const& effect)
+{
+    using Function = std::decay_t<F>;
+    using Traits = Callable<Function>;
+
+    Native native;
+    stackEffect(effect, native.inputs, native.outputs);
+    auto context = std::make_shared<Function>(std::forward<F>(function));
+    native.context = context.get();
+
+    if constexpr (Traits::raw)
+    {
+        native.function = [](void* f, DataStack& ds) { (*static_cast<Function*>(f))(ds); };
+    }
+    else
+    {
+        using Call = NativeCall<Function, typename Traits::Result,
+                                typename Traits::Arguments>;
+        if ((native.inputs != Call::inputs) || (native.outputs != Call::outputs))
+        {
+            throw forth::Exception("The stack effect '" + effect + "' of " + name
+                                   + " does not match its C++ signature");
+        }
+        native.function = &Call::call;
+    }
+
+    return forth.registerPrimitive(name, native, context);
+}
+
+} // namespace forth
+
+#endif // INTERNAL_FORTH_BINDING_HPP
@@ -0,0 +1,313 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+#include "Channel.hpp"
+#include <climits>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#if defined(__linux__)
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#else
+#  include <condition_variable>
+#endif
+
+namespace forth
+{
+
+//------------------------------------------------------------------------------
+//! \brief futexWait() sleeps while the word is equal to expected. Spurious
+//! wake-ups are possible: callers check their condition again. futexWake()
+//! wakes up all threads sleeping on the word.
+#if defined(__linux__)
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "futexes need lock-free 32-bit atomics");
+
+static void futexWait(std::atomic<uint32_t>& word, uint32_t const expected)
+{
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word),
+              FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+static void futexWake(std::atomic<uint32_t>& word)
+{
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word),
+              FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+#else
+static std::mutex s_futex_mutex;
+static std::condition_variable s_futex_cond;
+
+static void futexWait(std::atomic<uint32_t>& word, uint32_t const expected)
+{
+    std::unique_lock<std::mutex> lock(s_futex_mutex);
+    if (word.load() == expected)
+        s_futex_cond.wait(lock);
+}
+
+static void futexWake(std::atomic<uint32_t>& /*word*/)
+{
+    std::lock_guard<std::mutex> lock(s_futex_mutex);
+    s_futex_cond.notify_all();
+}
+#endif
+
+//------------------------------------------------------------------------------
+//! \brief Channels of the process. Handles index a two-level table whose
+//! chunks never move: get() does not lock.
+namespace
+{
+    constexpr size_t CHUNK = 1024u;
+    constexpr size_t CHUNKS = 1024u;
+
+    struct Registry
+    {
+        //! \brief Protects creations.
+        std::mutex mutex;
+        std::atomic<std::atomic<Channel*>*> table[CHUNKS] = {};
+        std::vector<std::unique_ptr<std::atomic<Channel*>[]>> chunks;
+        std::vector<std::unique_ptr<Channel>> channels;
+    };
+
+    Registry& registry()
+    {
+        static Registry instance;
+        return instance;
+    }
+}
+
+//------------------------------------------------------------------------------
+Int Channel::create(size_t const capacity)
+{
+    Registry& r = registry();
+
+    if ((capacity == 0u) || (capacity > (size_t(1) << 32)))
+        return 0;
+
+    std::lock_guard<std::mutex> lock(r.mutex);
+    size_t const index = r.channels.size();
+    if (index >= CHUNK * CHUNKS)
+        return 0;
+
+    if (index % CHUNK == 0u)
+    {
+        r.chunks.push_back(std::make_unique<std::atomic<Channel*>[]>(CHUNK));
+        for (size_t i = 0u; i < CHUNK; ++i)
+            r.chunks.back()[i].store(nullptr, std::memory_order_relaxed);
+        r.table[index / CHUNK].store(r.chunks.back().get(), std::memory_order_release);
+    }
+
+    r.channels.push_back(std::make_unique<Channel>(capacity));
+    r.table[index / CHUNK].load(std::memory_order_relaxed)[index % CHUNK]
+        .store(r.channels.back().get(), std::memory_order_release);
+    return Int(index + 1u);
+}
+
+//------------------------------------------------------------------------------
+Channel* Channel::get(Int const handle)
+{
+    if ((handle < 1) || (handle > Int(CHUNK * CHUNKS)))
+        return nullptr;
+
+    size_t const index = size_t(handle - 1);
+    std::atomic<Channel*>* chunk =
+            registry().table[index / CHUNK].load(std::memory_order_acquire);
+    if (chunk == nullptr)
+        return nullptr;
+    return chunk[index % CHUNK].load(std::memory_order_acquire);
+}
+
+//------------------------------------------------------------------------------
+void Channel::scan(std::function<void(Cell const&)> const& visit)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    for (auto const& channel: r.channels)
+    {
+        size_t const head = channel->m_head.load(std::memory_order_acquire);
+        size_t const tail = channel->m_tail.load(std::memory_order_acquire);
+        for (size_t position = head; (position != tail) &&
+                 (position - head <= channel->m_mask); ++position)
+        {
+            // Only cells already written and not yet read
+            Slot const& slot = channel->m_slots[position & channel->m_mask];
+            if (slot.sequence.load(std::memory_order_acquire) == position + 1u)
+                visit(slot.cell);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+Channel::Channel(size_t const capacity)
+{
+    size_t size = 1u;
+    while (size < capacity)
+        size <<= 1;
+
+    m_mask = size - 1u;
+    m_slots = std::make_unique<Slot[]>(size);
+    for (size_t i = 0u; i < size; ++i)
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+bool Channel::enqueue(Cell const& cell)
+{
+    size_t position = m_tail.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        Slot& slot = m_slots[position & m_mask];
+        size_t const sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t const diff = intptr_t(sequence) - intptr_t(position);
+        if (diff == 0)
+        {
+            // The slot is free: reserve it
+            if (m_tail.compare_exchange_weak(position, position + 1u,
+                                             std::memory_order_relaxed))
+            {
+                slot.cell = cell;
+                slot.sequence.store(position + 1u, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The slot has not yet been read: the channel is full
+            return false;
+        }
+        else
+        {
+            // Another producer has taken the slot
+            position = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+bool Channel::dequeue(Cell& cell)
+{
+    size_t position = m_head.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        Slot& slot = m_slots[position & m_mask];
+        size_t const sequence = slot.sequence.load(std::memory_order_acquire);
+        intptr_t const diff = intptr_t(sequence) - intptr_t(position + 1u);
+        if (diff == 0)
+        {
+            if (m_head.compare_exchange_weak(position, position + 1u,
+                                             std::memory_order_relaxed))
+            {
+                cell = slot.cell;
+                // Free the slot for the write of the next round
+                slot.sequence.store(position + m_mask + 1u, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The slot has not yet been written: the channel is empty
+            return false;
+        }
+        else
+        {
+            position = m_head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+size_t Channel::trySend(Cell const* cells, size_t const count)
+{
+    size_t sent = 0u;
+
+    while ((sent < count) && enqueue(cells[sent]))
+        ++sent;
+
+    // A single wake-up for the whole batch
+    if (sent > 0u)
+    {
+        m_sent.fetch_add(1u);
+        if (m_receivers.load() > 0u)
+            futexWake(m_sent);
+    }
+    return sent;
+}
+
+//------------------------------------------------------------------------------
+size_t Channel::tryRecv(Cell* cells, size_t const count)
+{
+    size_t received = 0u;
+
+    while ((received < count) && dequeue(cells[received]))
+        ++received;
+
+    if (received > 0u)
+    {
+        m_received.fetch_add(1u);
+        if (m_senders.load() > 0u)
+            futexWake(m_received);
+    }
+    return received;
+}
+
+//------------------------------------------------------------------------------
+void Channel::send(Cell const* cells, size_t const count)
+{
+    size_t sent = trySend(cells, count);
+
+    while (sent < count)
+    {
+        // Read the counter before checking again: a receiver freeing a slot
+        // in the meantime changes it and the wait returns at once.
+        uint32_t const received = m_received.load();
+        sent += trySend(cells + sent, count - sent);
+        if (sent < count)
+        {
+            m_senders.fetch_add(1u);
+            futexWait(m_received, received);
+            m_senders.fetch_sub(1u);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void Channel::recv(Cell* cells, size_t const count)
+{
+    size_t received = tryRecv(cells, count);
+
+    while (received < count)
+    {
+        uint32_t const sent = m_sent.load();
+        received += tryRecv(cells + received, count - received);
+        if (received < count)
+        {
+            m_receivers.fetch_add(1u);
+            futexWait(m_sent, sent);
+            m_receivers.fetch_sub(1u);
+        }
+    }
+}
+
+} // namespace forth
@@ -0,0 +1,159 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+#ifndef INTERNAL_FORTH_CHANNEL_HPP
+#  define INTERNAL_FORTH_CHANNEL_HPP
+
+#  include "SimForth/Cell.hpp"
+#  include <atomic>
+#  include <functional>
+#  include <memory>
+
+namespace forth
+{
+
+//******************************************************************************
+//! \brief Bounded queue of cells for exchanging data between interpreters,
+//! threads and the host application (words CHANNEL, SEND, RECV, TRY-RECV,
+//! SEND-N, RECV-N).
+//!
+//! The queue is a lock-free ring buffer accepting several producers and
+//! several consumers: each slot holds a sequence number telling whether it is
+//! ready to be written or read, and producers and consumers reserve slots
+//! with a compare-and-swap on their own index. Blocking calls do not spin:
+//! they sleep on a futex (a condition variable on systems without futexes)
+//! and are only woken up when cells have been sent or received.
+//!
+//! Channels are referred by handles valid in all interpreters of the
+//! process. They live until the end of the process.
+//******************************************************************************
+class Channel
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //! \brief Create a channel and return its handle.
+    //! \param[in] capacity the minimal number of cells the channel can hold.
+    //! It is rounded up to a power of two (see capacity()).
+    //! \return 0 if the capacity is 0 or if too many channels exist.
+    //--------------------------------------------------------------------------
+    static Int create(size_t const capacity);
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the channel referred by the handle or nullptr if the
+    //! handle is not valid. Does not lock.
+    //--------------------------------------------------------------------------
+    static Channel* get(Int const handle);
+
+    //--------------------------------------------------------------------------
+    //! \brief Call visit on the cells waiting inside all channels. Used for
+    //! finding the interned strings still referred (see
+    //! Interpreter::collectStrings()).
+    //! \note Only the cells sent by the calling thread are sure to be seen:
+    //! cells sent or received meanwhile by other threads may be missed.
+    //--------------------------------------------------------------------------
+    static void scan(std::function<void(Cell const&)> const& visit);
+
+    //--------------------------------------------------------------------------
+    //! \brief Constructor. Use create() for getting a handle usable by Forth.
+    //--------------------------------------------------------------------------
+    explicit Channel(size_t const capacity);
+
+    Channel(Channel const&) = delete;
+    Channel& operator=(Channel const&) = delete;
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the maximal number of cells the channel can hold.
+    //--------------------------------------------------------------------------
+    inline size_t capacity() const
+    {
+        return m_mask + 1u;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Send as many of the count cells as possible, in order, without
+    //! blocking.
+    //! \return the number of cells sent.
+    //--------------------------------------------------------------------------
+    size_t trySend(Cell const* cells, size_t const count);
+
+    //--------------------------------------------------------------------------
+    //! \brief Receive up to count cells without blocking.
+    //! \return the number of cells received.
+    //--------------------------------------------------------------------------
+    size_t tryRecv(Cell* cells, size_t const count);
+
+    //--------------------------------------------------------------------------
+    //! \brief Send the count cells, waiting while the channel is full.
+    //--------------------------------------------------------------------------
+    void send(Cell const* cells, size_t const count);
+
+    //--------------------------------------------------------------------------
+    //! \brief Receive count cells, waiting while the channel is empty.
+    //--------------------------------------------------------------------------
+    void recv(Cell* cells, size_t const count);
+
+    inline bool trySend(Cell const& cell) { return trySend(&cell, 1u) == 1u; }
+    inline bool tryRecv(Cell& cell) { return tryRecv(&cell, 1u) == 1u; }
+    inline void send(Cell const& cell) { send(&cell, 1u); }
+    inline Cell recv() { Cell cell; recv(&cell, 1u); return cell; }
+
+private:
+
+    //--------------------------------------------------------------------------
+    //! \brief Push a cell if the channel is not full. Lock-free.
+    //--------------------------------------------------------------------------
+    bool enqueue(Cell const& cell);
+
+    //--------------------------------------------------------------------------
+    //! \brief Pop a cell if the channel is not empty. Lock-free.
+    //--------------------------------------------------------------------------
+    bool dequeue(Cell& cell);
+
+    //--------------------------------------------------------------------------
+    //! \brief Element of the ring buffer. The sequence is equal to the index
+    //! of the next write when the slot is free and to this index + 1 when
+    //! the cell is ready to be read.
+    //--------------------------------------------------------------------------
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        Cell cell;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask;
+    //! \brief Indexes of the next write and of the next read. Placed on
+    //! different cache lines: producers and consumers do not share them.
+    alignas(64) std::atomic<size_t> m_tail{0u};
+    alignas(64) std::atomic<size_t> m_head{0u};
+    //! \brief Incremented after cells have been sent (resp. received):
+    //! receivers (resp. senders) sleep on them.
+    alignas(64) std::atomic<uint32_t> m_sent{0u};
+    std::atomic<uint32_t> m_received{0u};
+    //! \brief Number of sleeping receivers and senders: wake-up system calls
+    //! are only made when someone sleeps.
+    std::atomic<uint32_t> m_receivers{0u};
+    std::atomic<uint32_t> m_senders{0u};
+};
+
+} // namespace forth
+
+#endif // INTERNAL_FORTH_CHANNEL_HPP
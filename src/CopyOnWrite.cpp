@@ -0,0 +1,207 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+#include "CopyOnWrite.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace forth
+{
+
+//! \brief Journals having at least one checkpoint taken by the current thread.
+//! SIGSEGV is delivered to the faulting thread: the signal handler only scans
+//! the journals of this thread, so a write made by another thread is never
+//! recorded into the checkpoints of this one. The handler cannot take locks:
+//! slots are lock-free atomics and this fixed array needs no dynamic
+//! initialization.
+static constexpr size_t MAX_JOURNALS = 16u;
+static thread_local std::atomic<CopyOnWrite*> t_journals[MAX_JOURNALS];
+static_assert(std::atomic<CopyOnWrite*>::is_always_lock_free,
+              "Journal slots shall be async-signal-safe");
+
+//------------------------------------------------------------------------------
+static std::atomic<CopyOnWrite*>* registerJournal(CopyOnWrite* journal)
+{
+    for (auto& slot: t_journals)
+    {
+        CopyOnWrite* expected = nullptr;
+        if (slot.compare_exchange_strong(expected, journal))
+            return &slot;
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+CopyOnWrite::Level::~Level()
+{
+    if (backup != nullptr)
+        ::munmap(backup, capacity);
+}
+
+//------------------------------------------------------------------------------
+CopyOnWrite::CopyOnWrite()
+    : m_page(size_t(::sysconf(_SC_PAGESIZE)))
+{}
+
+//------------------------------------------------------------------------------
+CopyOnWrite::~CopyOnWrite()
+{
+    clear();
+}
+
+//------------------------------------------------------------------------------
+size_t CopyOnWrite::take(std::vector<Segment> const& segments)
+{
+    auto level = std::make_unique<Level>();
+    for (auto const& it: segments)
+    {
+        if (it.bytes == 0u)
+            continue;
+
+        uintptr_t const start = reinterpret_cast<uintptr_t>(it.address) & ~(m_page - 1u);
+        uintptr_t const end = (reinterpret_cast<uintptr_t>(it.address) + it.bytes
+                               + m_page - 1u) & ~(m_page - 1u);
+        level->segments.push_back({ reinterpret_cast<void*>(start), size_t(end - start) });
+        level->capacity += size_t(end - start);
+    }
+
+    if (level->capacity != 0u)
+    {
+        void* mem = ::mmap(nullptr, level->capacity, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (mem == MAP_FAILED)
+            throw std::bad_alloc();
+        level->backup = static_cast<char*>(mem);
+        level->pages.reserve(level->capacity / m_page);
+    }
+
+    if (m_levels.empty())
+    {
+        m_slot = registerJournal(this);
+        if (m_slot == nullptr)
+            throw std::bad_alloc();
+    }
+
+    m_levels.push_back(std::move(level));
+    protect(m_levels.size() - 1u, PROT_READ);
+    return m_levels.size() - 1u;
+}
+
+//------------------------------------------------------------------------------
+bool CopyOnWrite::rollback(size_t const id)
+{
+    if (id >= m_levels.size())
+        return false;
+
+    // Pages saved by a level may have been write-protected again by a newer
+    // level: give back the write access before copying.
+    protect(id, PROT_READ | PROT_WRITE);
+
+    // Newest first: the oldest copy of a page is the one to keep.
+    for (size_t i = m_levels.size(); i-- > id; )
+    {
+        Level& level = *m_levels[i];
+        for (size_t p = 0u; p < level.pages.size(); ++p)
+        {
+            std::memcpy(level.pages[p], level.backup + p * m_page, m_page);
+        }
+    }
+
+    m_levels.resize(id + 1u);
+    m_levels[id]->pages.clear();
+    protect(id, PROT_READ);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void CopyOnWrite::clear()
+{
+    if (m_levels.empty())
+        return ;
+
+    m_slot->store(nullptr);
+    m_slot = nullptr;
+    protect(0u, PROT_READ | PROT_WRITE);
+    m_levels.clear();
+}
+
+//------------------------------------------------------------------------------
+size_t CopyOnWrite::dirtyPages() const
+{
+    return m_levels.empty() ? 0u : m_levels.back()->pages.size();
+}
+
+//------------------------------------------------------------------------------
+void CopyOnWrite::protect(size_t const first, int const access)
+{
+    for (size_t i = first; i < m_levels.size(); ++i)
+    {
+        for (auto const& it: m_levels[i]->segments)
+        {
+            ::mprotect(it.address, it.bytes, access);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+bool CopyOnWrite::save(char* address)
+{
+    // A page is write-protected by the latest checkpoint watching it: it has
+    // not been modified since this checkpoint, which is the one to save it.
+    for (size_t i = m_levels.size(); i-- > 0u; )
+    {
+        Level& level = *m_levels[i];
+        for (auto const& it: level.segments)
+        {
+            char* start = static_cast<char*>(it.address);
+            if ((address < start) || (address >= start + it.bytes))
+                continue;
+
+            char* page = start + size_t(address - start) / m_page * m_page;
+            if (level.pages.size() == level.pages.capacity())
+                return false;
+
+            std::memcpy(level.backup + level.pages.size() * m_page, page, m_page);
+            level.pages.push_back(page);
+            return ::mprotect(page, m_page, PROT_READ | PROT_WRITE) == 0;
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+bool CopyOnWrite::fault(void const* address)
+{
+    char* a = static_cast<char*>(const_cast<void*>(address));
+    for (auto& slot: t_journals)
+    {
+        CopyOnWrite* journal = slot.load();
+        if ((journal != nullptr) && journal->save(a))
+            return true;
+    }
+    return false;
+}
+
+} // namespace forth
@@ -0,0 +1,164 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+#ifndef INTERNAL_FORTH_COPY_ON_WRITE_HPP
+#  define INTERNAL_FORTH_COPY_ON_WRITE_HPP
+
+#  include <atomic>
+#  include <cstddef>
+#  include <memory>
+#  include <vector>
+
+namespace forth
+{
+
+//******************************************************************************
+//! \brief Page-granular copy-on-write journal of memory segments.
+//!
+//! take() write-protects the watched segments. The first write into a page
+//! raises SIGSEGV: the signal handler of the interpreter calls fault() which
+//! saves the page, gives back the write access and lets the faulting
+//! instruction resume. rollback() copies back the saved pages only: its cost
+//! is proportional to the number of pages modified since the checkpoint, not
+//! to the size of the segments.
+//!
+//! Checkpoints are nested: a page modified after several checkpoints is saved
+//! once per checkpoint. Rolling back to a checkpoint discards the newer ones
+//! and keeps the checkpoint itself, so it can be rolled back again.
+//!
+//! \note Watched segments shall be page aligned, mapped by mmap() and shall
+//! only be written from user space: a system call writing into a protected
+//! page (ie read(2)) fails with EFAULT instead of raising SIGSEGV.
+//!
+//! \note A journal belongs to the thread taking its first checkpoint: only
+//! the writes of this thread are saved. Another thread writing into a
+//! protected page is not handled by fault() and gets the usual SIGSEGV. The
+//! journal shall be cleared (or destroyed) by its owner thread.
+//******************************************************************************
+class CopyOnWrite
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //! \brief Memory segment to watch.
+    //--------------------------------------------------------------------------
+    struct Segment
+    {
+        void*  address;
+        size_t bytes;
+    };
+
+    CopyOnWrite();
+
+    //--------------------------------------------------------------------------
+    //! \brief Destructor. Give back the write access to watched segments.
+    //--------------------------------------------------------------------------
+    ~CopyOnWrite();
+
+    CopyOnWrite(CopyOnWrite const&) = delete;
+    CopyOnWrite& operator=(CopyOnWrite const&) = delete;
+
+    //--------------------------------------------------------------------------
+    //! \brief Create a new checkpoint on the given segments.
+    //! \return the identifier of the checkpoint (0 for the first one).
+    //! \throw std::bad_alloc if the memory for saving pages cannot be mapped
+    //! or if too many journals are alive in the calling thread.
+    //--------------------------------------------------------------------------
+    size_t take(std::vector<Segment> const& segments);
+
+    //--------------------------------------------------------------------------
+    //! \brief Restore watched pages to their content when the checkpoint id
+    //! was taken. Newer checkpoints are discarded.
+    //! \return false if the checkpoint does not exist.
+    //--------------------------------------------------------------------------
+    bool rollback(size_t const id);
+
+    //--------------------------------------------------------------------------
+    //! \brief Discard all checkpoints.
+    //--------------------------------------------------------------------------
+    void clear();
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the number of alive checkpoints.
+    //--------------------------------------------------------------------------
+    inline size_t count() const
+    {
+        return m_levels.size();
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the number of pages saved since the latest checkpoint.
+    //--------------------------------------------------------------------------
+    size_t dirtyPages() const;
+
+    //--------------------------------------------------------------------------
+    //! \brief Called by the SIGSEGV handler: if the address belongs to a page
+    //! protected by an alive journal of the calling thread, save the page and
+    //! make it writable. Async-signal-safe.
+    //! \return true if the fault has been handled and the faulting
+    //! instruction can be replayed.
+    //--------------------------------------------------------------------------
+    static bool fault(void const* address);
+
+private:
+
+    //--------------------------------------------------------------------------
+    //! \brief Pages saved since one checkpoint.
+    //--------------------------------------------------------------------------
+    struct Level
+    {
+        ~Level();
+
+        //! \brief Page aligned segments watched by this checkpoint.
+        std::vector<Segment> segments;
+        //! \brief Memory receiving the content of saved pages. It is large
+        //! enough for all watched pages but only touched pages are committed.
+        char* backup = nullptr;
+        size_t capacity = 0u;
+        //! \brief Address of saved pages (their copy is at the same index
+        //! in backup). Reserved at creation: never allocates in fault().
+        std::vector<char*> pages;
+    };
+
+    //--------------------------------------------------------------------------
+    //! \brief Save the page holding the address if it belongs to the latest
+    //! checkpoint.
+    //--------------------------------------------------------------------------
+    bool save(char* address);
+
+    //--------------------------------------------------------------------------
+    //! \brief Change the access of all segments of levels >= first.
+    //--------------------------------------------------------------------------
+    void protect(size_t const first, int const access);
+
+private:
+
+    //! \brief Size of a memory page.
+    size_t m_page;
+    //! \brief Checkpoints. The latest is at the back.
+    std::vector<std::unique_ptr<Level>> m_levels;
+    //! \brief Slot registering this journal in the thread-local registry of
+    //! its owner thread (nullptr when there is no checkpoint).
+    std::atomic<CopyOnWrite*>* m_slot = nullptr;
+};
+
+} // namespace forth
+
+#endif // INTERNAL_FORTH_COPY_ON_WRITE_HPP
@@ -19,10 +19,16 @@
 //==============================================================================
 
 #include "Dictionary.hpp"
+#include "Exceptions.hpp"
 #include "Primitives.hpp"
 #include <cassert>
 #include <cstring> // strerror
 #include <iomanip> // dictionary display
+#include <new>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace forth
 {
@@ -34,7 +40,84 @@ namespace forth
 
 //----------------------------------------------------------------------------
 Dictionary::Dictionary()
-{}
+{
+    void* mem = ::mmap(nullptr, size::dictionary * size::token,
+                       PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED)
+        throw std::bad_alloc();
+    m_memory = static_cast<Token*>(mem);
+}
+
+//----------------------------------------------------------------------------
+Dictionary::Dictionary(SharedDictionary const& image)
+    : m_here(image->m_here),
+      m_last(image->m_last),
+      m_max_primitives(image->m_max_primitives),
+      m_image(image)
+{
+    void* mem = ::mmap(nullptr, size::dictionary * size::token,
+                       PROT_READ | PROT_WRITE, MAP_PRIVATE, image->m_fd, 0);
+    if (mem == MAP_FAILED)
+        throw std::bad_alloc();
+    m_memory = static_cast<Token*>(mem);
+}
+
+//----------------------------------------------------------------------------
+DictionaryImage::~DictionaryImage()
+{
+    if (m_fd >= 0)
+        ::close(m_fd);
+}
+
+//----------------------------------------------------------------------------
+//! \brief Create an anonymous file living in memory.
+static int createSharedMemory()
+{
+#if defined(__linux__)
+    return ::memfd_create("SimForth-dictionary", MFD_CLOEXEC);
+#else
+    std::string const name = "/SimForth-" + std::to_string(::getpid()) + "-"
+        + std::to_string(reinterpret_cast<uintptr_t>(&name));
+    int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0)
+        ::shm_unlink(name.c_str());
+    return fd;
+#endif
+}
+
+//----------------------------------------------------------------------------
+SharedDictionary Dictionary::freeze() const
+{
+    std::shared_ptr<DictionaryImage> image(new DictionaryImage());
+    size_t const bytes = size::dictionary * size::token;
+
+    image->m_fd = createSharedMemory();
+    if ((image->m_fd < 0) || (::ftruncate(image->m_fd, off_t(bytes)) != 0))
+        throw std::bad_alloc();
+
+    // Only the used part: the remaining of the file is zeros.
+    char const* src = reinterpret_cast<char const*>(m_memory);
+    size_t const used = size_t(m_here) * size::token;
+    size_t written = 0u;
+    while (written < used)
+    {
+        ssize_t res = ::pwrite(image->m_fd, src + written, used - written, off_t(written));
+        if (res <= 0)
+            throw std::bad_alloc();
+        written += size_t(res);
+    }
+
+    image->m_here = m_here;
+    image->m_last = m_last;
+    image->m_max_primitives = m_max_primitives;
+    return image;
+}
+
+//----------------------------------------------------------------------------
+Dictionary::~Dictionary()
+{
+    ::munmap(m_memory, size::dictionary * size::token);
+}
 
 //----------------------------------------------------------------------------
 void Dictionary::clear()
@@ -42,6 +125,16 @@ void Dictionary::clear()
     m_last = m_here = 0;
     m_backup.set = false;
     m_errno.clear();
+    ++m_generation;
+}
+
+//----------------------------------------------------------------------------
+void Dictionary::rewind(Token const here, Token const last)
+{
+    m_here = here;
+    m_last = last;
+    m_backup.set = false;
+    ++m_generation;
 }
 
 //----------------------------------------------------------------------------
@@ -107,13 +200,18 @@ bool Dictionary::load(char const* filename, const bool replace)
         return false;
     }
 
+    // Read the file in a buffer first: the dictionary memory may be write
+    // protected by a checkpoint and the kernel would refuse to fill it.
+    std::vector<char> buffer(length);
+    in.read(buffer.data(), static_cast<std::streamsize>(length));
+
     // Load the dictionary containing an additional token: the content of Forth
     // word LAST.
+    ++m_generation;
     if (replace)
     {
         // Smash the old dictionary
-        in.read(reinterpret_cast<char*>(m_memory),
-                static_cast<std::streamsize>(length));
+        std::memcpy(m_memory, buffer.data(), length);
 
         // Update Forth words LAST and HERE.
         // Remove token_size because LAST was stored in file.
@@ -123,8 +221,7 @@ bool Dictionary::load(char const* filename, const bool replace)
     else
     {
         // Append the dictionary
-        in.read(reinterpret_cast<char*>(m_memory + m_here),
-                static_cast<std::streamsize>(length));
+        std::memcpy(m_memory + m_here, buffer.data(), length);
 
         // Link the LFA of 1st entry of the new dictionary to
         // the LFA of the last entry of the previous dictionary
@@ -267,25 +364,25 @@ void Dictionary::append(Cell const cell)
 }
 
 //----------------------------------------------------------------------------
-void Dictionary::append(std::string& s, Token& here)
+void Dictionary::append(std::string_view const& s, Token& here)
 {
-    // Store the number of string characters
-    m_memory[here++] = s.size();
-
     // Align the size to number of tokens.
     size_t size = NEXT_MULTIPLE_OF_2(s.size() + 1u);
-    size_t tokens = size / 2u;
 
-    // Add extra '\0' chars (padding)
-    size_t padding = size - s.size();
-    while (padding--)
-        s.push_back('\0');
+    // The count token and the characters shall fit inside the dictionary
+    if (size_t(here) + 1u + size / size::token > size::dictionary)
+    {
+        THROW("Dictionary full: no space left for a string of "
+              + std::to_string(s.size()) + " chars");
+    }
+
+    // Store the number of string characters
+    m_memory[here++] = s.size();
 
-    // Store characters token by token (instead of byte by byte)
-    Token* dst = m_memory + here;
-    Token const* src = reinterpret_cast<Token const*>(s.data());
-    while (tokens--)
-        *dst++ = *src++;
+    // Store characters and add extra '\0' chars (padding)
+    char* dst = reinterpret_cast<char*>(m_memory + here);
+    std::memcpy(dst, s.data(), s.size());
+    std::memset(dst + s.size(), '\0', size - s.size());
 
     // Move and align HERE
     here += size / size::token;
@@ -331,6 +428,7 @@ void Dictionary::createEntry(Token const xt, char const* name, bool const immedi
     uint8_t const* n = reinterpret_cast<uint8_t const*>(name);
 
     // Words are stored as list link
+    ++m_generation;
     Token lfa = m_here - m_last;
     m_last = m_here;
 
@@ -365,12 +463,30 @@ void Dictionary::finalizeEntry()
     m_backup.set = false;
 }
 
+//----------------------------------------------------------------------------
+//! \brief Case insensitive comparison of the n first chars of a dictionary
+//! entry name against a word. This avoids to make an upper case copy of each
+//! word read from the input stream before looking for it.
+//----------------------------------------------------------------------------
+static inline bool matchName(char const* name, std::string_view const& word, size_t const n)
+{
+    for (size_t i = 0u; i < n; ++i)
+    {
+        if (::toupper(static_cast<unsigned char>(word[i])) !=
+            ::toupper(static_cast<unsigned char>(name[i])))
+            return false;
+    }
+
+    // Matched!
+    return true;
+}
+
 //----------------------------------------------------------------------------
 //! \brief Check if the Forth token xt matches the desired Forth word.
 //!
 //! function called by Dictionary::iterate() for looking for a Forth word.
 //----------------------------------------------------------------------------
-static bool policy_compare(Token const *nfa, std::string const& word)
+static bool policy_compare(Token const *nfa, std::string_view const& word)
 {
     // Hidden entry
     if (isSmudge(nfa))
@@ -382,16 +498,11 @@ static bool policy_compare(Token const *nfa, std::string const& word)
         return false;
 
     // Compare names
-    const char* name = NFA2Name(nfa);
-    if (std::strncmp(word.c_str(), name, length))
-        return false;
-
-    // Matched!
-    return true;
+    return matchName(NFA2Name(nfa), word, length);
 }
 
 //----------------------------------------------------------------------------
-int Dictionary::find(std::string const& word, Token& nfa) const
+int Dictionary::find(std::string_view const& word, Token& nfa) const
 {
     nfa = m_last;
     if (!iterate(policy_compare, nfa, 0, word))
@@ -403,7 +514,7 @@ int Dictionary::find(std::string const& word, Token& nfa) const
 }
 
 //----------------------------------------------------------------------------
-bool Dictionary::findWord(std::string const& word, Token& xt, bool& immediate) const
+bool Dictionary::findWord(std::string_view const& word, Token& xt, bool& immediate) const
 {
     Token iter = m_last;
     if (!iterate(policy_compare, iter, 0, word))
@@ -421,7 +532,7 @@ bool Dictionary::findWord(std::string const& word, Token& xt, bool& immediate) c
 }
 
 //----------------------------------------------------------------------------
-bool Dictionary::has(std::string const& word) const
+bool Dictionary::has(std::string_view const& word) const
 {
     Token iter = m_last;
     return iterate(policy_compare, iter, 0, word);
@@ -487,30 +598,28 @@ const char* Dictionary::autocomplete(std::string const& partial, Token& nfa) con
 }
 
 //----------------------------------------------------------------------------
-static bool policy_smudge(Token const *nfa, std::string const& word)
+static bool policy_smudge(Token const *nfa, std::string_view const& word)
 {
     // Hidden entry
     if (*nfa & SMUDGE_BIT)
         return false;
 
     // Compare partial names
-    const char* name = NFA2Name(nfa);
-    if (std::strncmp(word.c_str(), name, word.size()))
-        return false;
-
-    // Matched!
-    return true;
+    return matchName(NFA2Name(nfa), word, word.size());
 }
 
 //----------------------------------------------------------------------------
 // TODO do not let the user smudge system words by replacing the 0 by the last
 // word entry
-bool Dictionary::smudge(std::string const& word)
+bool Dictionary::smudge(std::string_view const& word)
 {
     Token iter = m_last;
     bool ret = iterate(policy_smudge, iter, 0, word);
     if (ret)
+    {
         m_memory[iter] |= SMUDGE_BIT;
+        ++m_generation;
+    }
     return ret;
 }
 
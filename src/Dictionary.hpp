@@ -22,6 +22,7 @@
 #  define INTERNAL_FORTH_DICTIONARY_HPP
 
 #  include "Utils.hpp"
+#  include <memory>
 #  include <string>
 
 namespace forth
@@ -53,10 +54,50 @@ constexpr size_t dictionary = 1_z << (8_z * size::token); // bytes
 //! \brief Size for the Terminal Input Buffer
 constexpr size_t tib = 64_z; // cells = (size::tib * size::token bytes)
 
+//! \brief Maximal number of chars of a string stored inside the dictionary
+//! (the number of chars is stored in a token).
+constexpr size_t string = (1_z << (8_z * size::token)) - 1_z; // chars
+
 //! \brief Maximal number of chars constituing the name of a Forth word.
 constexpr size_t word = 32_z; // chars (or bytes)
 }
 
+class Dictionary;
+
+//****************************************************************************
+//! \brief Immutable image of a booted dictionary created by
+//! Dictionary::freeze(). The image is held by an anonymous shared memory file
+//! mapped privately by each Dictionary created from it: memory pages are
+//! shared until an interpreter writes into them (copy-on-write by the
+//! kernel). Dictionaries created from the same image can therefore be used
+//! by interpreters running on different threads.
+//****************************************************************************
+class DictionaryImage
+{
+public:
+
+    ~DictionaryImage();
+
+    DictionaryImage(DictionaryImage const&) = delete;
+    DictionaryImage& operator=(DictionaryImage const&) = delete;
+
+private:
+
+    DictionaryImage() = default;
+
+    //! \brief File descriptor of the anonymous shared memory.
+    int m_fd = -1;
+    //! \brief HERE, LAST and number of primitives of the frozen dictionary.
+    Token m_here = 0;
+    Token m_last = 0;
+    Token m_max_primitives = 0;
+
+    friend class Dictionary;
+};
+
+//! \brief Frozen dictionary shared by several interpreters.
+using SharedDictionary = std::shared_ptr<DictionaryImage const>;
+
 //****************************************************************************
 //! \brief A Forth dictionary holds the byte code (compiled Forth words) and
 //! data (variables, constants).
@@ -72,9 +113,26 @@ public:
 
     //--------------------------------------------------------------------------
     //! \brief Constructor. Dictionary is set empty. States are set to default.
+    //! \throw std::bad_alloc if the memory cannot be mapped.
     //--------------------------------------------------------------------------
     Dictionary();
-    virtual ~Dictionary() = default;
+
+    //--------------------------------------------------------------------------
+    //! \brief Constructor. Start from the content of a frozen dictionary.
+    //! Words defined later are stored after the frozen ones in a private
+    //! overlay: only modified memory pages are duplicated and looking for a
+    //! word falls through from new definitions to the frozen ones.
+    //! \throw std::bad_alloc if the memory cannot be mapped.
+    //--------------------------------------------------------------------------
+    explicit Dictionary(SharedDictionary const& image);
+
+    //--------------------------------------------------------------------------
+    //! \brief Destructor. Unmap the memory.
+    //--------------------------------------------------------------------------
+    virtual ~Dictionary();
+
+    Dictionary(Dictionary const&) = delete;
+    Dictionary& operator=(Dictionary const&) = delete;
 
     //--------------------------------------------------------------------------
     //! \brief Empty the dictionary and reset internal states to default values.
@@ -83,6 +141,20 @@ public:
     //--------------------------------------------------------------------------
     void clear();
 
+    //--------------------------------------------------------------------------
+    //! \brief Take an immutable image of the dictionary. The dictionary can
+    //! still be modified: the image is not affected.
+    //! \throw std::bad_alloc if the shared memory cannot be created.
+    //--------------------------------------------------------------------------
+    SharedDictionary freeze() const;
+
+    //--------------------------------------------------------------------------
+    //! \brief Set HERE and LAST back to the given values. Used when rolling
+    //! back to a checkpoint (the content of the memory is restored by the
+    //! caller).
+    //--------------------------------------------------------------------------
+    void rewind(Token const here, Token const last);
+
     //--------------------------------------------------------------------------
     //! \brief Restore the dictionary to its previous state.
     //!
@@ -145,11 +217,12 @@ public:
 
     //--------------------------------------------------------------------------
     //! \brief Append a count string in the dictionary. HERE is updated.
-    //! \todo TODO check bounds
     //! \param[in] s the string to store.
     //! \param[in] here the location in the dictionary.
+    //! \throw forth::Exception if the string does not fit inside the
+    //! dictionary.
     //--------------------------------------------------------------------------
-    void append(std::string& s, Token& here);
+    void append(std::string_view const& s, Token& here);
 
     //--------------------------------------------------------------------------
     //! \brief Move a bulk of data inside the dictionary.
@@ -224,7 +297,7 @@ public:
     //--------------------------------------------------------------------------
     //! \brief ANSI-Forth API
     //--------------------------------------------------------------------------
-    int find(std::string const& word, Token& nfa) const;
+    int find(std::string_view const& word, Token& nfa) const;
 
     //--------------------------------------------------------------------------
     //! \brief Look for if a Forth word is stored inside the dictionary and
@@ -236,8 +309,10 @@ public:
     //! false id the word is not found.
     //! \return true if the word has been found, else return false.
     //! \note Smudged words are ignored.
+    //! \note The search is case insensitive: the word does not have to be
+    //! converted to upper case first.
     //--------------------------------------------------------------------------
-    bool findWord(std::string const& word, Token& xt, bool& immediate) const;
+    bool findWord(std::string_view const& word, Token& xt, bool& immediate) const;
 
     //--------------------------------------------------------------------------
     //! \brief Look for a Forth execution token inside the dictionary.
@@ -256,7 +331,7 @@ public:
     //! \param[in] word the name of the forth word to find.
     //! \return true if the word has been found, else return false.
     //--------------------------------------------------------------------------
-    bool has(std::string const& word) const;
+    bool has(std::string_view const& word) const;
 
     //--------------------------------------------------------------------------
     //! \brief Look for a Forth execution token (code fieldd) and return the
@@ -284,7 +359,7 @@ public:
     //--------------------------------------------------------------------------
     //! \brief Display the definition of a given word name.
     //--------------------------------------------------------------------------
-    bool see(std::string const& word, int base);
+    bool see(std::string_view const& word, int base);
 
     //--------------------------------------------------------------------------
     //! \brief Auto-complete the Forth name with first found definition.
@@ -305,7 +380,7 @@ public:
     //! \note This is a deviation from ANSI Forth since original drops out all
     //! words previously defined to the designated one.
     //--------------------------------------------------------------------------
-    bool smudge(std::string const& word);
+    bool smudge(std::string_view const& word);
 
     //--------------------------------------------------------------------------
     //! \brief Return the last error message.
@@ -324,6 +399,15 @@ public:
         return m_last;
     }
 
+    //--------------------------------------------------------------------------
+    //! \brief Return a counter changed each time words are created or
+    //! removed. Allow to know cheaply if names may refer to other definitions.
+    //--------------------------------------------------------------------------
+    uint32_t generation() const
+    {
+        return m_generation;
+    }
+
     //--------------------------------------------------------------------------
     //! \brief Return the index of the first empty room in the dictionary.
     //--------------------------------------------------------------------------
@@ -440,9 +524,10 @@ private:
 
     //--------------------------------------------------------------------------
     //! \brief The memory of the dictionary containing Forth definitions compiled
-    //! as byte code.
+    //! as byte code. The memory is mapped with mmap() and therefore is page
+    //! aligned, allowing copy-on-write checkpoints (see CopyOnWrite).
     //--------------------------------------------------------------------------
-    Token m_memory[size::dictionary] = {0};
+    Token* m_memory;
 
     //--------------------------------------------------------------------------
     //! \brief Forth words: HERE, DP. Hold the address of the first free slot in
@@ -465,6 +550,16 @@ private:
 
     Token m_max_primitives = 0u;
 
+    //--------------------------------------------------------------------------
+    //! \brief See generation().
+    //--------------------------------------------------------------------------
+    uint32_t m_generation = 0u;
+
+    //--------------------------------------------------------------------------
+    //! \brief Frozen dictionary mapped by m_memory (if any).
+    //--------------------------------------------------------------------------
+    SharedDictionary m_image;
+
 public:
 
     Backup m_backup;
@@ -494,12 +494,11 @@ void Dictionary::display(Token const *nfa, int base, Token const IP)
 }
 
 //----------------------------------------------------------------------------
-bool Dictionary::see(std::string const& word, int base)
+bool Dictionary::see(std::string_view const& word, int base)
 {
     Token xt = m_last;
     Token const* prev = m_memory + m_here;
-    std::string w = word;
-    toUpper(w);
+    std::string w = toUpper(word);
     return iterate(policy_see, xt, 0, *this, &prev, w, base, m_max_primitives);
 }
 
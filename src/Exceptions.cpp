@@ -24,4 +24,7 @@ namespace forth
 {
     //! This macro (from the library POCO) will generate code for members.
     IMPLEMENT_EXCEPTION(Exception, ::Exception, "Forth Exception")
+    IMPLEMENT_EXCEPTION(BudgetExhausted, Exception, "Forth Budget Exhausted")
+    IMPLEMENT_EXCEPTION(DeadlineExceeded, Exception, "Forth Deadline Exceeded")
+    IMPLEMENT_EXCEPTION(Suspension, Exception, "Forth Suspension")
 }
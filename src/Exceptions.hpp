@@ -31,6 +31,15 @@ namespace forth
     //! This macro (from the library POCO) will declare a class
     //! ForthException derived from simtadyn::Exception.
     DECLARE_EXCEPTION(Exception, ::Exception);
+
+    //! Thrown when a script has consumed its instruction budget or reached its
+    //! deadline (see Options::budget, Options::timeout).
+    DECLARE_EXCEPTION(BudgetExhausted, Exception);
+    DECLARE_EXCEPTION(DeadlineExceeded, Exception);
+
+    //! Not an error: thrown when the slice of a script executed by
+    //! Interpreter::run() is over.
+    DECLARE_EXCEPTION(Suspension, Exception);
 }
 
 #endif // FORTH_EXCEPTION_HPP
@@ -0,0 +1,239 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+#include "Heap.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace forth
+{
+
+//! \brief Granularity of pages committed when the bump pointer grows.
+static constexpr size_t COMMIT_CHUNK = 1_z << 20; // bytes
+
+//------------------------------------------------------------------------------
+Heap::Heap(size_t const reserve)
+    : m_reserved(std::min(reserve, size::heap))
+{
+    void* mem = ::mmap(nullptr, m_reserved, PROT_NONE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED)
+        throw std::bad_alloc();
+    m_memory = static_cast<char*>(mem);
+    m_free.fill(NONE);
+}
+
+//------------------------------------------------------------------------------
+Heap::~Heap()
+{
+    ::munmap(m_memory, m_reserved);
+}
+
+//------------------------------------------------------------------------------
+void Heap::reset()
+{
+    m_hint = NONE;
+    m_top = 0u;
+    m_used = 0u;
+    m_free.fill(NONE);
+}
+
+//------------------------------------------------------------------------------
+Int Heap::allocate(size_t const bytes)
+{
+    if (bytes > m_reserved - sizeof(Block))
+        return 0;
+
+    // Size class: smallest power of two holding the header and the data
+    uint32_t sizeClass = MIN_CLASS;
+    while ((1_z << sizeClass) < bytes + sizeof(Block))
+        ++sizeClass;
+    size_t const length = 1_z << sizeClass;
+
+    // Recycle a freed block. A corrupted free list is dropped.
+    size_t offset = m_free[sizeClass];
+    if ((offset != NONE) && (header(offset, sizeClass, MAGIC_FREE) == nullptr))
+    {
+        offset = NONE;
+        m_free[sizeClass] = NONE;
+    }
+    if (offset != NONE)
+    {
+        Block* b = reinterpret_cast<Block*>(m_memory + offset);
+        m_free[sizeClass] = b->next;
+    }
+    else
+    {
+        // Take a new block from the bump pointer, aligned on its size
+        offset = (m_top + length - 1u) & ~(length - 1u);
+        if ((offset < m_top) || (length > m_reserved) || (offset > m_reserved - length))
+            return 0;
+
+        if (offset + length > m_committed)
+        {
+            size_t const page = size_t(::sysconf(_SC_PAGESIZE));
+            size_t commit = std::max(offset + length - m_committed, COMMIT_CHUNK);
+            commit = std::min(((commit + page - 1u) / page) * page,
+                              m_reserved - m_committed);
+            if (::mprotect(m_memory + m_committed, commit, PROT_READ | PROT_WRITE) != 0)
+                return 0;
+            m_committed += commit;
+        }
+        pad(offset);
+        m_top = offset + length;
+    }
+
+    Block* b = reinterpret_cast<Block*>(m_memory + offset);
+    b->magic = MAGIC_USED;
+    b->sizeClass = sizeClass;
+    b->next = NONE;
+    m_used += length;
+
+    return address(offset);
+}
+
+//------------------------------------------------------------------------------
+void Heap::pad(size_t const offset)
+{
+    // The gap is split into blocks aligned on their size: the largest power
+    // of two dividing the bump pointer.
+    while (m_top < offset)
+    {
+        size_t const length = m_top & (~m_top + 1u);
+        uint32_t sizeClass = MIN_CLASS;
+        while ((1_z << sizeClass) < length)
+            ++sizeClass;
+
+        Block* b = reinterpret_cast<Block*>(m_memory + m_top);
+        b->magic = MAGIC_FREE;
+        b->sizeClass = sizeClass;
+        b->next = m_free[sizeClass];
+        m_free[sizeClass] = m_top;
+        m_top += length;
+    }
+}
+
+//------------------------------------------------------------------------------
+Heap::Block* Heap::header(size_t const offset, uint32_t const sizeClass,
+                          uint32_t const magic)
+{
+    size_t const length = 1_z << sizeClass;
+    if ((offset >= m_top) || (length > m_top - offset) ||
+        ((offset & (length - 1u)) != 0u))
+        return nullptr;
+
+    Block* b = reinterpret_cast<Block*>(m_memory + offset);
+    if ((b->magic != magic) || (b->sizeClass != sizeClass))
+        return nullptr;
+    return b;
+}
+
+//------------------------------------------------------------------------------
+char* Heap::payload(size_t const offset, size_t const nbBytes)
+{
+    // Block found by the previous access
+    if (m_hint != NONE)
+    {
+        Block const* b = reinterpret_cast<Block const*>(m_memory + m_hint);
+        if ((b->sizeClass < MAX_CLASSES) &&
+            (header(m_hint, b->sizeClass, MAGIC_USED) != nullptr) &&
+            (offset >= m_hint + sizeof(Block)) &&
+            (offset + nbBytes <= m_hint + (1_z << b->sizeClass)))
+            return m_memory + offset;
+    }
+
+    // Blocks are aligned on their size: the block of class c holding the
+    // offset starts at the offset rounded down to 2^c. Bytes written by
+    // Forth words inside a payload can only mimic a header describing a
+    // part of this payload.
+    for (uint32_t c = MIN_CLASS; c < MAX_CLASSES; ++c)
+    {
+        size_t const length = 1_z << c;
+        size_t const start = offset & ~(length - 1u);
+        if ((header(start, c, MAGIC_USED) != nullptr) &&
+            (offset >= start + sizeof(Block)) &&
+            (offset + nbBytes <= start + length))
+        {
+            m_hint = start;
+            return m_memory + offset;
+        }
+        if (length > m_top)
+            break;
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+Heap::Block* Heap::block(Int const address)
+{
+    if ((address < base) || (address - base > Int(m_top)))
+        return nullptr;
+
+    Int const offset = (address - base) * Int(size::token) - Int(sizeof(Block));
+    if ((offset < 0) || (size_t(offset) >= m_top) ||
+        ((offset % (1 << MIN_CLASS)) != 0))
+        return nullptr;
+
+    Block* b = reinterpret_cast<Block*>(m_memory + offset);
+    if (b->sizeClass >= MAX_CLASSES)
+        return nullptr;
+    return header(size_t(offset), b->sizeClass, MAGIC_USED);
+}
+
+//------------------------------------------------------------------------------
+bool Heap::free(Int const address)
+{
+    Block* b = block(address);
+    if (b == nullptr)
+        return false;
+
+    b->magic = MAGIC_FREE;
+    b->next = m_free[b->sizeClass];
+    m_free[b->sizeClass] = uint64_t(reinterpret_cast<char*>(b) - m_memory);
+    m_used -= 1_z << b->sizeClass;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+Int Heap::resize(Int const address, size_t const bytes)
+{
+    Block* b = block(address);
+    if (b == nullptr)
+        return 0;
+
+    // The block is already large enough
+    size_t const capacity = (1_z << b->sizeClass) - sizeof(Block);
+    if (bytes <= capacity)
+        return address;
+
+    Int const other = allocate(bytes);
+    if (other == 0)
+        return 0;
+
+    // Note: allocate() does not move the arena: b is still valid.
+    std::memcpy(at(other, capacity), at(address, capacity), capacity);
+    free(address);
+    return other;
+}
+
+} // namespace forth
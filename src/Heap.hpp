@@ -0,0 +1,314 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+#ifndef INTERNAL_FORTH_HEAP_HPP
+#  define INTERNAL_FORTH_HEAP_HPP
+
+#  include "Dictionary.hpp"
+#  include <array>
+#  include <cstring>
+
+namespace forth
+{
+
+namespace size
+{
+//! \brief Virtual memory reserved for the heap of each interpreter. Pages are
+//! only committed when allocations reach them.
+constexpr size_t heap = 1_z << 32; // bytes
+}
+
+//******************************************************************************
+//! \brief Dynamic memory of the Forth words ALLOCATE, FREE and RESIZE.
+//!
+//! The dictionary is limited to 64K tokens and shared between code and data.
+//! The heap is a second address space placed just after the dictionary one:
+//! addresses of [Heap::base, Heap::end[ refer to the heap (in tokens like
+//! dictionary addresses) and byte addresses (used by BYTE@ and BYTE!) of
+//! [2 * Heap::base, 2 * Heap::end[ refer to heap bytes. Words accessing the
+//! memory dispatch on these ranges.
+//!
+//! The memory is an arena reserved once with mmap() and filled by a bump
+//! pointer. Freed blocks are recycled through free lists of power-of-two size
+//! classes. reset() releases all blocks at once in O(1).
+//!
+//! Blocks are aligned on their size: the block holding a given byte is found
+//! from its address, so that accesses are checked against the payload of an
+//! allocated block and never reach the block headers.
+//******************************************************************************
+class Heap
+{
+public:
+
+    //! \brief First token address of the heap (just after the dictionary).
+    static constexpr Int base = Int(size::dictionary);
+    //! \brief Token address following the largest heap.
+    static constexpr Int end = base + Int(size::heap / size::token);
+
+    //--------------------------------------------------------------------------
+    //! \brief Constructor. Reserve the address space of the arena.
+    //! \param[in] reserve the maximum number of bytes the heap can hold. It
+    //! is limited to size::heap.
+    //! \throw std::bad_alloc if the memory cannot be mapped.
+    //--------------------------------------------------------------------------
+    Heap(size_t const reserve = size::heap);
+
+    //--------------------------------------------------------------------------
+    //! \brief Destructor. Unmap the arena.
+    //--------------------------------------------------------------------------
+    ~Heap();
+
+    Heap(Heap const&) = delete;
+    Heap& operator=(Heap const&) = delete;
+
+    //--------------------------------------------------------------------------
+    //! \brief Return true if the token address refers to the heap.
+    //--------------------------------------------------------------------------
+    static inline bool owns(Int const address)
+    {
+        return (address >= base) && (address < end);
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return true if the byte address refers to the heap.
+    //--------------------------------------------------------------------------
+    static inline bool ownsByte(Int const address)
+    {
+        return (address >= 2 * base) && (address < 2 * end);
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Allocate a block of memory.
+    //! \param[in] bytes the size of the block.
+    //! \return the token address of the block or 0 if the heap is exhausted.
+    //--------------------------------------------------------------------------
+    Int allocate(size_t const bytes);
+
+    //--------------------------------------------------------------------------
+    //! \brief Release a block of memory given by allocate().
+    //! \return false if the address does not refer to an allocated block.
+    //--------------------------------------------------------------------------
+    bool free(Int const address);
+
+    //--------------------------------------------------------------------------
+    //! \brief Change the size of a block, moving its content if needed.
+    //! \return the new token address of the block or 0 if the address is not
+    //! an allocated block or if the heap is exhausted (in this case the
+    //! original block is left untouched).
+    //--------------------------------------------------------------------------
+    Int resize(Int const address, size_t const bytes);
+
+    //--------------------------------------------------------------------------
+    //! \brief Release all blocks in O(1). Committed pages are kept for the
+    //! next allocations.
+    //--------------------------------------------------------------------------
+    void reset();
+
+    //--------------------------------------------------------------------------
+    //! \brief Bookkeeping of the heap (bump pointer and free lists). The
+    //! content of blocks is not part of it.
+    //--------------------------------------------------------------------------
+    struct Mark
+    {
+        size_t top;
+        size_t used;
+        //! \brief One free list per size class (see MAX_CLASSES).
+        std::array<uint64_t, 64u> free;
+    };
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the current bookkeeping, to be given back to rewind().
+    //--------------------------------------------------------------------------
+    inline Mark mark() const
+    {
+        return { m_top, m_used, m_free };
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Restore a bookkeeping given by mark(). Used when rolling back
+    //! to a checkpoint (the content of blocks is restored by the caller).
+    //--------------------------------------------------------------------------
+    inline void rewind(Mark const& mark)
+    {
+        m_hint = NONE;
+        m_top = mark.top;
+        m_used = mark.used;
+        m_free = mark.free;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the start of the readable and writable part of the arena.
+    //--------------------------------------------------------------------------
+    inline char* arena() const
+    {
+        return m_memory;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the number of bytes readable and writable. Committed
+    //! pages are never given back.
+    //--------------------------------------------------------------------------
+    inline size_t committed() const
+    {
+        return m_committed;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the number of bytes given by the bump pointer: blocks
+    //! are placed inside [arena(), arena() + top()[.
+    //--------------------------------------------------------------------------
+    inline size_t top() const
+    {
+        return m_top;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the number of bytes used by allocated blocks and their
+    //! headers.
+    //--------------------------------------------------------------------------
+    inline size_t used() const
+    {
+        return m_used;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the pointer on nbBytes bytes starting at the given token
+    //! address or nullptr if they are not inside the payload of a block.
+    //--------------------------------------------------------------------------
+    inline char* at(Int const address, size_t const nbBytes)
+    {
+        return byteAt(2 * address, nbBytes);
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the pointer on nbBytes bytes starting at the given byte
+    //! address or nullptr if they are not inside the payload of a block.
+    //--------------------------------------------------------------------------
+    inline char* byteAt(Int const address, size_t const nbBytes)
+    {
+        Int const offset = address - 2 * base;
+        if ((offset < 0) || (size_t(offset) >= m_top) ||
+            (nbBytes > m_top - size_t(offset)))
+            return nullptr;
+        return payload(size_t(offset), nbBytes);
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Read a value of type T at the given token address.
+    //! \return false if the address is outside the heap.
+    //--------------------------------------------------------------------------
+    template<typename T>
+    inline bool fetch(Int const address, T& value)
+    {
+        char const* p = at(address, sizeof(T));
+        if (p == nullptr)
+            return false;
+        std::memcpy(&value, p, sizeof(T));
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Write a value of type T at the given token address.
+    //! \return false if the address is outside the heap.
+    //--------------------------------------------------------------------------
+    template<typename T>
+    inline bool store(Int const address, T const value)
+    {
+        char* p = at(address, sizeof(T));
+        if (p == nullptr)
+            return false;
+        std::memcpy(p, &value, sizeof(T));
+        return true;
+    }
+
+private:
+
+    //! \brief Header placed before each block.
+    struct Block
+    {
+        //! \brief Magic number telling if the block is allocated or free.
+        uint32_t magic;
+        //! \brief Size class: the block (header included) holds 2^sizeClass
+        //! bytes.
+        uint32_t sizeClass;
+        //! \brief Next free block of the same class (offset) when the block
+        //! is free.
+        uint64_t next;
+    };
+
+    static constexpr uint32_t MAGIC_USED = 0x48454150u; // "HEAP"
+    static constexpr uint32_t MAGIC_FREE = 0x46524545u; // "FREE"
+    static constexpr uint64_t NONE = ~uint64_t(0);
+    //! \brief Smallest block: header + 16 bytes.
+    static constexpr uint32_t MIN_CLASS = 5u;
+    static constexpr uint32_t MAX_CLASSES = 64u;
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the block header of a token address or nullptr if the
+    //! address is not the start of an allocated block.
+    //--------------------------------------------------------------------------
+    Block* block(Int const address);
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the block header at the given offset or nullptr if it
+    //! is not the header of a block of the given class and state.
+    //--------------------------------------------------------------------------
+    Block* header(size_t const offset, uint32_t const sizeClass, uint32_t const magic);
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the pointer on the nbBytes bytes at the given offset or
+    //! nullptr if they are not inside the payload of an allocated block.
+    //! \pre offset + nbBytes <= m_top.
+    //--------------------------------------------------------------------------
+    char* payload(size_t const offset, size_t const nbBytes);
+
+    //--------------------------------------------------------------------------
+    //! \brief Put on the free lists the blocks filling [m_top, offset) so
+    //! that the bump pointer reaches an offset aligned on a larger block.
+    //--------------------------------------------------------------------------
+    void pad(size_t const offset);
+
+    //--------------------------------------------------------------------------
+    //! \brief Convert a block offset to the token address of its payload.
+    //--------------------------------------------------------------------------
+    static inline Int address(size_t const offset)
+    {
+        return base + Int((offset + sizeof(Block)) / size::token);
+    }
+
+    //! \brief Reserved address space.
+    char*  m_memory = nullptr;
+    //! \brief Size of the reserved address space.
+    size_t m_reserved;
+    //! \brief Number of bytes readable and writable.
+    size_t m_committed = 0u;
+    //! \brief Bump pointer: offset of the first never allocated byte.
+    size_t m_top = 0u;
+    //! \brief Number of bytes held by allocated blocks.
+    size_t m_used = 0u;
+    //! \brief Offset of the first free block of each size class.
+    std::array<uint64_t, MAX_CLASSES> m_free;
+    //! \brief Offset of the block found by the last call to payload().
+    size_t m_hint = NONE;
+};
+
+} // namespace forth
+
+#endif // INTERNAL_FORTH_HEAP_HPP
@@ -20,32 +20,90 @@
 
 #include "Interpreter.hpp"
 //#include "Primitives.hpp"
+#include "Channel.hpp"
 #include "Exceptions.hpp"
 #include "Streams.hpp"
 #include "Utils.hpp"
+#include <algorithm>
 #include <cassert>
+#include <csignal>
+#include <cstring>
+#include <mutex>
 
 namespace forth
 {
 
-#define CHECK_UNDERFLOW(S, xt)                                                 \
-    if (S.hasUnderflowed()) {                                                  \
-        THROW(S.name() + "-Stack underflow caused by word "                    \
-              + m_dictionary.token2name(xt));                                  \
+//------------------------------------------------------------------------------
+//! \brief Context of the thread currently executing Forth words: the SIGSEGV
+//! handler uses it when a stack guard page has been hit.
+static thread_local Interpreter* t_forth = nullptr;
+
+//------------------------------------------------------------------------------
+//! \brief Install once a SIGSEGV/SIGBUS handler recording stack guard page
+//! faults: the faulting instruction is replayed and the interpreter throws
+//! once the current word has returned (see Interpreter::executeToken()).
+//! No frame is skipped: C++ destructors run as usual. Other faults are
+//! forwarded to the previously installed handler.
+struct StackGuard
+{
+    static void install()
+    {
+        static std::once_flag once;
+        std::call_once(once, []()
+        {
+            struct sigaction action;
+            ::memset(&action, 0, sizeof(action));
+            action.sa_sigaction = handler;
+            action.sa_flags = SA_SIGINFO | SA_NODEFER;
+            ::sigemptyset(&action.sa_mask);
+            ::sigaction(SIGSEGV, &action, &previous(SIGSEGV));
+            ::sigaction(SIGBUS, &action, &previous(SIGBUS));
+        });
     }
 
-#define CHECK_OVERFLOW(S, xt)                                                  \
-    if (S.hasOverflowed()) {                                                   \
-        THROW(S.name() + "-Stack overflow caused by word "                     \
-              + m_dictionary.token2name(xt));                                  \
+    static struct sigaction& previous(int const sig)
+    {
+        static struct sigaction segv;
+        static struct sigaction bus;
+        return (sig == SIGSEGV) ? segv : bus;
     }
 
+    static void handler(int sig, siginfo_t* info, void* context)
+    {
+        // First write into a page protected by a checkpoint: the page has
+        // been saved, replay the instruction.
+        if ((sig == SIGSEGV) && CopyOnWrite::fault(info->si_addr))
+            return ;
+
+        if ((t_forth != nullptr) && t_forth->hitGuardPage(info->si_addr))
+            return ;
+
+        struct sigaction& old = previous(sig);
+        if (old.sa_flags & SA_SIGINFO)
+            old.sa_sigaction(sig, info, context);
+        else if ((old.sa_handler != SIG_DFL) && (old.sa_handler != SIG_IGN))
+            old.sa_handler(sig);
+        else
+        {
+            // Restore the default behavior: the faulting instruction is
+            // replayed when returning and the signal is handled as usual.
+            ::sigaction(sig, &old, nullptr);
+        }
+    }
+};
+
 //------------------------------------------------------------------------------
 Interpreter::Interpreter(Dictionary& dico, Options const& options)
     : m_dictionary(dico),
       m_options(options),
-      m_clibs(m_path)
-{}
+      DS(options.data_stack_depth),
+      AS(options.auxiliary_stack_depth),
+      RS(options.return_stack_depth),
+      m_clibs(m_path),
+      m_natives(std::make_shared<Natives>())
+{
+    StackGuard::install();
+}
 
 //------------------------------------------------------------------------------
 Interpreter::~Interpreter()
@@ -55,6 +113,188 @@ Interpreter::~Interpreter()
         popStream();
 }
 
+//------------------------------------------------------------------------------
+Token* Interpreter::memory(Int const address, Int const nbTokens)
+{
+    if (!Heap::owns(address))
+        return m_dictionary() + Token(address);
+
+    char* p = ((nbTokens < 0) || (size_t(nbTokens) > SIZE_MAX / size::token))
+              ? nullptr : m_heap.at(address, size_t(nbTokens) * size::token);
+    if (p == nullptr)
+    {
+        THROW("Invalid heap address " + std::to_string(address));
+    }
+    return reinterpret_cast<Token*>(p);
+}
+
+//------------------------------------------------------------------------------
+//! \brief Check that a range of cells inside the dictionary does not overflow
+//! it (ranges inside the heap are checked by Interpreter::memory()).
+static void checkCellRange(Int const address, Int const count)
+{
+    Int const tokens = count * Int(size::cell / size::token);
+    if ((count < 0) || (!Heap::owns(address) &&
+        ((address < 0) || (address + tokens > Int(size::dictionary)))))
+    {
+        THROW("Invalid range of " + std::to_string(count) + " cells at address "
+              + std::to_string(address));
+    }
+}
+
+//------------------------------------------------------------------------------
+Token* Interpreter::cells(Int const address, Int const count)
+{
+    checkCellRange(address, count);
+    return memory(address, count * Int(size::cell / size::token));
+}
+
+//------------------------------------------------------------------------------
+Interpreter* Interpreter::current() noexcept
+{
+    return t_forth;
+}
+
+//------------------------------------------------------------------------------
+std::vector<Cell> Interpreter::fetchCells(Int const address, Int const count,
+                                          bool const reals)
+{
+    Token const* ptr = cells(address, count);
+    std::vector<Cell> result(static_cast<size_t>(count));
+    for (auto& it: result)
+    {
+        if (reals)
+        {
+            Real r;
+            std::memcpy(&r, ptr, sizeof(Real));
+            it = Cell::real(r);
+        }
+        else
+        {
+            Int i;
+            std::memcpy(&i, ptr, sizeof(Int));
+            it = Cell::integer(i);
+        }
+        ptr += size::cell / size::token;
+    }
+    return result;
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::storeCells(Int const address, std::vector<Cell> const& cells,
+                             bool const reals)
+{
+    Token* ptr = this->cells(address, Int(cells.size()));
+    for (auto const& it: cells)
+    {
+        if (it.isInteger() && !reals)
+        {
+            Int const i = it.integer();
+            std::memcpy(ptr, &i, sizeof(Int));
+        }
+        else
+        {
+            Real const r = it.real();
+            std::memcpy(ptr, &r, sizeof(Real));
+        }
+        ptr += size::cell / size::token;
+    }
+}
+
+//------------------------------------------------------------------------------
+std::string_view Interpreter::string(Int const address, Int const length)
+{
+    if (!StringHeap::owns(address))
+    {
+        if ((address < 0) || (length < 0) ||
+            (2 * (address + 1) + length > 2 * Int(size::dictionary)))
+        {
+            THROW("Invalid string of " + std::to_string(length) + " chars at address "
+                  + std::to_string(address));
+        }
+        return std::string_view(reinterpret_cast<char const*>(
+            &m_dictionary[Token(address + 1)]), size_t(length));
+    }
+
+    std::string const* s = m_strings.get(address);
+    if (s == nullptr)
+    {
+        THROW("Invalid string handle " + std::to_string(address));
+    }
+    return std::string_view(*s).substr(0u, size_t(std::max(length, Int(0))));
+}
+
+//------------------------------------------------------------------------------
+char const* Interpreter::cstring(Int const address)
+{
+    if (!StringHeap::owns(address))
+        return reinterpret_cast<char const*>(&m_dictionary[Token(address + 1)]);
+
+    std::string const* s = m_strings.get(address);
+    if (s == nullptr)
+    {
+        THROW("Invalid string handle " + std::to_string(address));
+    }
+    return s->c_str();
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::pushString(std::string_view const& s)
+{
+    DPUSHI(m_strings.intern(s));
+    DPUSHI(Int(s.size()));
+
+    // The new handle is on the data stack: it is kept
+    if (m_strings.crowded() && (m_reentries == 0))
+        collectStrings();
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::collectStrings()
+{
+    auto markCells = [this](Cell const* cell, Cell const* end)
+    {
+        for (; cell < end; ++cell)
+        {
+            if (cell->isInteger())
+                m_strings.mark(cell->integer());
+        }
+    };
+
+    // Stacks of the running task and parked stacks of the other ones
+    markCells(DS.bottom(), DS.top());
+    markCells(AS.bottom(), AS.top());
+    for (auto const& ctx: m_contexts)
+    {
+        markCells(ctx->DS.bottom(), ctx->DS.top());
+        markCells(ctx->AS.bottom(), ctx->AS.top());
+    }
+
+    // Handles may be stored at any token address of the dictionary and heap
+    auto markMemory = [this](char const* memory, size_t const bytes)
+    {
+        for (size_t i = 0u; i + sizeof(Int) <= bytes; i += size::token)
+        {
+            Int value;
+            std::memcpy(&value, memory + i, sizeof(Int));
+            if (StringHeap::owns(value))
+                m_strings.mark(value);
+        }
+    };
+    markMemory(reinterpret_cast<char const*>(m_dictionary()),
+               size::dictionary * size::token);
+    markMemory(m_heap.arena(), m_heap.top());
+
+    // Cells not yet received
+    Channel::scan([this](Cell const& cell)
+    {
+        if (cell.isInteger())
+            m_strings.mark(cell.integer());
+    });
+
+    m_strings.sweep(m_snapshots.empty() ? 0u : m_snapshots.back().strings);
+}
+
 //------------------------------------------------------------------------------
 Token Interpreter::countPrimitives() const
 {
@@ -66,17 +306,280 @@ void Interpreter::abort()
 {
     m_state = State::Interprete;
     m_dictionary.restore();
+    resetTasks();
     DS.reset();
     AS.reset();
     RS.reset();
+    m_heap.reset();
     m_level = 0;
+    m_rollback = -1;
     resetStreams();
+    // Keep strings referred by checkpoints.
+    m_strings.truncate(m_snapshots.empty() ? 0u : m_snapshots.back().strings);
     restoreOutStates();
 }
 
+//------------------------------------------------------------------------------
+void Interpreter::setWorkers(size_t const count)
+{
+    m_options.workers = count;
+    if (m_pool != nullptr)
+    {
+        m_pool.reset();
+        m_tasks = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+TaskPool& Interpreter::tasks()
+{
+    if (m_tasks == nullptr)
+    {
+        m_pool = std::make_unique<TaskPool>(m_dictionary, m_options,
+                                            m_options.workers, m_natives);
+        m_tasks = m_pool.get();
+    }
+    return *m_tasks;
+}
+
+//------------------------------------------------------------------------------
+//! \brief Insert an awake task in the ring just before the running task: it
+//! will be the last one of the current round.
+static void link(std::vector<std::unique_ptr<TaskContext>>& ring,
+                 size_t const task, size_t const running)
+{
+    TaskContext& ctx = *ring[task];
+    TaskContext& current = *ring[running];
+    ctx.next = running;
+    ctx.prev = current.prev;
+    ring[current.prev]->next = task;
+    current.prev = task;
+    ctx.status = TaskContext::Awake;
+}
+
+//------------------------------------------------------------------------------
+//! \brief Remove a task from the ring of awake tasks.
+//! \return the task following it.
+static size_t unlink(std::vector<std::unique_ptr<TaskContext>>& ring,
+                     size_t const task, TaskContext::Status const status)
+{
+    TaskContext& ctx = *ring[task];
+    ctx.status = status;
+    ring[ctx.prev]->next = ctx.next;
+    ring[ctx.next]->prev = ctx.prev;
+    return ctx.next;
+}
+
+//------------------------------------------------------------------------------
+Int Interpreter::createTask()
+{
+    if (m_contexts.empty())
+    {
+        // Stacks of the operator are the interpreter ones: its context only
+        // holds the segments parked by the switches, whatever their sizes.
+        m_contexts.push_back(std::make_unique<TaskContext>(1u, 1u, 1u));
+        m_contexts[0]->status = TaskContext::Awake;
+    }
+
+    m_contexts.push_back(std::make_unique<TaskContext>(
+        m_options.data_stack_depth, m_options.auxiliary_stack_depth,
+        m_options.return_stack_depth));
+    return Int(m_contexts.size() - 1u);
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::activateTask(Int const task)
+{
+    if ((task <= 0) || (size_t(task) >= m_contexts.size()))
+    {
+        THROW("ACTIVATE: invalid task " + std::to_string(task));
+    }
+    if (size_t(task) == m_task)
+    {
+        THROW("ACTIVATE: a task cannot activate itself");
+    }
+    if (IP == 65535u)
+    {
+        THROW("ACTIVATE: shall be used inside a definition");
+    }
+
+    TaskContext& ctx = *m_contexts[size_t(task)];
+    ctx.DS.reset();
+    ctx.AS.reset();
+    ctx.RS.reset();
+    // Returning from the definition ends the task (see EXIT)
+    ctx.RS.push(65535u);
+    ctx.IP = IP;
+
+    if (ctx.status != TaskContext::Awake)
+        link(m_contexts, size_t(task), m_task);
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::pauseTask()
+{
+    if (!m_contexts.empty())
+    {
+        size_t const next = m_contexts[m_task]->next;
+        if (next != m_task)
+            switchTask(next);
+    }
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::stopTask()
+{
+    if (m_task == 0u)
+    {
+        THROW("STOP: the operator task cannot be stopped");
+    }
+
+    switchTask(unlink(m_contexts, m_task, TaskContext::Stopped));
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::wakeTask(Int const task)
+{
+    if ((task < 0) || (size_t(task) >= std::max(m_contexts.size(), size_t(1u))))
+    {
+        THROW("WAKE: invalid task " + std::to_string(task));
+    }
+
+    // Idle tasks have nothing to execute, awake tasks are already running
+    if ((task == 0) || (m_contexts[size_t(task)]->status != TaskContext::Stopped))
+        return ;
+
+    link(m_contexts, size_t(task), m_task);
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::endTask()
+{
+    switchTask(unlink(m_contexts, m_task, TaskContext::Idle));
+}
+
+//------------------------------------------------------------------------------
+bool Interpreter::canRetryLater(Token const xt) const
+{
+    // Words interpreted from the stream or called by EXECUTE cannot be
+    // executed again.
+    return (IP != 65535u) && (m_dictionary[IP] == xt) && !m_contexts.empty() &&
+            (m_contexts[m_task]->next != m_task);
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::checkDeadlock(std::string const& word) const
+{
+    if (!m_contexts.empty() && (m_contexts[m_task]->next != m_task))
+    {
+        THROW(word + ": deadlock: the channel is waited outside a definition "
+              "while cooperative tasks are awake");
+    }
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::retryLater()
+{
+    --IP;
+    pauseTask();
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::switchTask(size_t const task)
+{
+    TaskContext& from = *m_contexts[m_task];
+    TaskContext& to = *m_contexts[task];
+
+    // The context of the running task holds the parked segments: rotate them
+    // with the interpreter stacks.
+    from.IP = IP;
+    DS.swap(from.DS); AS.swap(from.AS); RS.swap(from.RS);
+    DS.swap(to.DS); AS.swap(to.AS); RS.swap(to.RS);
+    IP = to.IP;
+    m_task = task;
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::resetTasks()
+{
+    if (m_contexts.empty())
+        return ;
+
+    if (m_task != 0u)
+        switchTask(0u);
+    for (auto& ctx: m_contexts)
+        ctx->status = TaskContext::Idle;
+    m_contexts[0]->status = TaskContext::Awake;
+    m_contexts[0]->next = m_contexts[0]->prev = 0u;
+}
+
+//------------------------------------------------------------------------------
+size_t Interpreter::checkpoint()
+{
+    // Stacks parked by cooperative tasks are not watched
+    if (m_task != 0u)
+    {
+        THROW("Checkpoints shall be taken by the operator task");
+    }
+
+    m_snapshots.push_back({ DS.depth(), AS.depth(), m_base, m_state,
+                            m_dictionary.here(), m_dictionary.last(),
+                            m_heap.mark(), m_strings.size(),
+                            m_clibs.functions().size(), m_natives->count.load(),
+                            m_contexts.size() });
+    try
+    {
+        m_journal.take({
+            { m_dictionary(), size::dictionary * size::token },
+            { DS.bottom(), size_t(DS.capacity()) * sizeof(Cell) },
+            { AS.bottom(), size_t(AS.capacity()) * sizeof(Cell) },
+            { m_heap.arena(), m_heap.committed() }
+        });
+    }
+    catch (std::bad_alloc const&)
+    {
+        m_snapshots.pop_back();
+        THROW("Failed creating a checkpoint");
+    }
+
+    return m_snapshots.size() - 1u;
+}
+
+//------------------------------------------------------------------------------
+bool Interpreter::rollback(size_t const id)
+{
+    if (!m_journal.rollback(id))
+        return false;
+
+    m_snapshots.resize(id + 1u);
+    Snapshot const& snapshot = m_snapshots.back();
+    resetTasks();
+    m_contexts.resize(snapshot.tasks);
+    DS.top() = DS.bottom() + snapshot.ds;
+    AS.top() = AS.bottom() + snapshot.as;
+    RS.reset();
+    m_base = snapshot.base;
+    m_state = snapshot.state;
+    m_dictionary.rewind(snapshot.here, snapshot.last);
+    m_heap.rewind(snapshot.heap);
+    m_strings.truncate(snapshot.strings);
+    // Registered functions refer to the holders of C functions: both are
+    // forgotten together.
+    m_clibs.truncate(snapshot.clibs);
+    m_clibs.forgetCallbacks(snapshot.here);
+    if (snapshot.natives < m_natives->count.load())
+    {
+        m_natives->count.store(snapshot.natives);
+        m_natives->contexts.resize(snapshot.natives);
+        m_dictionary.setCountPrimitives(Token(countPrimitives() + snapshot.natives));
+    }
+    return true;
+}
+
 //------------------------------------------------------------------------------
 bool Interpreter::ok(Result const& result)
 {
+    m_status = result.status;
     if (result.res)
     {
         if (!m_options.quiet)
@@ -107,15 +610,80 @@ bool Interpreter::ok(Result const& result)
 }
 
 //------------------------------------------------------------------------------
-bool Interpreter::toNumber(std::string const& word, Cell& number)
+//! \brief Number of ticks between two readings of the clock.
+static constexpr int64_t WATCHDOG_PERIOD = 1024;
+
+//------------------------------------------------------------------------------
+//! \brief Return the number of ticks before the next check of the limits.
+static int64_t watchdogSlice(size_t const budget, size_t const steps,
+                             TimePoint const& deadline)
 {
-    try
+    int64_t slice = (deadline == TimePoint::max()) ? INT64_MAX : WATCHDOG_PERIOD;
+    if ((budget != 0u) && (budget < uint64_t(slice)))
+        slice = int64_t(budget);
+    if ((steps != 0u) && (steps < uint64_t(slice)))
+        slice = int64_t(steps);
+    return slice;
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::armWatchdog()
+{
+    m_budget = m_options.budget;
+    m_deadline = (m_options.timeout == 0u) ? TimePoint::max() :
+                 Clock::now() + std::chrono::milliseconds(m_options.timeout);
+    m_ticks = m_slice = watchdogSlice(m_budget, 0u, m_deadline);
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::watchdog()
+{
+    if (m_budget != 0u)
     {
-        if (toInteger(word, m_base, number))
-            return true;
-        return toReal(word, number);
+        m_budget -= size_t(m_slice);
+        if (m_budget == 0u)
+        {
+            m_ticks = m_slice = INT64_MAX;
+            throw BudgetExhausted("Instruction budget of " +
+                                  std::to_string(m_options.budget) + " exhausted");
+        }
+    }
+
+    if ((m_deadline != TimePoint::max()) && (Clock::now() >= m_deadline))
+    {
+        m_ticks = m_slice = INT64_MAX;
+        throw DeadlineExceeded("Deadline of " + std::to_string(m_options.timeout) +
+                               " ms exceeded");
+    }
+
+    if (m_steps != 0u)
+    {
+        m_steps -= size_t(m_slice);
+        if (m_steps == 0u)
+        {
+            // Streams included by the script cannot be suspended: check again
+            // at the next tick.
+            m_steps = 1u;
+            if ((SS.depth() == m_slice_depth) && (m_reentries == 0))
+            {
+                if (m_deadline != TimePoint::max())
+                    m_time_left = m_deadline - Clock::now();
+                m_ticks = m_slice = INT64_MAX;
+                throw Suspension();
+            }
+        }
     }
-    catch (const std::out_of_range&)
+
+    m_ticks = m_slice = watchdogSlice(m_budget, m_steps, m_deadline);
+}
+
+//------------------------------------------------------------------------------
+bool Interpreter::toNumber(std::string_view const& word, Cell& number)
+{
+    if (!toInteger(word, m_base, number))
+        return toReal(word, number);
+
+    if (number.isReal())
     {
         std::cerr << FORTH_WARNING_COLOR << "[WARNING] ";
         if (HAS_STREAM())
@@ -127,8 +695,8 @@ bool Interpreter::toNumber(std::string const& word, Cell& number)
         std::cerr << "Limited range of integer type "
                   << word << " will be convert to float value"
                   << DEFAULT_COLOR << std::endl;
-        return toReal(word, number);
     }
+    return true;
 }
 
 //------------------------------------------------------------------------------
@@ -143,10 +711,18 @@ Result Interpreter::interpret()
     auto startTime = Clock::now();
     try
     {
+        // Finish the definition suspended by the previous slice (see run())
+        if (m_resume)
+        {
+            m_resume = false;
+            execute(m_dictionary[IP], true);
+        }
+
         while (STREAM.split() || (m_interactive && (m_state == State::Compile)))
         {
-            std::string word = STREAM.word();
-            std::string upper_word = toUpper(STREAM.word());
+            // Note: no copy, the word refers to the stream buffer. It stays
+            // valid until the next STREAM.split().
+            std::string_view const word = STREAM.word();
 
             if (m_options.traces)
             {
@@ -158,18 +734,11 @@ Result Interpreter::interpret()
 
             if (m_state == State::Interprete)
             {
-                if (m_dictionary.findWord(upper_word, xt, immediate))
+                if (m_dictionary.findWord(word, xt, immediate))
                 {
-                    if (!m_options.traces)
-                    {
-                        executeToken(xt);
-                    }
-                    else
-                    {
-                        verboseExecuteToken(xt);
-                    }
+                    execute(xt);
                 }
-                else if (toNumber(word, number))
+                else if (STREAM.number(m_base, number) || toNumber(word, number))
                 {
                     if (m_options.traces)
                     {
@@ -178,31 +747,29 @@ Result Interpreter::interpret()
                                   << ((number.isInteger()) ? "integer " : "float ")
                                   << number << "\n";
                     }
+                    if (DS.depth() >= DS.capacity())
+                    {
+                        THROW(DS.name() + "-Stack overflow caused by word "
+                              + std::string(word));
+                    }
                     DPUSH(number);
                 }
                 else
                 {
-                    std::string msg("Unknown word " + escapeString(word));
+                    std::string msg("Unknown word " + escapeString(std::string(word)));
                     THROW(msg);
                 }
             }
             else
             {
                 assert(m_state == State::Compile);
-                if (m_dictionary.findWord(upper_word, xt, immediate))
+                if (m_dictionary.findWord(word, xt, immediate))
                 {
                     if (immediate)
                     {
                         if (m_options.traces)
                             std::cout << "Execute immediate word " << word << "\n";
-                        if (!m_options.traces)
-                        {
-                            executeToken(xt);
-                        }
-                        else
-                        {
-                            verboseExecuteToken(xt);
-                        }
+                        execute(xt);
                     }
                     else
                     {
@@ -211,7 +778,7 @@ Result Interpreter::interpret()
                         m_dictionary.append(xt);
                     }
                 }
-                else if (toNumber(word, number))
+                else if (STREAM.number(m_base, number) || toNumber(word, number))
                 {
                     if (m_options.traces)
                     {
@@ -223,10 +790,12 @@ Result Interpreter::interpret()
                 }
                 else
                 {
-                    std::string msg("Unknown word " + escapeString(word));
+                    std::string msg("Unknown word " + escapeString(std::string(word)));
                     THROW(msg);
                 }
             }
+
+            tick();
         }
 
         // End of the stream. Check for errors
@@ -243,6 +812,18 @@ Result Interpreter::interpret()
         }
         return { false, STREAM.error() };
     }
+    catch (Suspension const&)
+    {
+        return { Status::Running, "" };
+    }
+    catch (BudgetExhausted const& e)
+    {
+        return { Status::OutOfBudget, e.message() };
+    }
+    catch (DeadlineExceeded const& e)
+    {
+        return { Status::Timeout, e.message() };
+    }
     catch (Exception const& e)
     {
         if (e.message() == "bye") // TODO dirty
@@ -260,8 +841,15 @@ Result Interpreter::interpret()
 //--------------------------------------------------------------------------------
 bool Interpreter::interpretFile(char const* filepath)
 {
+    if (!idle())
+        return false;
+
     std::string fullpath = m_path.expand(filepath);
-    SS.push(std::make_unique<FileStream>(fullpath.c_str(), m_base));
+    if (m_options.pipeline)
+        pushStream<PipelinedFileStream>(fullpath.c_str());
+    else
+        pushStream<MappedFileStream>(fullpath.c_str());
+    armWatchdog();
     bool ret = ok(interpret());
     popStream();
     return ret;
@@ -270,12 +858,236 @@ bool Interpreter::interpretFile(char const* filepath)
 //--------------------------------------------------------------------------------
 bool Interpreter::interpretString(char const* script)
 {
-    SS.push(std::make_unique<StringStream>(script, m_base));
+    if ((script == nullptr) || !idle())
+        return false;
+
+    // The script is not copied: it is alive during the whole interpretation.
+    pushStream<StringStream>(std::string_view(script), StringStream::Mode::Borrow);
+    armWatchdog();
     bool ret = ok(interpret());
     popStream();
     return ret;
 }
 
+//--------------------------------------------------------------------------------
+bool Interpreter::start(char const* script)
+{
+    if ((script == nullptr) || (m_status == Status::Running))
+        return false;
+
+    // The caller may release the script before the last slice.
+    pushStream<StringStream>(std::string_view(script), StringStream::Mode::Copy);
+    armWatchdog();
+    m_time_left = std::chrono::milliseconds(m_options.timeout);
+    m_ticks = m_slice = INT64_MAX;
+    m_slice_depth = SS.depth();
+    m_resume = false;
+    m_status = Status::Running;
+    return true;
+}
+
+//--------------------------------------------------------------------------------
+Status Interpreter::run(size_t const steps)
+{
+    if (m_status != Status::Running)
+        return m_status;
+
+    m_steps = steps;
+    if (m_deadline != TimePoint::max())
+        m_deadline = Clock::now() + m_time_left;
+    m_ticks = m_slice = watchdogSlice(m_budget, m_steps, m_deadline);
+
+    Result result = interpret();
+    m_steps = 0u;
+    m_ticks = m_slice = INT64_MAX;
+    if (result.status != Status::Running)
+    {
+        ok(result);
+        popStream();
+    }
+    return m_status;
+}
+
+//--------------------------------------------------------------------------------
+void Interpreter::call(Token const xt)
+{
+    if (m_status == Status::Running)
+    {
+        THROW("The script given to start() is not finished");
+    }
+
+    armWatchdog();
+    try
+    {
+        execute(xt);
+    }
+    catch (BudgetExhausted const&)
+    {
+        m_status = Status::OutOfBudget;
+        abort();
+        throw;
+    }
+    catch (DeadlineExceeded const&)
+    {
+        m_status = Status::Timeout;
+        abort();
+        throw;
+    }
+    catch (...)
+    {
+        m_status = Status::Failure;
+        abort();
+        throw;
+    }
+    m_status = Status::Success;
+}
+
+//--------------------------------------------------------------------------------
+void Interpreter::fail()
+{
+    m_status = Status::Failure;
+    abort();
+}
+
+//--------------------------------------------------------------------------------
+bool Interpreter::reenter(Token const xt, Cell const* inputs, int32_t const nbInputs,
+                          Cell* outputs, int32_t const nbOutputs) noexcept
+{
+    // A previous call has failed: the C function shall return quickly
+    if (m_reentry_error)
+        return false;
+
+    Token const ip = IP;
+    int32_t const frame = RS.depth();
+    int32_t const streams = SS.depth();
+    Interpreter* const previous_forth = t_forth;
+
+    ++m_reentries;
+    try
+    {
+        if (DS.depth() + std::max(nbInputs, nbOutputs) > DS.capacity())
+        {
+            THROW(DS.name() + "-Stack overflow caused by the callback "
+                  + m_dictionary.token2name(xt));
+        }
+        for (int32_t i = 0; i < nbInputs; ++i)
+            DS.push(inputs[i]);
+        int32_t const depth = DS.depth() - nbInputs + nbOutputs;
+
+        t_forth = this;
+        executeToken(xt, false, frame);
+        t_forth = previous_forth;
+
+        if (DS.depth() != depth)
+        {
+            THROW(m_dictionary.token2name(xt) + " does not respect the signature of its callback");
+        }
+        for (int32_t i = nbOutputs - 1; i >= 0; --i)
+            outputs[i] = DS.pop();
+    }
+    catch (...)
+    {
+        t_forth = previous_forth;
+        m_reentry_error = std::current_exception();
+        RS.top() = RS.bottom() + frame;
+    }
+    --m_reentries;
+
+    IP = ip;
+    while (SS.depth() > streams)
+        popStream();
+    return !m_reentry_error;
+}
+
+//--------------------------------------------------------------------------------
+Token Interpreter::registerPrimitive(std::string const& name, Native const& native,
+                                     std::shared_ptr<void> context)
+{
+    Natives& natives = *m_natives;
+    size_t const count = natives.count.load();
+
+    if (name.empty() || (name.size() > 31u))
+    {
+        THROW("Invalid name for a primitive '" + name + "'");
+    }
+    if (count >= size::natives)
+    {
+        THROW("Too many registered primitives");
+    }
+    // Else the token could be the one of a secondary word
+    if (m_dictionary.here() <= countPrimitives() + size::natives)
+    {
+        THROW("Primitives shall be created before registering " + name);
+    }
+
+    Token const xt = Token(countPrimitives() + count);
+    natives.table[count] = native;
+    natives.contexts.push_back(std::move(context));
+    natives.count.store(count + 1u);
+
+    m_dictionary.createEntry(xt, name.c_str(), false, true);
+    m_dictionary.setCountPrimitives(Token(xt + 1u));
+    return xt;
+}
+
+//--------------------------------------------------------------------------------
+Token Interpreter::compile(std::string const& script)
+{
+    if (m_status == Status::Running)
+    {
+        THROW("The script given to start() is not finished");
+    }
+
+    // The new line ends a possible comment \ at the end of the script
+    std::string const code(":NONAME " + script + "\n;");
+    int32_t const depth = DS.depth();
+
+    // Immediate words may modify the stacks of the host: they are restored
+    // if the script does not compile, like the dictionary.
+    std::vector<Cell> const ds(DS.bottom(), DS.top());
+    std::vector<Cell> const as(AS.bottom(), AS.top());
+    int32_t const frame = RS.depth();
+    int32_t const streams = SS.depth();
+    Token const here = m_dictionary.here();
+    Token const last = m_dictionary.last();
+
+    pushStream<StringStream>(std::string_view(code), StringStream::Mode::Borrow);
+    armWatchdog();
+    Result result = interpret();
+    if (result.res && (DS.depth() != depth + 1))
+    {
+        result = { false, "The script shall be compiled as a single definition" };
+    }
+    m_status = result.status;
+    if (!result.res)
+    {
+        m_state = State::Interprete;
+        m_dictionary.rewind(here, last);
+        while (SS.depth() > streams)
+            popStream();
+        DS.reset();
+        DS.push(ds.data(), ds.size());
+        AS.reset();
+        AS.push(as.data(), as.size());
+        RS.top() = RS.bottom() + frame;
+        THROW("Failed compiling the script: " + result.msg);
+    }
+
+    popStream();
+    return Token(DPOPI());
+}
+
+//--------------------------------------------------------------------------------
+bool Interpreter::idle()
+{
+    if (m_status != Status::Running)
+        return true;
+
+    std::cerr << FORTH_ERROR_COLOR << "[ERROR] The script given to start() "
+              << "is not finished" << DEFAULT_COLOR << std::endl;
+    return false;
+}
+
 //--------------------------------------------------------------------------------
 bool Interpreter::interactive()
 {
@@ -285,31 +1097,123 @@ bool Interpreter::interactive()
     SS.push(std::make_unique<InteractiveStream>(m_dictionary, m_base));
     while (m_interactive)
     {
+        armWatchdog();
         ret = ret & ok(interpret());
     }
     return ret;
 }
 
 //------------------------------------------------------------------------------
-void Interpreter::executeToken(Token xt)
+bool Interpreter::hitGuardPage(void const* address)
 {
-    IP = 65535u;
+    int side;
+
+    if ((side = DS.guarded(address)) != 0)
+        m_fault_stack = &DS.name();
+    else if ((side = AS.guarded(address)) != 0)
+        m_fault_stack = &AS.name();
+    else if ((side = RS.guarded(address)) != 0)
+        m_fault_stack = &RS.name();
+    else
+        return false;
+
+    // Let the faulting instruction be replayed: the exception is thrown by
+    // executeToken() once the current word has returned.
+    DS.guard(false);
+    AS.guard(false);
+    RS.guard(false);
+    m_fault_side = side;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::throwGuardFault(Token const xt)
+{
+    DS.guard(true);
+    AS.guard(true);
+    RS.guard(true);
+    int const side = m_fault_side;
+    m_fault_side = 0;
+    THROW(*m_fault_stack + ((side < 0)
+                            ? "-Stack underflow caused by word "
+                            : "-Stack overflow caused by word ")
+          + m_dictionary.token2name(xt));
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::execute(Token const xt, bool const resume)
+{
+    Interpreter* const previous_forth = t_forth;
+
+    t_forth = this;
+    try
+    {
+        if (!m_options.traces || resume)
+        {
+            executeToken(xt, resume);
+        }
+        else
+        {
+            verboseExecuteToken(xt);
+        }
+
+        // Execution only ends in the operator, unless a task has dropped the
+        // return address ending it (see EXIT).
+        if (m_task != 0u)
+        {
+            THROW("Task " + std::to_string(m_task) + " corrupted its "
+                  + RS.name() + "-Stack");
+        }
+    }
+    catch (Suspension const&)
+    {
+        t_forth = previous_forth;
+        m_resume = true;
+        throw;
+    }
+    catch (...)
+    {
+        t_forth = previous_forth;
+        throw;
+    }
+    t_forth = previous_forth;
+
+    // The word ROLLBACK cannot restore the memory holding the code being
+    // executed: it is delayed until the outermost word returns.
+    if ((m_rollback >= 0) && (previous_forth != this))
+    {
+        size_t const id = size_t(m_rollback);
+        m_rollback = -1;
+        rollback(id);
+    }
+}
+
+//------------------------------------------------------------------------------
+void Interpreter::executeToken(Token xt, bool const resume, int32_t const frame)
+{
+    if (!resume)
+        IP = 65535u;
 
     do
     {
         while (!isPrimitive(xt))
         {
             RS.push(IP);
-            CHECK_OVERFLOW(RS, xt);
+            if (m_fault_side != 0)
+                throwGuardFault(xt);
             IP = xt;
             xt = m_dictionary[++IP];
             if (IP >= m_dictionary.here())
             {
                 THROW("Tried to execute a token outside the last definition");
             }
+            // Once inside the definition: a slice can be resumed at IP
+            tick();
         }
 
         executePrimitive(xt);
+        if (m_fault_side != 0)
+            throwGuardFault(xt);
 
         if (IP != 65535U)
         {
@@ -320,7 +1224,7 @@ void Interpreter::executeToken(Token xt)
             }
         }
     }
-    while (RS.depth() > 0);
+    while (RS.depth() > frame);
 }
 
 //------------------------------------------------------------------------------
@@ -435,14 +1339,16 @@ void Interpreter::verboseExecuteToken(Token xt)
             } // m_interactive
 
             ++m_level;
+            tick();
             RS.push(IP);
+            if (m_fault_side != 0)
+                throwGuardFault(xt);
             if (key_pressed != KEY_SKIP)
             {
                 indent(); std::cout << "Push IP=" << DISP_TOKEN(IP) << " in "
                                     << RS.name() << "-Stack:\n";
                 indent(); RS.display(std::cout, 16); std::cout << "\n";
             }
-            CHECK_OVERFLOW(RS, xt);
 
             IP = xt;
             xt = m_dictionary[++IP];
@@ -495,6 +1401,8 @@ void Interpreter::verboseExecuteToken(Token xt)
         }
 
         executePrimitive(xt);
+        if (m_fault_side != 0)
+            throwGuardFault(xt);
 
         if (xt != Primitives::EXIT)
         {
@@ -573,7 +1481,7 @@ void Interpreter::verboseExecuteToken(Token xt)
 //------------------------------------------------------------------------------
 bool Interpreter::isPrimitive(Token const xt) const
 {
-    return xt < countPrimitives();
+    return xt < countPrimitives() + m_natives->count.load(std::memory_order_relaxed);
 }
 
 //------------------------------------------------------------------------------
@@ -628,6 +1536,10 @@ void Interpreter::included() // TODO: to be cleaned
         popStream();
 
         // Call exception that will be caught by the interpret()
+        if (result.status == Status::OutOfBudget)
+            throw BudgetExhausted(msg);
+        if (result.status == Status::Timeout)
+            throw DeadlineExceeded(msg);
         THROW(msg);
     }
 }
@@ -25,9 +25,15 @@
 #  include "SimForth/Stack.hpp"
 #  include "Primitives.hpp" // FIXME should be in the Interpreter.cpp but we need
                             // some symbols when using Forth inheritance
+#  include "CopyOnWrite.hpp"
 #  include "Dictionary.hpp"
+#  include "Heap.hpp"
+#  include "StringHeap.hpp"
+#  include "TaskPool.hpp"
 #  include "Utils.hpp"
 #  include "LibC.hpp"
+#  include <csignal>
+#  include <exception>
 
 namespace forth
 {
@@ -40,8 +46,8 @@ class AuxiliaryStack: public Stack<Cell>
 {
 public:
 
-    AuxiliaryStack()
-        : Stack<Cell>("Auxiliary")
+    AuxiliaryStack(size_t const depth = size::stack)
+        : Stack<Cell>("Auxiliary", depth)
     {}
 };
 
@@ -53,8 +59,8 @@ class ReturnStack: public Stack<Token>
 {
 public:
 
-    ReturnStack()
-        : Stack<Token>("Return")
+    ReturnStack(size_t const depth = size::stack)
+        : Stack<Token>("Return", depth)
     {}
 };
 
@@ -67,11 +73,58 @@ class StreamStack: public Stack<StreamPtr>
 {
 public:
 
-    StreamStack()
-        : Stack<StreamPtr>("Streams")
+    StreamStack(size_t const depth = size::stack)
+        : Stack<StreamPtr>("Streams", depth)
     {}
 };
 
+//******************************************************************************
+//! \brief Context of a cooperative task (words NEW-TASK, ACTIVATE, PAUSE,
+//! STOP, WAKE). All tasks of an interpreter run in its thread. The running task
+//! owns the interpreter stacks: switching tasks exchanges stack segments and
+//! the instruction pointer (see Interpreter::switchTask()).
+//******************************************************************************
+struct TaskContext
+{
+    enum Status { Idle, Awake, Stopped };
+
+    TaskContext(size_t const ds, size_t const as, size_t const rs)
+        : DS(ds), AS(as), RS(rs)
+    {}
+
+    //! \brief Stacks of the task while it is not running.
+    DataStack      DS;
+    AuxiliaryStack AS;
+    ReturnStack    RS;
+    //! \brief Instruction pointer of the task while it is not running.
+    Token          IP = 65535u;
+    //! \brief Idle: never activated or finished, Stopped: waiting for WAKE.
+    Status         status = Idle;
+    //! \brief Neighbours in the ring of awake tasks.
+    size_t         next = 0u;
+    size_t         prev = 0u;
+};
+
+//******************************************************************************
+//! \brief How the last execution of a script has ended.
+//******************************************************************************
+enum class Status
+{
+    //! \brief The script has been executed until its end.
+    Success,
+    //! \brief The script has been aborted by an error.
+    Failure,
+    //! \brief The script has been aborted after having consumed its
+    //! instruction budget (Options::budget).
+    OutOfBudget,
+    //! \brief The script has been aborted after its deadline
+    //! (Options::timeout).
+    Timeout,
+    //! \brief The script given to Interpreter::start() is not finished: call
+    //! Interpreter::run() again.
+    Running
+};
+
 //******************************************************************************
 //! \brief Structure holding the result of the Forth interpreter.
 //******************************************************************************
@@ -91,16 +144,64 @@ struct Result
     //! \param[in] message Optional message. Should be set if result is true.
     //--------------------------------------------------------------------------
     Result(bool result, std::string message)
-        : res(result), msg(message)
+        : res(result), status(result ? Status::Success : Status::Failure),
+          msg(message)
+    {}
+
+    //--------------------------------------------------------------------------
+    //! \brief Constructor for failures having a specific status.
+    //--------------------------------------------------------------------------
+    Result(Status s, std::string message)
+        : res(s == Status::Success), status(s), msg(message)
     {}
 
     //! \brief true for success, false for failure.
     bool res = true;
+    //! \brief Detail of res.
+    Status status = Status::Success;
     //! \brief Optional message: error message if res == false or "ok" message
     //! (or any message) if res == true.
     std::string msg;
 };
 
+namespace size
+{
+//! \brief Maximal number of C++ and C functions registered as primitives.
+//! Their tokens follow the ones of primitives: they have to stay below the
+//! execution tokens of secondary words. SimForth::boot() reserves this range
+//! of the dictionary before the first secondary word.
+constexpr size_t natives = 1024u;
+}
+
+//******************************************************************************
+//! \brief C++ function registered as a Forth primitive (see
+//! Interpreter::registerPrimitive()). The function takes its parameters from
+//! the data stack and pushes its results on it. The context (i.e. a lambda)
+//! is given back to the function.
+//******************************************************************************
+struct Native
+{
+    void (*function)(void* context, DataStack& stack);
+    void* context;
+    //! \brief Declared stack effect ( inputs -- outputs ).
+    int32_t inputs;
+    int32_t outputs;
+};
+
+//******************************************************************************
+//! \brief Flat table of registered C++ functions, indexed by their token
+//! minus the number of primitives. Shared with the interpreters of worker
+//! threads. Entries never move: registering a function does not disturb
+//! threads executing the others.
+//******************************************************************************
+struct Natives
+{
+    Native table[size::natives];
+    std::atomic<size_t> count{0u};
+    //! \brief Keep alive the contexts of the table.
+    std::vector<std::shared_ptr<void>> contexts;
+};
+
 //****************************************************************************
 //! \brief Forth interpreter. Compile Forth scripts into byte code (stored in
 //! the dictionnary) and interprete byte code.
@@ -129,6 +230,32 @@ public:
     //--------------------------------------------------------------------------
     void abort();
 
+    //--------------------------------------------------------------------------
+    //! \brief Save the state of the interpreter: dictionary, data and
+    //! auxiliary stacks, base, heap, interned strings and C functions. Nothing
+    //! is copied: the memory is write-protected and pages are saved on their
+    //! first modification (see CopyOnWrite).
+    //! \return the identifier of the checkpoint to give to rollback().
+    //! \throw forth::Exception if the checkpoint cannot be created.
+    //--------------------------------------------------------------------------
+    size_t checkpoint();
+
+    //--------------------------------------------------------------------------
+    //! \brief Restore the state saved by checkpoint(). The cost is
+    //! proportional to the number of memory pages modified since. Newer
+    //! checkpoints are discarded, this one is kept and can be rolled back
+    //! again. The return stack is emptied.
+    //! \return false if the checkpoint does not exist.
+    //--------------------------------------------------------------------------
+    bool rollback(size_t const id);
+
+    //--------------------------------------------------------------------------
+    //! \brief Set the number of threads running tasks spawned by the word
+    //! SPAWN (0 for the number of cores). The current pool is stopped: tasks
+    //! not yet awaited are lost.
+    //--------------------------------------------------------------------------
+    void setWorkers(size_t const count);
+
     Options& getOptions() { return m_options; }
 
     //--------------------------------------------------------------------------
@@ -145,12 +272,108 @@ public:
     //--------------------------------------------------------------------------
     bool interpretString(char const* script);
 
+    //--------------------------------------------------------------------------
+    //! \brief Open a Forth script to be executed by slices with run(). The
+    //! script is copied. Options::budget and Options::timeout bound the whole
+    //! script, only the time spent inside run() is counted.
+    //! \return false if the previous script is still running.
+    //--------------------------------------------------------------------------
+    bool start(char const* script);
+
+    //--------------------------------------------------------------------------
+    //! \brief Execute the script given to start() until its end or until the
+    //! given number of steps (calls of secondary words, backward branches,
+    //! words interpreted) has been made. Stacks, IP and input streams are kept
+    //! between slices. No thread is created.
+    //! \param[in] steps the size of the slice, 0 for running until the end.
+    //! \note Included files are executed entirely inside the slice where they
+    //! are included.
+    //! \return Status::Running if the script is not finished.
+    //--------------------------------------------------------------------------
+    Status run(size_t const steps);
+
+    //--------------------------------------------------------------------------
+    //! \brief Execute a word directly, without parsing any script. Its
+    //! parameters shall have been pushed on the data stack. Options::budget
+    //! and Options::timeout bound the call.
+    //! \throw forth::Exception if the execution has failed. The interpreter
+    //! is then aborted (stacks are reset) and status() tells why.
+    //--------------------------------------------------------------------------
+    void call(Token const xt);
+
+    //--------------------------------------------------------------------------
+    //! \brief Abort the interpreter (stacks are reset) and set status() to
+    //! Status::Failure. Used by callers of call() detecting an error which
+    //! is not a Forth one (see Binding).
+    //--------------------------------------------------------------------------
+    void fail();
+
+    //--------------------------------------------------------------------------
+    //! \brief Execute a word from C code called by a word (see C-CALLBACK).
+    //! The inputs are pushed on the data stack and the word runs in a nested
+    //! frame of the return stack: IP, the return stack and the input streams
+    //! of the interrupted word are restored afterwards. The word shall leave
+    //! nbOutputs cells, which are popped.
+    //!
+    //! Exceptions cannot cross C code: the first one is kept, next calls
+    //! return at once, and it is thrown again when the C function returns to
+    //! the interpreter (see executeNative()).
+    //! \return false if the word has failed.
+    //--------------------------------------------------------------------------
+    bool reenter(Token const xt, Cell const* inputs, int32_t const nbInputs,
+                 Cell* outputs, int32_t const nbOutputs) noexcept;
+
+    //--------------------------------------------------------------------------
+    //! \brief Called by a thunk of C-CALLBACK running on another thread than
+    //! the one which has created it: the word is not executed and an error
+    //! is thrown when the C function returns to the interpreter. Thread-safe.
+    //--------------------------------------------------------------------------
+    inline void refuseCallback() noexcept
+    {
+        m_foreign_callbacks.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Register a C++ function as a Forth primitive: the word gets the
+    //! next free primitive token and the inner interpreter calls the function
+    //! directly. The depth of the data stack is checked against the declared
+    //! stack effect before and after the call.
+    //! \param[in] name the name of the Forth word.
+    //! \param[in] native the function, its context and its stack effect.
+    //! \param[in] context kept alive while the interpreter exists.
+    //! \return the execution token of the word.
+    //! \throw forth::Exception if the name is invalid, if too many functions
+    //! are registered or if the dictionary has no primitives yet.
+    //--------------------------------------------------------------------------
+    Token registerPrimitive(std::string const& name, Native const& native,
+                            std::shared_ptr<void> context);
+
+    //--------------------------------------------------------------------------
+    //! \brief Compile a script into an anonymous definition (like :NONAME)
+    //! without executing it. The script shall only use words allowed inside
+    //! a definition.
+    //! \return the execution token of the definition, to be given to call().
+    //! \throw forth::Exception if the script does not compile. The
+    //! dictionary and the stacks are then restored and status() is
+    //! Status::Failure.
+    //--------------------------------------------------------------------------
+    Token compile(std::string const& script);
+
     //--------------------------------------------------------------------------
     //! \brief Execute a Forth inside an interactive prompt.
     //! \return true on success, else return false.
     //--------------------------------------------------------------------------
     bool interactive();
 
+    //--------------------------------------------------------------------------
+    //! \brief Return how the last call to interpretString(), interpretFile()
+    //! or run() has ended.
+    //--------------------------------------------------------------------------
+    inline Status status() const
+    {
+        return m_status;
+    }
+
     //--------------------------------------------------------------------------
     //! \brief Return the reference of the parameter stack.
     //--------------------------------------------------------------------------
@@ -222,11 +445,25 @@ public:
     //! returns false.
     //! \return true if the string was a number else return false.
     //--------------------------------------------------------------------------
-    bool toNumber(std::string const& word, Cell& number);
+    bool toNumber(std::string_view const& word, Cell& number);
 
     inline Dictionary& dictionary() { return m_dictionary; }
     inline StreamStack& streams() { return SS; }
 
+    //--------------------------------------------------------------------------
+    //! \brief Return the memory of count cells placed at the given address
+    //! either inside the dictionary or inside the heap. Cells are stored
+    //! untagged (like the words ! and F!).
+    //! \throw forth::Exception if the range is not valid.
+    //--------------------------------------------------------------------------
+    Token* cells(Int const address, Int const count);
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the interpreter executing Forth words on the current
+    //! thread, or nullptr outside execute() and reenter().
+    //--------------------------------------------------------------------------
+    static Interpreter* current() noexcept;
+
     //--------------------------------------------------------------------------
     //! \brief Return the number of Forth primitives
     //--------------------------------------------------------------------------
@@ -234,6 +471,112 @@ public:
 
 protected:
 
+    //--------------------------------------------------------------------------
+    //! \brief Return the pool running tasks (words SPAWN, AWAIT). The pool is
+    //! created at the first call.
+    //--------------------------------------------------------------------------
+    TaskPool& tasks();
+
+    //--------------------------------------------------------------------------
+    //! \brief Create a cooperative task having its own stacks (word NEW-TASK).
+    //! \return the handle of the task.
+    //--------------------------------------------------------------------------
+    Int createTask();
+
+    //--------------------------------------------------------------------------
+    //! \brief Start the task with empty stacks at the current IP (word
+    //! ACTIVATE): it will execute the rest of the current definition.
+    //! \throw forth::Exception if the handle is not valid.
+    //--------------------------------------------------------------------------
+    void activateTask(Int const task);
+
+    //--------------------------------------------------------------------------
+    //! \brief Give the hand to the next awake task (word PAUSE).
+    //--------------------------------------------------------------------------
+    void pauseTask();
+
+    //--------------------------------------------------------------------------
+    //! \brief Put the running task asleep until WAKE (word STOP).
+    //! \throw forth::Exception if the running task is the operator.
+    //--------------------------------------------------------------------------
+    void stopTask();
+
+    //--------------------------------------------------------------------------
+    //! \brief Put a stopped task back in the round-robin (word WAKE).
+    //! \throw forth::Exception if the handle is not valid.
+    //--------------------------------------------------------------------------
+    void wakeTask(Int const task);
+
+    //--------------------------------------------------------------------------
+    //! \brief The running task has returned from its definition: make it
+    //! idle and give the hand to the next awake task.
+    //--------------------------------------------------------------------------
+    void endTask();
+
+    //--------------------------------------------------------------------------
+    //! \brief Called by the primitive xt when it cannot progress without
+    //! blocking the thread (i.e. RECV on an empty channel). Return true if
+    //! xt has been compiled in a definition and other cooperative tasks are
+    //! awake: the primitive can then call retryLater() instead of blocking.
+    //--------------------------------------------------------------------------
+    bool canRetryLater(Token const xt) const;
+
+    //--------------------------------------------------------------------------
+    //! \brief Called by the primitive word before blocking the thread when
+    //! canRetryLater() returned false (i.e. RECV interpreted from the
+    //! stream). Awake cooperative tasks cannot run while the thread sleeps:
+    //! if they are the ones expected to send or receive, it would sleep for
+    //! ever.
+    //! \throw Exception if other cooperative tasks are awake.
+    //--------------------------------------------------------------------------
+    void checkDeadlock(std::string const& word) const;
+
+    //--------------------------------------------------------------------------
+    //! \brief Give the hand to the next cooperative task. The primitive being
+    //! executed is executed again when the running task resumes: its
+    //! parameters shall have been left on the data stack.
+    //--------------------------------------------------------------------------
+    void retryLater();
+
+    //--------------------------------------------------------------------------
+    //! \brief Park the stacks and IP of the running task and restore the
+    //! ones of the given task.
+    //--------------------------------------------------------------------------
+    void switchTask(size_t const task);
+
+    //--------------------------------------------------------------------------
+    //! \brief Give the hand back to the operator and make all tasks idle.
+    //--------------------------------------------------------------------------
+    void resetTasks();
+
+    //--------------------------------------------------------------------------
+    //! \brief Start counting the instruction budget and the deadline of
+    //! m_options for a new call from the host.
+    //--------------------------------------------------------------------------
+    void armWatchdog();
+
+    //--------------------------------------------------------------------------
+    //! \brief Count a call or a backward branch. The watchdog is only called
+    //! every few hundreds of ticks and never when there is no limit.
+    //--------------------------------------------------------------------------
+    INLINE void tick()
+    {
+        if (--m_ticks <= 0)
+            watchdog();
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Check the limits armed by armWatchdog().
+    //! \throw BudgetExhausted or DeadlineExceeded.
+    //--------------------------------------------------------------------------
+    void watchdog();
+
+    //--------------------------------------------------------------------------
+    //! \brief Return false and display an error if the script given to
+    //! start() is not finished: it shall not be disturbed by other scripts.
+    //--------------------------------------------------------------------------
+    bool idle();
+
     //--------------------------------------------------------------------------
     //! \brief Display the result of interpret().
     //! \return forward the result of the interpreter (true: success, false: failure).
@@ -261,6 +604,13 @@ protected:
     //--------------------------------------------------------------------------
     virtual void executePrimitive(Token const xt);
 
+    //--------------------------------------------------------------------------
+    //! \brief Call the C++ function registered with the token xt.
+    //! \throw forth::Exception if xt is not a registered function or if the
+    //! function does not respect its stack effect.
+    //--------------------------------------------------------------------------
+    void executeNative(Token const xt);
+
     //--------------------------------------------------------------------------
     //! \brief Main algorithm executing the code of primitive or secondary word
     //! in verbose mode.
@@ -269,9 +619,88 @@ protected:
 
     //--------------------------------------------------------------------------
     //! \brief Entry point of the algorithm executing the code of primitive or
-    //! secondary word.
+    //! secondary word. The execution ends when the depth of the return stack
+    //! gets back to frame (see reenter()).
+    //--------------------------------------------------------------------------
+    void executeToken(Token const xt, bool const resume = false, int32_t const frame = 0);
+
+    //--------------------------------------------------------------------------
+    //! \brief Execute the token (in normal or verbose mode) while stack guard
+    //! pages are watched: a SIGSEGV inside a guard page of the data, auxiliary
+    //! or return stack is converted into a Forth exception "X-Stack
+    //! overflow/underflow caused by word Y" (see throwGuardFault()).
+    //! \param[in] resume if true, xt is the token at IP of a definition
+    //! suspended by run(): the return stack is kept.
+    //--------------------------------------------------------------------------
+    void execute(Token const xt, bool const resume = false);
+
+    //--------------------------------------------------------------------------
+    //! \brief Called by the SIGSEGV handler: check if the faulting address
+    //! belongs to a guard page of one of the stacks and memorize it. Guard
+    //! pages are opened so that the faulting instruction can be replayed.
+    //! \note Runs inside a signal handler: async-signal-safe code only.
     //--------------------------------------------------------------------------
-    void executeToken(Token const xt);
+    bool hitGuardPage(void const* address);
+
+    //--------------------------------------------------------------------------
+    //! \brief Called by executeToken() after the word xt has hit a guard page:
+    //! protect again guard pages and throw the stack overflow/underflow
+    //! exception naming xt.
+    //--------------------------------------------------------------------------
+    [[noreturn]] void throwGuardFault(Token const xt);
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the memory of nbTokens tokens placed at the given
+    //! address either inside the dictionary or inside the heap.
+    //! \throw forth::Exception if the heap range is not valid.
+    //--------------------------------------------------------------------------
+    Token* memory(Int const address, Int const nbTokens);
+
+    //--------------------------------------------------------------------------
+    //! \brief Read count cells placed at the given address: integers like
+    //! the word @ or, if reals is set, floats like the word FLOAT@.
+    //! \throw forth::Exception if the range is not valid.
+    //--------------------------------------------------------------------------
+    std::vector<Cell> fetchCells(Int const address, Int const count,
+                                 bool const reals);
+
+    //--------------------------------------------------------------------------
+    //! \brief Store cells at the given address (like the word !). If reals is
+    //! set, integers are converted and stored as floats.
+    //! \throw forth::Exception if the range is not valid.
+    //--------------------------------------------------------------------------
+    void storeCells(Int const address, std::vector<Cell> const& cells,
+                    bool const reals);
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the string ( addr u ) referred either by the handle of
+    //! an interned string or by the address of a count string stored in the
+    //! dictionary.
+    //! \throw forth::Exception if the handle is not valid.
+    //--------------------------------------------------------------------------
+    std::string_view string(Int const address, Int const length);
+
+    //--------------------------------------------------------------------------
+    //! \brief Same than string() but return the '\0' terminated string.
+    //--------------------------------------------------------------------------
+    char const* cstring(Int const address);
+
+    //--------------------------------------------------------------------------
+    //! \brief Push on the data stack the handle and the length of the interned
+    //! string s. Then release the interned strings no longer referred if
+    //! enough strings have been interned since the last collection.
+    //! \note Shall be the last action of a primitive: views on interned
+    //! strings held by the primitive are no longer valid after.
+    //--------------------------------------------------------------------------
+    void pushString(std::string_view const& s);
+
+    //--------------------------------------------------------------------------
+    //! \brief Release the interned strings whose handles are not found inside
+    //! the stacks of tasks, the dictionary, the heap or the channels. Strings
+    //! kept by checkpoints are never released. Handles held by the host or by
+    //! C functions are not seen: no collection while C code calls Forth.
+    //--------------------------------------------------------------------------
+    void collectStrings();
 
     void included();
 
@@ -280,23 +709,23 @@ protected:
     //! it ... push a stream, execute it ... then when EOF is reached pop it and
     //! continue to execute the previous stream.
     //--------------------------------------------------------------------------
-    template<class S>
-    void include(std::string const& script)
+    template<class S, typename... Args>
+    void include(Args&&... args)
     {
-        LOGI("include '%s'", script.c_str());
-        pushStream<S>(script);
+        pushStream<S>(std::forward<Args>(args)...);
         included();
     }
 
     //--------------------------------------------------------------------------
-    //! \brief Helper function for stacking a new stream.
+    //! \brief Helper function for stacking a new stream. Parameters are the
+    //! ones of the stream constructor (without the base).
     //--------------------------------------------------------------------------
-    template<class S>
-    void pushStream(std::string const& filepath)
+    template<class S, typename... Args>
+    void pushStream(Args&&... args)
     {
         // TODO assert max depth
-        LOGI("Push stream %d: %s", SS.depth() + 1, filepath.c_str());
-        SS.push(std::make_unique<S>(filepath.c_str(), m_base));
+        LOGI("Push stream %d", SS.depth() + 1);
+        SS.push(std::make_unique<S>(std::forward<Args>(args)..., m_base));
     }
 
     //--------------------------------------------------------------------------
@@ -351,6 +780,25 @@ protected:
         // TODO stream->cursor();
     };
 
+    //--------------------------------------------------------------------------
+    //! \brief States saved by checkpoint() which are not held by memory pages
+    //! watched by m_journal.
+    //--------------------------------------------------------------------------
+    struct Snapshot
+    {
+        int32_t ds;
+        int32_t as;
+        int base;
+        State state;
+        Token here;
+        Token last;
+        Heap::Mark heap;
+        size_t strings;
+        size_t clibs;
+        size_t natives;
+        size_t tasks;
+    };
+
     //! \brief Forth dictionary holding word entried and byte code (compiled
     //! words).
     Dictionary&    m_dictionary;
@@ -396,11 +844,71 @@ protected:
     // interfacing C functions (external libraries).
     // TODO manage multiple libraries
     CLib           m_clibs;
+    //! \brief C++ functions registered as primitives.
+    std::shared_ptr<Natives> m_natives;
     //! \brief Memorize states.
     Memo           m_memo;
+    //! \brief Dynamic memory (ALLOCATE, FREE, RESIZE) released on abort().
+    Heap           m_heap;
+    //! \brief Interned strings built at run time, released on abort() or
+    //! when no longer referred (see collectStrings()).
+    StringHeap     m_strings;
+    //! \brief Copy-on-write of pages modified since checkpoints. Declared
+    //! after the memories it watches: it is destroyed before them.
+    CopyOnWrite    m_journal;
+    //! \brief States saved by checkpoints.
+    std::vector<Snapshot> m_snapshots;
+    //! \brief Checkpoint to roll back to when the current word returns
+    //! (word ROLLBACK) or -1.
+    Int            m_rollback = -1;
+    //! \brief Worker threads created by this interpreter.
+    std::unique_ptr<TaskPool> m_pool;
+    //! \brief Pool receiving spawned tasks: m_pool or, for an interpreter of
+    //! a worker thread, the pool of the worker.
+    TaskPool*      m_tasks = nullptr;
+    //! \brief Cooperative tasks. Slot 0 is the operator: the task interpreting
+    //! the input stream. Created by the first word NEW-TASK.
+    std::vector<std::unique_ptr<TaskContext>> m_contexts;
+    //! \brief Slot of the running task. Its context holds the stacks parked
+    //! by the previous switch.
+    size_t         m_task = 0u;
+    //! \brief Ticks before the next call of watchdog().
+    int64_t        m_ticks = INT64_MAX;
+    //! \brief Ticks given at the last call of watchdog().
+    int64_t        m_slice = INT64_MAX;
+    //! \brief Remaining ticks of the instruction budget or 0 if unlimited.
+    size_t         m_budget = 0u;
+    //! \brief Remaining ticks of the slice given to run() or 0 if unlimited.
+    size_t         m_steps = 0u;
+    //! \brief Depth of the stream stack of the script given to start().
+    int32_t        m_slice_depth = 0;
+    //! \brief Time left before Options::timeout when a slice is over.
+    Clock::duration m_time_left;
+    //! \brief Has the last slice been suspended inside a definition ?
+    bool           m_resume = false;
+    //! \brief Number of words executed by reenter() in progress: they cannot
+    //! be suspended.
+    int32_t        m_reentries = 0;
+    //! \brief First exception thrown by a word called back by C code.
+    std::exception_ptr m_reentry_error;
+    //! \brief Number of callbacks refused because they were called from
+    //! another thread (see refuseCallback()).
+    std::atomic<uint32_t> m_foreign_callbacks{0u};
+    //! \brief Deadline of the call if Options::timeout is set.
+    TimePoint      m_deadline;
+    //! \brief How the last call from the host has ended.
+    Status         m_status = Status::Success;
     //! \brief Memorize the call stack depth when secondary word call secondary
     //! words. Used for displaying information.
     int            m_level = 0;
+    //! \brief Stack whose guard page has been hit (see hitGuardPage()).
+    std::string const* m_fault_stack = nullptr;
+    //! \brief -1 if the guard page hit was an underflow, +1 for overflow.
+    //! Set by the SIGSEGV handler, checked after each word.
+    volatile std::sig_atomic_t m_fault_side = 0;
+
+    friend struct StackGuard;
+    friend class TaskPool;
 
 public: // FIXME
 
@@ -19,11 +19,26 @@
 //==============================================================================
 
 #include "LibC.hpp"
+#include "Interpreter.hpp"
 #include "Exceptions.hpp"
 #include "Primitives.hpp"
 #include "MyLogger/Logger.hpp"
 #include "project_info.hpp"
 #include <dlfcn.h> // dlopen
+#include <dirent.h> // opendir
+#include <sys/stat.h> // mkdir
+#include <unistd.h> // unlink
+#include <utime.h>
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+#include <utility>
 
 namespace forth
 {
@@ -31,16 +46,810 @@ namespace forth
 // Initialize static member variable
 Token CFunHolder::next_handle = 0;
 
+//----------------------------------------------------------------------------
+//! \brief Folder holding the shared libraries already compiled. Libraries
+//! are loaded into the process: the folder belongs to the user
+//! ($XDG_CACHE_HOME/simforth/ or ~/.cache/simforth/).
+static std::string cachePath()
+{
+    char const* folder = getenv("XDG_CACHE_HOME");
+    if ((folder != nullptr) && (folder[0] == '/'))
+        return std::string(folder) + "/simforth/";
+
+    folder = getenv("HOME");
+    if ((folder != nullptr) && (folder[0] == '/'))
+        return std::string(folder) + "/.cache/simforth/";
+
+    return project::info::tmp_path + "cache-" + std::to_string(getuid()) + "/";
+}
+
+//----------------------------------------------------------------------------
+//! \brief Return true if the path (not followed if it is a symbolic link) is
+//! a folder or a regular file owned by the current user and not writable by
+//! the group or by others: nobody else can place a library there.
+static bool isTrusted(std::string const& path, bool const folder)
+{
+    struct stat st;
+    return (lstat(path.c_str(), &st) == 0) &&
+           (folder ? S_ISDIR(st.st_mode) : S_ISREG(st.st_mode)) &&
+           (st.st_uid == getuid()) && ((st.st_mode & (S_IWGRP | S_IWOTH)) == 0);
+}
+
+//----------------------------------------------------------------------------
+//! \brief Create the cache folder if needed, only accessible by the user.
+//! \return false if the cache folder cannot be trusted.
+static bool openCache()
+{
+    std::string const folder = cachePath();
+
+    // Parent folder (ie ~/.cache) then the cache itself
+    std::string const parent = folder.substr(0u, folder.rfind('/', folder.size() - 2u));
+    mkdir(parent.c_str(), 0700);
+    mkdir(folder.c_str(), 0700);
+    if (isTrusted(folder, true))
+        return true;
+
+    LOGW("C-Lib cache: '%s' is not a folder owned by the user and only "
+         "writable by it: cache disabled", folder.c_str());
+    return false;
+}
+
+//----------------------------------------------------------------------------
+//! \brief Paths and last access time of the shared libraries of the cache.
+static std::vector<std::pair<time_t, std::string>> cacheEntries()
+{
+    std::vector<std::pair<time_t, std::string>> entries;
+    std::string const folder = cachePath();
+
+    DIR* dir = opendir(folder.c_str());
+    if (dir == nullptr)
+        return entries;
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        std::string const path = folder + entry->d_name;
+        struct stat st;
+        if ((entry->d_name[0] != '.') && (stat(path.c_str(), &st) == 0) &&
+            S_ISREG(st.st_mode))
+        {
+            entries.emplace_back(st.st_mtime, path);
+        }
+    }
+    closedir(dir);
+    return entries;
+}
+
+//----------------------------------------------------------------------------
+//! \brief Remove the least recently used libraries of the cache for keeping
+//! at most size of them.
+static void evictCache(size_t const size)
+{
+    auto entries = cacheEntries();
+    if (entries.size() <= size)
+        return ;
+
+    std::sort(entries.begin(), entries.end());
+    for (size_t i = 0u; i < entries.size() - size; ++i)
+    {
+        LOGI("C-Lib cache: evict '%s'", entries[i].second.c_str());
+        unlink(entries[i].second.c_str());
+    }
+}
+
+//----------------------------------------------------------------------------
+//! \brief Append the content of a file to the string.
+static void appendFile(std::string& str, std::string const& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    str.append(std::istreambuf_iterator<char>(file),
+               std::istreambuf_iterator<char>());
+}
+
+//----------------------------------------------------------------------------
+size_t CLib::clearCache()
+{
+    size_t count = 0u;
+
+    for (auto const& it: cacheEntries())
+    {
+        if (unlink(it.second.c_str()) == 0)
+            ++count;
+    }
+    return count;
+}
+
+//----------------------------------------------------------------------------
+std::string CLib::hash(CLibOptions const& options) const
+{
+    // Everything changing the compiled library. Fields are separated by a
+    // null char.
+    std::string key;
+    appendFile(key, m_sourcePath);
+    key += '\0';
+    appendFile(key, m_path.expand("LibC/Makefile"));
+    key += '\0';
+    key += options.compiler + '\0' + m_extLibs + '\0' + m_pkgConfig + '\0';
+    for (char const* var: { "CC", "CFLAGS", "LDFLAGS" })
+    {
+        char const* value = getenv(var);
+        key += (value != nullptr) ? value : "";
+        key += '\0';
+    }
+
+    // FNV-1a
+    uint64_t h = UINT64_C(14695981039346656037);
+    for (char const c: key)
+    {
+        h ^= uint64_t(uint8_t(c));
+        h *= UINT64_C(1099511628211);
+    }
+
+    std::ostringstream ss;
+    ss << std::hex << h;
+    return ss.str();
+}
+
+//----------------------------------------------------------------------------
+//! \brief Bound the number of compilations running at the same time.
+namespace
+{
+    class Jobs
+    {
+    public:
+
+        Jobs()
+            : m_free(std::max(1u, std::thread::hardware_concurrency()))
+        {}
+
+        void acquire()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_released.wait(lock, [this] { return m_free > 0u; });
+            --m_free;
+        }
+
+        void release()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_free;
+            }
+            m_released.notify_one();
+        }
+
+    private:
+
+        std::mutex m_mutex;
+        std::condition_variable m_released;
+        size_t m_free;
+    };
+
+    Jobs& jobs()
+    {
+        static Jobs instance;
+        return instance;
+    }
+}
+
+//----------------------------------------------------------------------------
+//! \brief Job compiling a shared library with the given command, moving it
+//! into the cache (if cached is not empty) and loading it. Run by a thread
+//! created by CLib::end().
+//! \return the handle of the library or nullptr and the error.
+static std::pair<void*, std::string>
+build(std::string const command, std::string const built, std::string const cached,
+      std::string const errors, size_t const cache_size)
+{
+    jobs().acquire();
+    LOGI("C-Lib compilation: %s", command.c_str());
+    int const status = system(command.c_str());
+    jobs().release();
+
+    if (status != 0)
+    {
+        // If something wrong happened. Get the Makefile error message and store
+        // it in our logs.
+        std::string str;
+        appendFile(str, errors);
+        return { nullptr, "Failed compiling shared libray '" + built
+                 + "' Reason was:\n" + str };
+    }
+
+    std::string path = built;
+    if (!cached.empty())
+    {
+        if ((rename(built.c_str(), cached.c_str()) != 0) ||
+            (chmod(cached.c_str(), S_IRWXU) != 0) || !isTrusted(cached, false))
+        {
+            return { nullptr, "Failed storing '" + built + "' in the cache '"
+                     + cached + "'" };
+        }
+        evictCache(cache_size);
+        path = cached;
+    }
+
+    // Open the newly created shared library.
+    void* handle = dlopen(path.c_str(), RTLD_NOW);
+    if (handle == nullptr)
+    {
+        return { nullptr, "Failed loading shared libray. Reason was '"
+                 + std::string(dlerror()) + "'" };
+    }
+    return { handle, std::string() };
+}
+
+//----------------------------------------------------------------------------
+//! \brief Trampolines calling imported C functions (C-IMPORT) and thunks
+//! calling back Forth words (C-CALLBACK). Trampolines for up to MAX_ARITY
+//! parameters call the C function with its exact prototype. The generic
+//! trampoline and the thunks pass integers and addresses as int64_t and
+//! floats as double: they rely on the calling convention.
+#if (defined(__x86_64__) && !defined(_WIN32)) || defined(__aarch64__)
+//! \brief Integers and doubles are passed in their own registers and int is
+//! the lower half of an int64_t register.
+#  define REGISTER_CALLING_CONVENTION
+#endif
+
+namespace
+{
+    using Integer = int64_t;
+
+    //! \brief Convert a cell to the C type T of a parameter.
+    template<typename T>
+    inline T argument(Cell const& cell)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+            return T(cell.real());
+        else if constexpr (std::is_pointer_v<T>)
+            return reinterpret_cast<T>(static_cast<intptr_t>(cell.integer()));
+        else
+            return T(cell.integer());
+    }
+
+    //! \brief Convert the value returned by a C function to a cell.
+    template<typename T>
+    inline Cell result(T const r)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+            return Cell::real(Real(r));
+        else if constexpr (std::is_pointer_v<T>)
+            return Cell::integer(Int(reinterpret_cast<intptr_t>(r)));
+        else
+            return Cell::integer(Int(r));
+    }
+
+    //! \brief Call the C function R symbol(Args...). The context is the
+    //! symbol.
+    template<typename R, typename... Args>
+    struct Trampoline
+    {
+        static void call(void* symbol, DataStack& ds)
+        {
+            call(reinterpret_cast<R(*)(Args...)>(symbol), ds,
+                 std::index_sequence_for<Args...>{});
+        }
+
+        template<size_t... I>
+        static inline void call(R(*function)(Args...), DataStack& ds,
+                                std::index_sequence<I...>)
+        {
+            constexpr int32_t count = int32_t(sizeof...(Args));
+            Cell const* cells = ds.top() - count;
+            ds.top() -= count;
+            if constexpr (std::is_void_v<R>)
+                function(argument<Args>(cells[I])...);
+            else // Arguments are read before the result overwrites them
+                ds.push(result(function(argument<Args>(cells[I])...)));
+            (void) cells;
+        }
+    };
+
+    template<typename R>
+    struct Trampolines
+    {
+        template<typename... Args>
+        using type = Trampoline<R, Args...>;
+    };
+
+    //! \brief Kinds of parameters and results of C-IMPORT. Their position is
+    //! the index of their C type.
+    constexpr char const KINDS[] = "ilaf";
+
+    template<unsigned Kind> struct CType;
+    template<> struct CType<0u> { using type = int; };
+    template<> struct CType<1u> { using type = long; };
+    template<> struct CType<2u> { using type = void*; };
+    template<> struct CType<3u> { using type = double; };
+
+    //! \brief Instantiate T<Args...> for Arity parameters: the digit i in
+    //! base 4 of Kinds is the kind of the parameter i.
+    template<unsigned Arity, unsigned Kinds, typename... Args>
+    struct Exact
+    {
+        using Param = typename CType<(Kinds >> (2u * (Arity - 1u))) & 3u>::type;
+        template<template<typename...> class T>
+        using type = typename Exact<Arity - 1u, Kinds, Param, Args...>::template type<T>;
+    };
+
+    template<unsigned Kinds, typename... Args>
+    struct Exact<0u, Kinds, Args...>
+    {
+        template<template<typename...> class T>
+        using type = T<Args...>;
+    };
+
+    //! \brief Trampolines for up to MAX_ARITY parameters. Index of a
+    //! prototype: (4^arity - 1) / 3 + kinds.
+    constexpr unsigned MAX_ARITY = 4u;
+    constexpr size_t PROTOTYPES = ((size_t(1) << (2u * (MAX_ARITY + 1u))) - 1u) / 3u;
+
+    //! \brief Index of the first prototype of n parameters.
+    constexpr size_t prototypes(unsigned const n)
+    {
+        return ((size_t(1) << (2u * n)) - 1u) / 3u;
+    }
+
+    constexpr unsigned prototypeArity(size_t const index)
+    {
+        unsigned n = 0u;
+        while (prototypes(n + 1u) <= index)
+            ++n;
+        return n;
+    }
+
+    constexpr unsigned prototypeKinds(size_t const index)
+    {
+        return unsigned(index - prototypes(prototypeArity(index)));
+    }
+
+    //! \brief Return the index of the prototype or PROTOTYPES if there are
+    //! too many parameters.
+    size_t prototype(std::string const& params)
+    {
+        if (params.size() > MAX_ARITY)
+            return PROTOTYPES;
+
+        unsigned kinds = 0u;
+        for (size_t k = 0u; k < params.size(); ++k)
+        {
+            kinds |= unsigned(std::strchr(KINDS, params[k]) - KINDS) << (2u * k);
+        }
+        return prototypes(unsigned(params.size())) + kinds;
+    }
+
+    template<typename R, size_t... I>
+    constexpr std::array<forth_c_trampoline, sizeof...(I)>
+    trampolines(std::index_sequence<I...>)
+    {
+        return {{ &Exact<prototypeArity(I), prototypeKinds(I)>::template
+                  type<Trampolines<R>::template type>::call... }};
+    }
+
+    template<typename R>
+    forth_c_trampoline specialized(size_t const index)
+    {
+        static constexpr auto table = trampolines<R>(std::make_index_sequence<PROTOTYPES>{});
+        return table[index];
+    }
+
+#ifdef REGISTER_CALLING_CONVENTION
+    //! \brief Generic trampoline: integers and doubles are passed in their
+    //! own registers, whatever their order in the C prototype. Unused
+    //! registers are ignored by the C function. The context is the CImport.
+    constexpr size_t MAX_INTEGERS = 6u;
+    constexpr size_t MAX_DOUBLES = 8u;
+
+    template<typename R>
+    void generic(void* context, DataStack& ds)
+    {
+        using Function = R(*)(Integer, Integer, Integer, Integer, Integer, Integer,
+                              double, double, double, double, double, double,
+                              double, double);
+
+        CImport const& import = *static_cast<CImport const*>(context);
+        int32_t const count = int32_t(import.params.size());
+        Integer i[MAX_INTEGERS] = { 0 };
+        double f[MAX_DOUBLES] = { 0.0 };
+        size_t ni = 0u, nf = 0u;
+
+        Cell const* cells = ds.top() - count;
+        for (int32_t k = 0; k < count; ++k)
+        {
+            if (import.params[size_t(k)] == 'f')
+                f[nf++] = argument<double>(cells[k]);
+            else
+                i[ni++] = argument<Integer>(cells[k]);
+        }
+        ds.top() -= count;
+
+        Function function = reinterpret_cast<Function>(import.symbol);
+        if constexpr (std::is_void_v<R>)
+            function(i[0], i[1], i[2], i[3], i[4], i[5],
+                     f[0], f[1], f[2], f[3], f[4], f[5], f[6], f[7]);
+        else
+            ds.push(result(function(i[0], i[1], i[2], i[3], i[4], i[5],
+                                    f[0], f[1], f[2], f[3], f[4], f[5], f[6], f[7])));
+    }
+#endif
+
+    //! \brief Select the trampoline returning R.
+    template<typename R>
+    bool trampoline(CImport& import)
+    {
+        size_t const index = prototype(import.params);
+        if (index < PROTOTYPES)
+        {
+            import.trampoline = specialized<R>(index);
+            import.context = import.symbol;
+            return true;
+        }
+
+#ifdef REGISTER_CALLING_CONVENTION
+        size_t const arity = import.params.size();
+        size_t const doubles = size_t(std::count(import.params.begin(),
+                                                 import.params.end(), 'f'));
+        if ((doubles <= MAX_DOUBLES) && (arity - doubles <= MAX_INTEGERS))
+        {
+            import.trampoline = &generic<R>;
+            import.context = &import;
+            return true;
+        }
+#endif
+        return false;
+    }
+
+#ifdef REGISTER_CALLING_CONVENTION
+    //! \brief Instantiate T<Args...> for Arity parameters of thunks: the bit
+    //! i of Mask is set when the parameter i is a double, else an int64_t.
+    template<unsigned Arity, unsigned Mask, typename... Args>
+    struct Specialize
+    {
+        using Param = std::conditional_t<((Mask >> (Arity - 1u)) & 1u) != 0u,
+                                         double, Integer>;
+        template<template<typename...> class T>
+        using type = typename Specialize<Arity - 1u, Mask, Param, Args...>::template type<T>;
+    };
+
+    template<unsigned Mask, typename... Args>
+    struct Specialize<0u, Mask, Args...>
+    {
+        template<template<typename...> class T>
+        using type = T<Args...>;
+    };
+
+    //! \brief Thunks for up to MAX_ARITY parameters. Index of a signature:
+    //! 2^arity - 1 + mask.
+    constexpr size_t SIGNATURES = (size_t(1) << (MAX_ARITY + 1u)) - 1u;
+
+    constexpr unsigned arity(size_t const index)
+    {
+        unsigned n = 0u;
+        while ((size_t(2) << n) <= index + 1u)
+            ++n;
+        return n;
+    }
+
+    constexpr unsigned mask(size_t const index)
+    {
+        return unsigned(index + 1u - (size_t(1) << arity(index)));
+    }
+
+    //! \brief Return the index of the signature or SIGNATURES if there are
+    //! too many parameters.
+    size_t signature(std::string const& params)
+    {
+        if (params.size() > MAX_ARITY)
+            return SIGNATURES;
+
+        unsigned mask = 0u;
+        for (size_t k = 0u; k < params.size(); ++k)
+        {
+            if (params[k] == 'f')
+                mask |= 1u << k;
+        }
+        return (size_t(1) << params.size()) - 1u + mask;
+    }
+
+    //! \brief Forth word called back by C code through a thunk. C function
+    //! pointers have no context: each thunk is a distinct function reading
+    //! its own slot of s_callbacks.
+    struct Callback
+    {
+        //! \brief nullptr if the slot is free.
+        Interpreter* forth = nullptr;
+        //! \brief Thread of the interpreter: the only one allowed to call
+        //! the thunk.
+        std::thread::id owner;
+        Token xt = 0;
+        std::string params;
+        char result = 0;
+    };
+
+    //! \brief Number of callbacks for each signature and kind of result.
+    constexpr size_t CALLBACK_SLOTS = 8u;
+    //! \brief Slots of the process, indexed by callbackIndex(). Protected by
+    //! s_callbacks_mutex when they are taken or released.
+    Callback s_callbacks[2u * SIGNATURES * CALLBACK_SLOTS];
+    std::mutex s_callbacks_mutex;
+
+    //! \brief real: the thunk returns a double (else an integer, also used
+    //! for void and int since the caller ignores the upper bits).
+    constexpr size_t callbackIndex(bool const real, size_t const signature, size_t const slot)
+    {
+        return ((real ? SIGNATURES : 0u) + signature) * CALLBACK_SLOTS + slot;
+    }
+
+    inline Cell parameter(char const kind, Integer const value)
+    {
+        return Cell::integer(Int((kind == 'i') ? Integer(int32_t(value)) : value));
+    }
+
+    inline Cell parameter(char const, double const value)
+    {
+        return Cell::real(Real(value));
+    }
+
+    template<typename R, size_t Index>
+    struct Thunks
+    {
+        template<typename... Args>
+        struct type
+        {
+            //! \brief The C function given to C code.
+            static R call(Args... args)
+            {
+                Callback const& callback = s_callbacks[Index];
+                Cell inputs[sizeof...(Args) + 1u];
+                Cell output = Cell::integer(0);
+                size_t k = 0u;
+
+                ((inputs[k] = parameter(callback.params[k], args), ++k), ...);
+                if (callback.forth == nullptr)
+                {
+                    // Released slot: the word has been forgotten, return 0
+                }
+                else if (callback.owner == std::this_thread::get_id())
+                {
+                    callback.forth->reenter(callback.xt, inputs, int32_t(sizeof...(Args)),
+                                            &output, (callback.result == 0) ? 0 : 1);
+                }
+                else
+                {
+                    // The interpreter is not thread-safe: refuse the call
+                    callback.forth->refuseCallback();
+                }
+                if constexpr (std::is_same_v<R, double>)
+                    return double(output.real());
+                else
+                    return Integer(output.integer());
+            }
+        };
+    };
+
+    template<typename R, size_t Slot, size_t... I>
+    std::array<void*, sizeof...(I)> thunks(std::index_sequence<I...>)
+    {
+        constexpr bool real = std::is_same_v<R, double>;
+        return {{ reinterpret_cast<void*>(
+                  &Specialize<arity(I), mask(I)>::template
+                  type<Thunks<R, callbackIndex(real, I, Slot)>::template type>::call)... }};
+    }
+
+    template<size_t... Slot>
+    std::array<void*, 2u * SIGNATURES * CALLBACK_SLOTS> thunks(std::index_sequence<Slot...>)
+    {
+        std::array<void*, 2u * SIGNATURES * CALLBACK_SLOTS> table;
+        auto fill = [&table](bool const real, size_t const slot,
+                             std::array<void*, SIGNATURES> const& functions)
+        {
+            for (size_t i = 0u; i < SIGNATURES; ++i)
+                table[callbackIndex(real, i, slot)] = functions[i];
+        };
+        (fill(false, Slot, thunks<Integer, Slot>(std::make_index_sequence<SIGNATURES>{})), ...);
+        (fill(true, Slot, thunks<double, Slot>(std::make_index_sequence<SIGNATURES>{})), ...);
+        return table;
+    }
+
+    //! \brief Return the C function of the slot.
+    void* thunk(size_t const index)
+    {
+        static const auto table = thunks(std::make_index_sequence<CALLBACK_SLOTS>{});
+        return table[index];
+    }
+#endif
+
+    //! \brief Read the parameters "i l a f [-- i l a f]" of C-IMPORT and
+    //! C-CALLBACK.
+    //! \return the error or an empty string.
+    std::string signature(InputStream& stream, std::string& params, char& result)
+    {
+        bool output = false;
+        while ((!stream.eol()) && stream.split())
+        {
+            std::string_view const word = stream.word();
+            if ((word.size() == 1u) && (std::string("ilaf").find(word[0]) != std::string::npos))
+            {
+                if (!output)
+                    params += word[0];
+                else if (result == 0)
+                    result = word[0];
+                else
+                    return "a C function can only return a single value";
+            }
+            else if ((word == "--") && !output)
+            {
+                output = true;
+            }
+            else
+            {
+                return "unknown parameter " + std::string(word);
+            }
+        }
+        return {};
+    }
+}
+
+//----------------------------------------------------------------------------
+CImport const* CLib::import(InputStream& stream)
+{
+    CImport import;
+    std::string words[3];
+
+    // Forth name, library and C symbol
+    for (auto& it: words)
+    {
+        if (!stream.split())
+        {
+            m_error = "C-IMPORT: Failed getting the Forth name, the library and "
+                      "the C symbol. Reason was " + stream.error();
+            return nullptr;
+        }
+        it = stream.word();
+    }
+    import.forthName = toUpper(words[0]);
+
+    // Parameters: i l a f [-- i l a f]
+    std::string const error = signature(stream, import.params, import.result);
+    if (!error.empty())
+    {
+        m_error = "C-IMPORT: " + error;
+        return nullptr;
+    }
+
+    // Open the library once
+    void*& library = m_imported_libraries[words[1]];
+    if (library == nullptr)
+    {
+        if (words[1] == "-")
+            library = dlopen(nullptr, RTLD_NOW);
+        else
+        {
+            for (std::string const& name: { words[1], words[1] + DYLIB_EXT,
+                                             "lib" + words[1] + DYLIB_EXT })
+            {
+                if ((library = dlopen(name.c_str(), RTLD_NOW)) != nullptr)
+                    break;
+            }
+        }
+        if (library == nullptr)
+        {
+            m_imported_libraries.erase(words[1]);
+            m_error = "C-IMPORT: Failed loading shared libray " + words[1]
+                      + ". Reason was '" + std::string(dlerror()) + "'";
+            return nullptr;
+        }
+    }
+
+    import.symbol = dlsym(library, words[2].c_str());
+    if (import.symbol == nullptr)
+    {
+        m_error = "C-IMPORT: Failed finding symbol '" + words[2] + "' in '"
+                  + words[1] + "'";
+        return nullptr;
+    }
+
+    // The generic trampoline refers to the stored structure
+    m_imports.push_back(import);
+    CImport& stored = m_imports.back();
+    bool found;
+    switch (stored.result)
+    {
+    case 0: found = trampoline<void>(stored); break;
+    case 'i': found = trampoline<int>(stored); break;
+    case 'l': found = trampoline<long>(stored); break;
+    case 'a': found = trampoline<void*>(stored); break;
+    default: found = trampoline<double>(stored); break;
+    }
+    if (!found)
+    {
+        m_imports.pop_back();
+        m_error = "C-IMPORT: too many parameters for " + words[2];
+        return nullptr;
+    }
+    return &stored;
+}
+
+//----------------------------------------------------------------------------
+void* CLib::callback(Interpreter& forth, Token const xt, InputStream& stream)
+{
+    std::string params;
+    char result = 0;
+
+    std::string const error = signature(stream, params, result);
+    if (!error.empty())
+    {
+        m_error = "C-CALLBACK: " + error;
+        return nullptr;
+    }
+
+#ifdef REGISTER_CALLING_CONVENTION
+    size_t const index = signature(params);
+    if (index >= SIGNATURES)
+    {
+        m_error = "C-CALLBACK: too many parameters";
+        return nullptr;
+    }
+
+    // Reuse the thunk of the same word or take a free one
+    std::lock_guard<std::mutex> lock(s_callbacks_mutex);
+    bool const real = (result == 'f');
+    size_t const none = 2u * SIGNATURES * CALLBACK_SLOTS;
+    size_t free = none;
+    for (size_t slot = 0u; slot < CALLBACK_SLOTS; ++slot)
+    {
+        size_t const i = callbackIndex(real, index, slot);
+        Callback const& it = s_callbacks[i];
+        if ((it.forth == &forth) && (it.owner == std::this_thread::get_id())
+            && (it.xt == xt) && (it.params == params) && (it.result == result))
+        {
+            return thunk(i);
+        }
+        if ((it.forth == nullptr) && (free == none))
+        {
+            free = i;
+        }
+    }
+    if (free == none)
+    {
+        m_error = "C-CALLBACK: too many callbacks with this signature";
+        return nullptr;
+    }
+
+    s_callbacks[free] = { &forth, std::this_thread::get_id(), xt, params, result };
+    m_callbacks.push_back(free);
+    return thunk(free);
+#else
+    (void) forth; (void) xt;
+    m_error = "C-CALLBACK: not supported on this architecture";
+    return nullptr;
+#endif
+}
+
 //----------------------------------------------------------------------------
 CLib::~CLib()
 {
     CFunHolder::next_handle = 0;
 
-    // Close the shared library file
-    if (m_handle == nullptr)
-        return ;
-    dlclose(m_handle);
-    m_handle = nullptr;
+    // Wait for the compilations then close the shared library files
+    wait();
+    for (auto& it: m_libraries)
+    {
+        if (it.handle != nullptr)
+            dlclose(it.handle);
+    }
+    for (auto& it: m_imported_libraries)
+    {
+        dlclose(it.second);
+    }
+
+#ifdef REGISTER_CALLING_CONVENTION
+    std::lock_guard<std::mutex> lock(s_callbacks_mutex);
+    for (size_t const it: m_callbacks)
+    {
+        s_callbacks[it].forth = nullptr;
+    }
+#endif
 }
 
 //----------------------------------------------------------------------------
@@ -49,14 +858,14 @@ void CLib::reset()
     m_file.close();
     m_libName.clear();
     m_sourcePath.clear();
-    m_libPath.clear();
     m_extLibs.clear();
+    m_pkgConfig.clear();
     m_error.clear();
-    if (m_handle != nullptr)
-    {
-        dlclose(m_handle);
-        m_handle = nullptr;
-    }
+
+    // Forget functions of a library not terminated by END-C-LIB
+    while (!m_functions.empty() && (m_functions.back().library >= m_libraries.size()))
+        m_functions.pop_back();
+    CFunHolder::next_handle = Token(m_functions.size());
 }
 
 //----------------------------------------------------------------------------
@@ -71,7 +880,6 @@ bool CLib::begin(InputStream& stream)
         return false;
     }
     m_libName = stream.word();
-    m_libPath = project::info::tmp_path + m_libName + DYLIB_EXT;
 
     // Create a temporary C file which will contain generated C code and
     // wrapping functions calling the desired C function and hiding parameters
@@ -87,7 +895,31 @@ bool CLib::begin(InputStream& stream)
 
     // Add an header in the file for including information such a Cell.
     m_file << "#include <stdint.h>\n\n";
+#ifdef USE_PACKED_CELL
+    // Cells are packed in 8 bytes (NaN-boxing): accessors are needed for
+    // (un)boxing integers.
+    m_file << "struct Cell { uint64_t bits; };\n\n"
+           << "#define CELL_INT_TAG_ UINT64_C(0xfffc000000000000)\n"
+           << "static inline double cell_f_(struct Cell c) {\n"
+           << "  union { uint64_t u; double f; } x;\n"
+           << "  if ((c.bits & CELL_INT_TAG_) == CELL_INT_TAG_) return (double) ((int64_t) (c.bits << 14) >> 14);\n"
+           << "  x.u = c.bits; return x.f;\n}\n"
+           << "static inline int64_t cell_i_(struct Cell c) {\n"
+           << "  double f;\n"
+           << "  if ((c.bits & CELL_INT_TAG_) == CELL_INT_TAG_) return (int64_t) (c.bits << 14) >> 14;\n"
+           << "  f = cell_f_(c); return (int64_t) ((f < 0.0) ? (f - 0.5) : (f + 0.5));\n}\n"
+           << "static inline void* cell_a_(struct Cell c) { return (void*) (intptr_t) cell_i_(c); }\n"
+           << "static inline struct Cell cell_from_i_(int64_t i) {\n"
+           << "  struct Cell c; c.bits = CELL_INT_TAG_ | ((uint64_t) i & ~CELL_INT_TAG_); return c;\n}\n"
+           << "static inline struct Cell cell_from_f_(double f) {\n"
+           << "  union { uint64_t u; double f; } x; struct Cell c;\n"
+           << "  x.f = f; c.bits = x.u;\n"
+           << "  if ((c.bits & CELL_INT_TAG_) == CELL_INT_TAG_) c.bits = UINT64_C(0x7ff8000000000000);\n"
+           << "  return c;\n}\n"
+           << "static inline struct Cell cell_from_a_(void* a) { return cell_from_i_((int64_t) (intptr_t) a); }\n\n";
+#else
     m_file << "struct Cell { union { void* a; int64_t i; double f; }; enum { INT = 0, FLOAT } tag; };\n\n";
+#endif
     return true;
 }
 
@@ -121,13 +953,15 @@ bool CLib::function(InputStream& stream)
                   + stream.error();
         return false;
     }
-    holder.cName = "simforth_c_" + stream.word() + '_';
+    holder.cName = "simforth_c_" + std::string(stream.word()) + '_';
 
     // Extract C function params
     if (!extractFunParams(holder, stream))
         return false;
 
     // Store the new function holder
+    holder.library = m_libraries.size();
+    holder.clib = this;
     m_functions.push_back(holder);
     return true;
 }
@@ -139,15 +973,17 @@ bool CLib::extractFunParams(CFunHolder& holder, InputStream& stream)
     std::string word;
 
     // Name of the wrapped C function
-    std::string name = stream.word();
+    std::string name(stream.word());
 
     // Generate the code source getting parameters from the Forth data stack
     // and transfer them into the C function.
     std::string args;
     args.reserve(16); // For helping the insert(0, "...") function
 
-    // Number of parameters
+    // Number of parameters (cells)
     int count = 0;
+    // Position of the cell of each parameter
+    std::vector<int> cells;
 
     enum Param { Input, Output };
     Param param = Param::Input;
@@ -160,10 +996,34 @@ bool CLib::extractFunParams(CFunHolder& holder, InputStream& stream)
         {
             holder.cName += word[0];
             if (param == Param::Output)
+            {
+                if (++holder.outputs > 1)
+                {
+                    m_error = "C function can only return a single value";
+                    return false;
+                }
                 continue;
+            }
+            cells.push_back(count);
             ++count;
+            ++holder.inputs;
             args += word[0];
         }
+        else if ((word == "i[]") || (word == "f[]")) // ( addr n ) passed as pointer
+        {
+            if (param == Param::Output)
+            {
+                m_error = "C function cannot return an array";
+                return false;
+            }
+            char const kind = (word[0] == 'f') ? 'F' : 'I';
+            holder.cName += kind;
+            holder.arrays.push_back(count);
+            cells.push_back(count);
+            count += 2;
+            holder.inputs += 2;
+            args += kind;
+        }
         else if (word == "--") // ouput parameters
         {
             if (param == Param::Output)
@@ -199,28 +1059,52 @@ bool CLib::extractFunParams(CFunHolder& holder, InputStream& stream)
     // Manage the return code
     if (param == Param::Output)
     {
+#ifdef USE_PACKED_CELL
+        m_file << "ds[" << std::to_string(-count) << "] = cell_from_" << word[0] << "_(";
+#else
         m_file << "ds[" << std::to_string(-count) << "]." << word[0] << " = ";
+#endif
     }
 
-    // The C function to call
+    // The C function to call. Arrays are given as pointers on int64_t or
+    // double.
     m_file << name << '(';
-    int32_t const nb_args = int32_t(args.size());
-    for (count = 0; count < nb_args; ++count)
+    for (size_t i = 0u; i < args.size(); ++i)
     {
-        m_file << "ds[" << std::to_string(count - nb_args) + "]." << args[size_t(count)];
-        if (count + 1 != nb_args)
+        char kind = args[i];
+        if (kind == 'F')
+            m_file << "(double*) ";
+        else if (kind == 'I')
+            m_file << "(int64_t*) ";
+        if ((kind == 'F') || (kind == 'I'))
+            kind = 'a';
+
+        std::string const index = std::to_string(cells[i] - count);
+#ifdef USE_PACKED_CELL
+        m_file << "cell_" << kind << "_(ds[" << index << "])";
+#else
+        m_file << "ds[" << index << "]." << kind;
+#endif
+        if (i + 1u != args.size())
             m_file << ", ";
     }
-    m_file << ");\n";
+    m_file << ")";
 
     // Restore the Data Stack depth
     if (param == Param::Output)
     {
+#ifdef USE_PACKED_CELL
+        m_file << ");\n";
+#else
         std::string tag = ((word[0] == 'f') ? "FLOAT" : "INT");
-        m_file << "  ds[" << std::to_string(-count) << "].tag = " << tag << ";\n";
-
+        m_file << ";\n  ds[" << std::to_string(-count) << "].tag = " << tag << ";\n";
+#endif
         count = count - 1;
     }
+    else
+    {
+        m_file << ";\n";
+    }
 
     if (count > 0)
     {
@@ -259,7 +1143,7 @@ bool CLib::library(InputStream& stream)
         m_error = stream.error();
         return false;
     }
-    auto const& lib = stream.word();
+    std::string_view const lib = stream.word();
 
     // Has read "-lfoo" ?
     if ((lib.size() >= 3u) && (lib[0] == '-') && (lib[1] == 'l'))
@@ -288,62 +1172,125 @@ bool CLib::end(CLibOptions const& options)
 {
     // Close the temporary C file.
     m_file.close();
-
-    // FIXME for the moment we manage a single library
-    if (m_handle != nullptr)
+    if (m_sourcePath.empty())
     {
-        m_error = "Failed loading shared libray '" + m_libPath
-                  + "'. Looks like already opened";
+        m_error = "END-C-LIB without C-LIB";
         return false;
     }
 
-    // Compile the temporary C file as a dynamic library.
-    if (!compile(options))
+    // Files of the compilation are named after the hash: libraries being
+    // compiled in background do not share them, even with the same name.
+    std::string const name = m_libName + '-' + hash(options);
+    std::string const source = project::info::tmp_path + name + ".c";
+    if (rename(m_sourcePath.c_str(), source.c_str()) != 0)
+    {
+        m_error = "Failed renaming '" + m_sourcePath + "' as '" + source + "'";
         return false;
+    }
+    m_sourcePath.clear();
 
-    // Open the newly created shared library.
-    m_handle = dlopen(m_libPath.c_str(), RTLD_NOW);
-    if (!m_handle)
+    m_libraries.emplace_back();
+    Library& library = m_libraries.back();
+    std::string const built = project::info::tmp_path + name + DYLIB_EXT;
+    std::string const cached = ((options.cache_size == 0u) || !openCache())
+                               ? std::string() : cachePath() + name + DYLIB_EXT;
+    m_cached = !cached.empty() && isTrusted(cached, false);
+    if (m_cached)
+    {
+        // Reuse the library compiled from the same sources. Update the
+        // access time used for evictions.
+        LOGI("C-Lib cache: reuse '%s'", cached.c_str());
+        utime(cached.c_str(), nullptr);
+        library.path = cached;
+        std::promise<std::pair<void*, std::string>> loaded;
+        void* handle = dlopen(cached.c_str(), RTLD_NOW);
+        loaded.set_value({ handle, (handle != nullptr) ? std::string() :
+                           "Failed loading shared libray. Reason was '"
+                           + std::string(dlerror()) + "'" });
+        library.build = loaded.get_future();
+    }
+    else
+    {
+        library.path = cached.empty() ? built : cached;
+        library.build = std::async(std::launch::async, build, command(name, options),
+                                   built, cached, project::info::tmp_path + name + ".res",
+                                   options.cache_size);
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------
+bool CLib::bind(size_t const index)
+{
+    std::string const& error = load(index);
+    if (!error.empty())
     {
-        m_error = "Failed loading shared libray. Reason was '"
-                  + std::string(dlerror()) + "'";
+        m_error = error;
         return false;
     }
+    return true;
+}
 
-    // Find function symbols inside the shared library.
-    bool ret = true;
-    for (auto &it: m_functions)
+//----------------------------------------------------------------------------
+std::string const& CLib::load(size_t const index)
+{
+    Library& library = m_libraries[index];
+
+    // std::future::get() can only be called once
+    std::call_once(library.bound, [this, &library, index]()
     {
-        void* symbol = dlsym(m_handle, it.cName.c_str());
-        if (symbol != nullptr)
-        {
-            LOGI("Found symbol '%s' in '%s'", it.cName.c_str(),
-                 m_libPath.c_str());
-            it.function = reinterpret_cast<forth_c_func>(
-                reinterpret_cast<long>(symbol));
-        }
-        else
+        std::pair<void*, std::string> result = library.build.get();
+        library.handle = result.first;
+        library.error = result.second;
+
+        // Find function symbols inside the shared library.
+        for (auto &it: m_functions)
         {
-            std::string err =
-                    "Failed finding symbol '" + it.cName +
-                    "' in '" + m_libPath + "\n";
-            m_error.append(err);
-            ret = false;
+            if ((it.library != index) || (library.handle == nullptr))
+                continue;
+
+            void* symbol = dlsym(library.handle, it.cName.c_str());
+            if (symbol != nullptr)
+            {
+                LOGI("Found symbol '%s' in '%s'", it.cName.c_str(),
+                     library.path.c_str());
+                it.function = reinterpret_cast<forth_c_func>(
+                    reinterpret_cast<long>(symbol));
+            }
+            else
+            {
+                library.error.append("Failed finding symbol '" + it.cName +
+                                     "' in '" + library.path + "\n");
+            }
         }
-    }
+    });
+
+    return library.error;
+}
 
+//----------------------------------------------------------------------------
+bool CLib::wait()
+{
+    bool ret = true;
+
+    for (size_t i = 0u; i < m_libraries.size(); ++i)
+    {
+        ret &= bind(i);
+    }
     return ret;
 }
 
 //----------------------------------------------------------------------------
-bool CLib::compile(CLibOptions const& options)
+std::string CLib::command(std::string const& name, CLibOptions const& options) const
 {
     // Refer to the generic Makefile for compiling C file into a shared library.
     std::string makefile = m_path.expand("LibC/Makefile");
-    std::string command = "rm -f " + m_libPath + " " + project::info::tmp_path + m_libName + ".o"
+    std::string command = "rm -f " + project::info::tmp_path + name + DYLIB_EXT
+                        + " " + project::info::tmp_path + name + ".o"
                         + "; make -f " + makefile
                         + " BUILD=" + project::info::tmp_path
-                        + " SRCS=" + m_libName + ".c"
+                        + " SRCS=" + name + ".c"
                         + " EXTLIBS=\"" + m_extLibs + "\""
                         + " PKGCONFIG=\"" + m_pkgConfig + "\"";
     // Optional behaviors
@@ -357,56 +1304,58 @@ bool CLib::compile(CLibOptions const& options)
     }
     // Redirect error to a temporary file since it is not easy to get it
     // directly
-    command += " 2> " + project::info::tmp_path + "compilation.res";
+    command += " 2> " + project::info::tmp_path + name + ".res";
+    return command;
+}
 
-    // Compile the C file
-    LOGI("C-Lib compilation: %s", command.c_str());
-    if (system(command.c_str()) != 0)
+//----------------------------------------------------------------------------
+void CLib::saveToDictionary(Interpreter& forth)
+{
+    for (auto& it: m_functions)
     {
-        // If something wrong happened. Get the Makefile error message and store
-        // it in our logs.
-        std::ifstream t(project::info::tmp_path + "compilation.res");
-        std::string str;
-        t.seekg(0, std::ios::end);
-        str.reserve(size_t(t.tellg()));
-        t.seekg(0, std::ios::beg);
-        str.assign(std::istreambuf_iterator<char>(t),
-                   std::istreambuf_iterator<char>());
-
-        m_error = "Failed compiling shared libray '" + m_libPath + "' Reason was:\n";
-        m_error.append(str);
-        return false;
+        if (it.library + 1u != m_libraries.size())
+            continue;
+
+        forth.registerPrimitive(it.forthName, { &CLib::call, &it, it.inputs, it.outputs },
+                                nullptr);
     }
-    return true;
 }
 
 //----------------------------------------------------------------------------
-void CLib::saveToDictionary(Dictionary& dictionary)
+void CLib::truncate(size_t const count)
 {
-    for (auto it: m_functions)
+    if (count < m_functions.size())
     {
-        dictionary.createEntry(it.forthName);
-        dictionary.append(Primitives::PLITERAL);
-        dictionary.append(it.handle);
-        dictionary.append(Primitives::CLIB_EXEC);
-        dictionary.finalizeEntry();
+        m_functions.resize(count);
+        CFunHolder::next_handle = Token(count);
     }
 }
 
 //----------------------------------------------------------------------------
-void CLib::exec(Token handle, DataStack& stack) const
+void CLib::forgetCallbacks(Token const here)
+{
+#ifdef REGISTER_CALLING_CONVENTION
+    std::lock_guard<std::mutex> lock(s_callbacks_mutex);
+    auto forgotten = [here](size_t const it)
+    {
+        if (s_callbacks[it].xt < here)
+            return false;
+        s_callbacks[it].forth = nullptr;
+        return true;
+    };
+    m_callbacks.erase(std::remove_if(m_callbacks.begin(), m_callbacks.end(), forgotten),
+                      m_callbacks.end());
+#else
+    (void) here;
+#endif
+}
+
+//----------------------------------------------------------------------------
+void CLib::exec(Token handle, DataStack& stack)
 {
-    // TODO check the depth
     if (handle < m_functions.size())
     {
-        if (m_functions[handle].function != nullptr)
-        {
-            m_functions[handle].function(&stack.top());
-        }
-        else
-        {
-            THROW("Function has not been compiled");
-        }
+        call(&m_functions[handle], stack);
     }
     else
     {
@@ -414,4 +1363,52 @@ void CLib::exec(Token handle, DataStack& stack) const
     }
 }
 
+//----------------------------------------------------------------------------
+void CLib::call(void* context, DataStack& stack)
+{
+    CFunHolder& holder = *static_cast<CFunHolder*>(context);
+
+    // Bind the functions of the library at the first call. Also done for
+    // the next calls: they may come from other threads and shall see the
+    // function bound by the first one.
+    CLib& clib = *holder.clib;
+    if (holder.library < clib.m_libraries.size())
+    {
+        std::string const& error = clib.load(holder.library);
+        if (!error.empty())
+        {
+            THROW(error);
+        }
+    }
+    if (holder.function == nullptr)
+    {
+        THROW("Function has not been compiled");
+    }
+
+    // Give the address of the Forth buffers: no copy. They belong to the
+    // interpreter making the call, which may be a worker of SPAWN.
+    if (!holder.arrays.empty())
+    {
+        Interpreter* forth = Interpreter::current();
+        if (forth == nullptr)
+        {
+            THROW("No memory for the arrays of " + holder.forthName);
+        }
+        Cell* cells = stack.top() - holder.inputs;
+        for (int32_t const i: holder.arrays)
+        {
+            Token* buffer = forth->cells(cells[i].integer(), cells[i + 1].integer());
+            if ((reinterpret_cast<uintptr_t>(buffer) % sizeof(Int)) != 0u)
+            {
+                THROW(holder.forthName + ": array at address "
+                      + std::to_string(cells[i].integer())
+                      + " is not aligned on 8 bytes");
+            }
+            cells[i] = Cell::integer(Int(reinterpret_cast<intptr_t>(buffer)));
+        }
+    }
+
+    holder.function(&stack.top());
+}
+
 } // namespace forth
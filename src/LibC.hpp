@@ -26,12 +26,19 @@
 #  include "Dictionary.hpp"
 #  include "Streams.hpp"
 #  include <string>
+#  include <deque>
 #  include <fstream>
+#  include <future>
+#  include <map>
+#  include <mutex>
 #  include <vector>
 
 namespace forth
 {
 
+class CLib;
+class Interpreter;
+
 // *****************************************************************************
 //! \brief SimForth executes only one kind of C pointer function: a wrapping
 //! function calling the desired C function and passing to it the correct number
@@ -42,6 +49,33 @@ namespace forth
 // *****************************************************************************
 typedef void (*forth_c_func)(Cell**);
 
+// *****************************************************************************
+//! \brief Function calling a C function imported by C-IMPORT with the cells
+//! of the data stack and pushing its result. context refers to the C
+//! function.
+// *****************************************************************************
+typedef void (*forth_c_trampoline)(void* context, DataStack& stack);
+
+// *****************************************************************************
+//! \brief C function imported from a shared library without compilation
+//! (see CLib::import()).
+// *****************************************************************************
+struct CImport
+{
+    //! \brief Forth Name of the function
+    std::string forthName;
+    //! \brief Address of the C function (dlsym).
+    void* symbol = nullptr;
+    //! \brief Kinds of the parameters: 'i' (int), 'l' (long), 'a' (address)
+    //! or 'f' (double).
+    std::string params;
+    //! \brief Kind of the returned value, 0 for void.
+    char result = 0;
+    //! \brief Function called by the interpreter with context.
+    forth_c_trampoline trampoline = nullptr;
+    void* context = nullptr;
+};
+
 // *****************************************************************************
 //! \brief Structure holding a pointer on a C function and holding additional
 //! internal information.
@@ -61,6 +95,16 @@ struct CFunHolder
     std::string cName;
     //! \brief Handle to CLib::m_functions
     Token handle;
+    //! \brief Index of the shared library in CLib::m_libraries.
+    size_t library = 0u;
+    //! \brief Number of cells taken and pushed on the data stack.
+    int32_t inputs = 0;
+    int32_t outputs = 0;
+    //! \brief Position of the ( addr n ) cells of array parameters, from the
+    //! first input cell. addr is replaced by the C pointer before the call.
+    std::vector<int32_t> arrays;
+    //! \brief Library binding the function at its first call.
+    CLib* clib = nullptr;
 
     //! \brief Auto-increment the value for the next handle.
     static Token next_handle;
@@ -78,6 +122,9 @@ struct CLibOptions
     bool verbose = false;
     //! \brief Select compiler (use default compiler if emptry)
     std::string compiler;
+    //! \brief Maximal number of shared libraries kept in the build cache (see
+    //! CLib::end()). 0 disables the cache.
+    size_t cache_size = 64u;
 };
 
 // *****************************************************************************
@@ -167,14 +214,27 @@ public:
     bool library(InputStream& stream);
 
     //--------------------------------------------------------------------------
-    //! \brief Store the C function as a new word inside the Forth dictionary.
+    //! \brief Register the C functions of the last library as primitives of
+    //! the interpreter: their tokens are dispatched to call() with their
+    //! CFunHolder and the depth of the data stack is checked against their
+    //! signature.
     //!
-    //! \param[inout] dictionary the Forth dictionary.
+    //! \param[inout] forth the interpreter owning this instance.
     //--------------------------------------------------------------------------
-    void saveToDictionary(Dictionary& dictionary);
+    void saveToDictionary(Interpreter& forth);
 
     //--------------------------------------------------------------------------
-    //! \brief Compile the shared library.
+    //! \brief Compile the shared library in background and return at once.
+    //! Several libraries are compiled in parallel, on at most as many threads
+    //! as cores. The library is loaded and its functions are bound the first
+    //! time one of them is called (see exec()): compilation errors are
+    //! reported at this time.
+    //!
+    //! Shared libraries are cached: they are named after a hash of the
+    //! generated C code, the Makefile, the compiler, the compilation flags and
+    //! the external libraries. When a library with the same hash has already
+    //! been compiled, it is loaded without calling the compiler. The least
+    //! recently used libraries are removed when the cache is full.
     //!
     //! \param[in] options Optional Makefile options.
     //!
@@ -183,6 +243,62 @@ public:
     //--------------------------------------------------------------------------
     bool end(CLibOptions const& options = CLibOptions());
 
+    //--------------------------------------------------------------------------
+    //! \brief Read from the Forth input stream the Forth name, the shared
+    //! library, the C symbol and the parameters (as for C-FUNCTION) of a C
+    //! function and find it with dlopen() and dlsym(): no C code is
+    //! generated nor compiled.
+    //!
+    //! The function is called by a trampoline specialized at compile time
+    //! for its signature when it has at most 4 parameters. Others are called
+    //! by a generic trampoline passing integers and doubles in the registers
+    //! of the calling convention (x86-64 and AArch64 only).
+    //!
+    //! The library "-" refers to the libraries already loaded by the process
+    //! (i.e. the libc). Else the name is tried as is, then with the shared
+    //! library extension, then with the "lib" prefix.
+    //!
+    //! \param[inout] stream the Forth input stream.
+    //! \return the imported function or nullptr in case of failure and call
+    //! error() to know which error occured.
+    //--------------------------------------------------------------------------
+    CImport const* import(InputStream& stream);
+
+    //--------------------------------------------------------------------------
+    //! \brief Read from the Forth input stream the parameters of a C function
+    //! (as for C-IMPORT) and return a C function with this prototype calling
+    //! back the word xt (see Interpreter::reenter()). Its parameters are
+    //! pushed on the data stack and the word shall leave the result.
+    //!
+    //! C functions are taken from a pool of thunks compiled for each
+    //! signature of at most 4 parameters: 8 functions per
+    //! signature and kind of result (integer or double). They are released
+    //! by the destructor. Only x86-64 and AArch64 are supported.
+    //!
+    //! \param[inout] forth the interpreter executing xt.
+    //! \param[in] xt the execution token of the word.
+    //! \param[inout] stream the Forth input stream.
+    //! \return the C function or nullptr in case of failure and call error()
+    //! to know which error occured.
+    //--------------------------------------------------------------------------
+    void* callback(Interpreter& forth, Token const xt, InputStream& stream);
+
+    //--------------------------------------------------------------------------
+    //! \brief Remove all shared libraries of the build cache. Libraries
+    //! already loaded stay usable.
+    //! \return the number of removed libraries.
+    //--------------------------------------------------------------------------
+    static size_t clearCache();
+
+    //--------------------------------------------------------------------------
+    //! \brief Return true if the last end() has loaded the shared library
+    //! from the build cache instead of compiling it.
+    //--------------------------------------------------------------------------
+    inline bool cached() const
+    {
+        return m_cached;
+    }
+
     //--------------------------------------------------------------------------
     //! \brief Return the last error in human readable format.
     //--------------------------------------------------------------------------
@@ -194,20 +310,51 @@ public:
     //--------------------------------------------------------------------------
     //! \brief Return the collection of C pointer functions.
     //--------------------------------------------------------------------------
-    inline std::vector<CFunHolder> const& functions() const
+    inline std::deque<CFunHolder> const& functions() const
     {
         return m_functions;
     }
 
     //--------------------------------------------------------------------------
-    //! \brief Execute the C function refered by its handle.
+    //! \brief Forget C functions declared after the first count ones. Used
+    //! when rolling back to a checkpoint. The shared library stays loaded.
+    //--------------------------------------------------------------------------
+    void truncate(size_t const count);
+
+    //--------------------------------------------------------------------------
+    //! \brief Release the thunks given by callback() for words whose
+    //! execution token is >= here: they are forgotten when rolling back to a
+    //! checkpoint. Their slots can be taken by new callbacks and C code still
+    //! calling them gets 0.
+    //--------------------------------------------------------------------------
+    void forgetCallbacks(Token const here);
+
+    //--------------------------------------------------------------------------
+    //! \brief Execute the C function refered by its handle. The first call
+    //! waits for the compilation of its library. Used by dictionaries
+    //! calling (EXEC-C): words created by saveToDictionary() call call().
     //!
     //! \throw in case of error (invalid handle, not compiled function).
     //! \param handle the identifier of the C function to execute.
-    //! \param[inout]
-    //! TODO check the depth of the Forth Data Stack.
+    //! \param[inout] stack the Forth data stack.
     //--------------------------------------------------------------------------
-    void exec(Token handle, DataStack& stack) const;
+    void exec(Token handle, DataStack& stack);
+
+    //--------------------------------------------------------------------------
+    //! \brief Execute the C function held by context (a CFunHolder). The
+    //! depth of the stack has already been checked by the interpreter. Forth
+    //! addresses of array parameters are converted into C pointers.
+    //! \throw if the library of the function has not been compiled or if an
+    //! array is not inside the dictionary or the heap.
+    //--------------------------------------------------------------------------
+    static void call(void* context, DataStack& stack);
+
+    //--------------------------------------------------------------------------
+    //! \brief Wait for the end of all compilations and bind their functions.
+    //! \return false if a library has failed and call error() to know which
+    //! error occured.
+    //--------------------------------------------------------------------------
+    bool wait();
 
 private:
 
@@ -217,14 +364,31 @@ private:
     void reset();
 
     //--------------------------------------------------------------------------
-    //! \brief Compile the generated C code into a shared library.
-    //!
-    //! Call the Makefile to compiledthe generated C code into a shared library.
-    //!
-    //! \return true in case of success, false in case of failure and call error()
-    //! to know which error occured.
+    //! \brief Return the command calling the Makefile compiling the C file
+    //! name.c into the shared library name.so.
+    //--------------------------------------------------------------------------
+    std::string command(std::string const& name, CLibOptions const& options) const;
+
+    //--------------------------------------------------------------------------
+    //! \brief Wait for the compilation of the library then search the
+    //! symbols of its functions.
+    //! \return false if the library cannot be used and call error() to know
+    //! which error occured.
+    //--------------------------------------------------------------------------
+    bool bind(size_t const library);
+
+    //--------------------------------------------------------------------------
+    //! \brief Thread-safe part of bind(): the first call waits for the
+    //! compilation and searches the symbols, concurrent calls wait for it.
+    //! \return the error of the library, empty if it can be used.
     //--------------------------------------------------------------------------
-    bool compile(CLibOptions const& options);
+    std::string const& load(size_t const library);
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the hash identifying the shared library in the build
+    //! cache (see end()).
+    //--------------------------------------------------------------------------
+    std::string hash(CLibOptions const& options) const;
 
     //--------------------------------------------------------------------------
     //! \brief Read from the input stream the list of input/outputs parameters
@@ -246,7 +410,37 @@ private:
 
     //CLibOptions& m_options;
     //! \brief Collection of C function pointers.
-    std::vector<CFunHolder> m_functions;
+    //! \brief Addresses do not change: they are the contexts of primitives.
+    std::deque<CFunHolder> m_functions;
+
+    //--------------------------------------------------------------------------
+    //! \brief Shared library created by END-C-LIB.
+    //--------------------------------------------------------------------------
+    struct Library
+    {
+        //! \brief Compilation in progress: the handle of the loaded library
+        //! or nullptr and an error message.
+        std::future<std::pair<void*, std::string>> build;
+        //! \brief Path of the compiled shared library.
+        std::string path;
+        //! \brief Handle on the shared library (dlopen) once bound.
+        void* handle = nullptr;
+        //! \brief Set if the library cannot be used.
+        std::string error;
+        //! \brief Functions may be called for the first time by several
+        //! threads (SPAWN): only one of them binds the library (see load()).
+        std::once_flag bound;
+    };
+
+    //! \brief Libraries in the order of their creation. Their addresses do
+    //! not change.
+    std::deque<Library> m_libraries;
+    //! \brief Functions imported by C-IMPORT. Their addresses do not change.
+    std::deque<CImport> m_imports;
+    //! \brief Libraries opened by C-IMPORT.
+    std::map<std::string, void*> m_imported_libraries;
+    //! \brief Slots of the thunks given by callback().
+    std::vector<size_t> m_callbacks;
     // std::unordered_map<std::string, CFunHolder> m_functions;
     //! \brief File descriptor of the generated C file.
     std::ofstream m_file;
@@ -254,16 +448,14 @@ private:
     std::string m_libName;
     //! \brief Path of the generated C file.
     std::string m_sourcePath;
-    //! \brief Path of the compiled shared library.
-    std::string m_libPath;
     //! \brief External libraries not known by pkg-config.
     std::string m_extLibs;
     //! \brief External libraries known by pkg-config.
     std::string m_pkgConfig;
     //! \brief Last error.
     std::string m_error;
-    //! \brief Handle on the shared library (dlopen)
-    void* m_handle = nullptr;
+    //! \brief Has the last end() found the library in the build cache ?
+    bool m_cached = false;
 };
 
 } // namespace forth
@@ -19,6 +19,7 @@
 //==============================================================================
 
 #include "SimForth/Options.hpp"
+#include "SimForth/Stack.hpp"
 
 namespace forth
 {
@@ -27,7 +28,14 @@ Options::Options()
     : quiet(false),
       show_stack(true),
       traces(false),
-      path(PROJECT_DATA_PATH)
+      pipeline(false),
+      path(PROJECT_DATA_PATH),
+      data_stack_depth(size::stack),
+      auxiliary_stack_depth(size::stack),
+      return_stack_depth(size::stack),
+      workers(0u),
+      budget(0u),
+      timeout(0u)
 {}
 
 } // namespace forth
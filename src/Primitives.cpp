@@ -22,6 +22,8 @@
 #include "Primitives.hpp"
 #include "Exceptions.hpp"
 #include "Utils.hpp"
+#include "Channel.hpp"
+#include <algorithm>
 #include <cstring> // memmove
 #include <cmath>
 #include <cstdlib> // system
@@ -52,6 +54,12 @@ namespace forth
 //-----------------------------------------------------------------------------
 //! \brief Check if the token xt has enough parameters to consume in the stack S
 //! (meaning if the depth d of the stack S is enough deep).
+//! \note Words reading all their parameters do not need this check: reading
+//! below the bottom of a stack hits its guard page and the interpreter throws
+//! the same exception (see Interpreter::execute()), but only once the word
+//! has returned. It is kept for words only moving the stack pointer (i.e.
+//! DROP), accessing it by index (i.e. PICK) and words with side effects
+//! (i.e. !, EXECUTE, >A, SPAWN) which shall not use the guard page values.
 #define CHECK_DEPTH(S, d, xt)                                                 \
     if (S.depth() < d) {                                                      \
         THROW(S.name() + "-Stack underflow caused by word "                   \
@@ -66,6 +74,54 @@ namespace forth
 //! \brief Return-Stack
 #define RDEEP(d)  CHECK_DEPTH(RS, d, xt);
 
+//-----------------------------------------------------------------------------
+//! \brief Byte address (twice a token address) inside the dictionary or the
+//! heap.
+#define BYTE_ADDRESS(a)                                                       \
+    byteAddress(m_heap, reinterpret_cast<char*>(m_dictionary()), a)
+
+static inline char* byteAddress(Heap& heap, char* dictionary, Int const address)
+{
+    if (!Heap::ownsByte(address))
+        return dictionary + size_t(Token(address)) * size::token;
+
+    char* p = heap.byteAt(address, 1u);
+    if (p == nullptr)
+    {
+        THROW("Invalid heap address " + std::to_string(address));
+    }
+    return p;
+}
+
+//-----------------------------------------------------------------------------
+//! \brief Throw again the exception of a word called back by C code (see
+//! Interpreter::reenter()) once the C function has returned, or the error
+//! of callbacks refused because called from another thread.
+#define RETHROW_REENTRY_ERROR()                                               \
+    if (m_foreign_callbacks.exchange(0u) != 0u)                               \
+    {                                                                         \
+        m_reentry_error = nullptr;                                            \
+        THROW("C-CALLBACK: word called back from another thread");            \
+    }                                                                         \
+    if (m_reentry_error)                                                      \
+    {                                                                         \
+        std::exception_ptr error = m_reentry_error;                           \
+        m_reentry_error = nullptr;                                            \
+        std::rethrow_exception(error);                                        \
+    }
+
+//-----------------------------------------------------------------------------
+//! \brief Return the channel referred by the handle or throw an exception.
+static inline Channel& channel(Int const handle, char const* word)
+{
+    Channel* ch = Channel::get(handle);
+    if (ch == nullptr)
+    {
+        THROW(std::string(word) + ": invalid channel " + std::to_string(handle));
+    }
+    return *ch;
+}
+
 //-----------------------------------------------------------------------------
 //! \brief Throw an exception if the interpreter is not in compilation mode
 #define THROW_COMPILE_ONLY()                                                  \
@@ -105,7 +161,7 @@ void Interpreter::skipComment()
     m_state = State::Comment;
     while (STREAM.split())
     {
-        std::string const& word = STREAM.word();
+        std::string_view const word = STREAM.word();
         if (word == "(")
             level += 1u;
         if (word == ")")
@@ -120,6 +176,34 @@ void Interpreter::skipComment()
     THROW("Unterminated comment" /* started at cursor */);
 }
 
+//-----------------------------------------------------------------------------
+void Interpreter::executeNative(Token const xt)
+{
+    size_t const index = size_t(xt) - size_t(countPrimitives());
+    if (index >= m_natives->count.load(std::memory_order_acquire))
+    {
+        THROW("Unknown Token " + std::to_string(xt));
+    }
+
+    Native const& native = m_natives->table[index];
+    int32_t const depth = DS.depth() - native.inputs + native.outputs;
+    DDEEP(native.inputs);
+    if (depth > DS.capacity())
+    {
+        THROW(DS.name() + "-Stack overflow caused by word "
+              + m_dictionary.token2name(xt));
+    }
+
+    native.function(native.context, DS);
+
+    RETHROW_REENTRY_ERROR();
+
+    if (DS.depth() != depth)
+    {
+        THROW(m_dictionary.token2name(xt) + " does not respect its stack effect");
+    }
+}
+
 //-----------------------------------------------------------------------------
 // All primitives check their number of parameters against the depth of stacks.
 // Deviation from ANSI-Forth: An exception is thrown if the stack has less
@@ -154,7 +238,7 @@ void Interpreter::executePrimitive(Token const xt)
         CODE(SEE) // ( C: <spaces>name -- )
           THROW_IF_NO_NEXT_WORD();
           if (!m_dictionary.see(STREAM.word(), m_base))
-              THROW("Unknown word " + STREAM.word());
+              THROW("Unknown word " + std::string(STREAM.word()));
         NEXT;
 
         // ---------------------------------------------------------------------
@@ -187,7 +271,7 @@ void Interpreter::executePrimitive(Token const xt)
           THROW_IF_NO_DELIMITER("\"");
           if (m_state == State::Compile)
           {
-              if (STREAM.word().size() > size::tib)
+              if (STREAM.word().size() > size::string)
                   THROW("Max string chars reached");
               m_dictionary.append(Primitives::PSLITERAL);
               m_dictionary.append(STREAM.word(), m_dictionary.here());
@@ -196,7 +280,7 @@ void Interpreter::executePrimitive(Token const xt)
           else
           {
               std::cout << "abort interpret\n";
-              THROW(STREAM.word());
+              THROW(std::string(STREAM.word()));
           }
         NEXT;
 
@@ -265,6 +349,7 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         // Change the displayed text color of the output console.
         CODE(TERMINAL_COLOR) // ( style fg -- )
+          DDEEP(2);
           std::cout << termcolor::color(termcolor::style(DPOPI()),
                                         termcolor::fg(DPOPI()));
         NEXT;
@@ -292,9 +377,11 @@ void Interpreter::executePrimitive(Token const xt)
                       THROW("Unterminated script. Missing terminaison word");
                   }
               }
-              m_dictionary[size::dictionary - size::tib] = STREAM.word().size() + 1_z;
-              strcpy(reinterpret_cast<char*>(dictionary()() + size::dictionary - size::tib + 1_z),
-                     STREAM.word().c_str());
+              std::string_view const word = STREAM.word();
+              char* tib = reinterpret_cast<char*>(dictionary()() + size::dictionary - size::tib + 1_z);
+              m_dictionary[size::dictionary - size::tib] = word.size() + 1_z;
+              memcpy(tib, word.data(), word.size());
+              tib[word.size()] = '\0';
               DPUSHI(size::dictionary - size::tib);
           }
         NEXT;
@@ -302,10 +389,16 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         // Display the count string stored at the top to the data stack.
         // Deviation: String in SimForth has an extra '\0' char to be compatible
-        // with C and C++. Therefore the number of char is ignored (FIXME not very crash proof).
+        // with C and C++. Therefore the number of char is ignored for strings
+        // stored in the dictionary (FIXME not very crash proof).
         CODE(TYPE) // ( addr u -- )
-          DDROP();
-          std::cout << reinterpret_cast<char*>(&m_dictionary[DPOPI() + 1]) << std::flush;
+          DDEEP(2);
+          TOSi = DPOPI();
+          TOSc0 = DPOP();
+          if (StringHeap::owns(TOSc0.integer()))
+              std::cout << string(TOSc0.integer(), TOSi) << std::flush;
+          else
+              std::cout << cstring(TOSc0.integer()) << std::flush;
         NEXT;
 
         // ---------------------------------------------------------------------
@@ -318,11 +411,23 @@ void Interpreter::executePrimitive(Token const xt)
 
         // ---------------------------------------------------------------------
         //
-        CODE(EVALUATE)
+        CODE(EVALUATE) // ( addr n -- )
         {
-          DDROP(); // number of chars in the string
-          char const* script = reinterpret_cast<char const*>(&m_dictionary[DPOPI() + 1]);
-          include<StringStream>(script);
+          DDEEP(2);
+          Int const length = DPOPI();
+          Int const addr = DPOPI();
+          std::string_view script = string(addr, length);
+
+          // Interned strings and strings placed below HERE are not modified
+          // while they are interpreted: avoid the copy. Others have to be
+          // copied: the TIB is overwritten by words such as WORD and memory
+          // from HERE by the words compiled or allotted by the script.
+          Int const end = addr + 1 + (length + 1) / 2;
+          if (StringHeap::owns(addr) || ((end <= Int(m_dictionary.here())) &&
+                                         (addr < Int(size::dictionary - size::tib))))
+              include<StringStream>(script, StringStream::Mode::Borrow);
+          else
+              include<StringStream>(script, StringStream::Mode::Copy);
         }
         NEXT;
 
@@ -377,12 +482,12 @@ void Interpreter::executePrimitive(Token const xt)
         // Store a string as count string at the location of HERE. The string
         // shall by ended by the char '"' in the input stream. Throw an
         // exception if the string is not terminated when the input stream
-        // ends. Throw is the string has more than size::tib chars.
+        // ends. Throw is the string has more than size::string chars.
         //
         // Note: this word is not in the ANSI-Forth.
         CODE(STORE_STRING) // ( C: <chars>" ; -- )
            THROW_IF_NO_DELIMITER("\"");
-           if (STREAM.word().size() > size::tib)
+           if (STREAM.word().size() > size::string)
                THROW("Max string chars reached");
            m_dictionary.append(STREAM.word().size());
            m_dictionary.append(STREAM.word(), m_dictionary.here());
@@ -396,17 +501,15 @@ void Interpreter::executePrimitive(Token const xt)
           THROW_IF_NO_DELIMITER("\"");
           if (m_state == State::Compile)
           {
-              if (STREAM.word().size() > size::tib)
+              if (STREAM.word().size() > size::string)
                   THROW("Max string chars reached");
               m_dictionary.append(Primitives::PSLITERAL);
               m_dictionary.append(STREAM.word(), m_dictionary.here());
           }
           else
           {
-              Token ptr = size::dictionary - size::tib;
-              m_dictionary.append(STREAM.word(), ptr);
-              DPUSHI(size::dictionary - size::tib); // do not use ptr its value changed
-              DPUSHI(m_dictionary[size::dictionary - size::tib]);
+              // Transient string: intern it instead of using the dictionary
+              pushString(STREAM.word());
           }
         NEXT;
 
@@ -418,16 +521,14 @@ void Interpreter::executePrimitive(Token const xt)
           THROW_IF_NO_DELIMITER("\"");
           if (m_state == State::Compile)
           {
-              if (STREAM.word().size() > size::tib)
+              if (STREAM.word().size() > size::string)
                   THROW("Max string chars reached");
               m_dictionary.append(Primitives::PSLITERAL);
               m_dictionary.append(STREAM.word(), m_dictionary.here());
           }
           else
           {
-              Token ptr = size::dictionary - size::tib;
-              m_dictionary.append(STREAM.word(), ptr);
-              Int i = reinterpret_cast<Int>(&m_dictionary[size::dictionary - size::tib + 1]);
+              Int i = reinterpret_cast<Int>(cstring(m_strings.intern(STREAM.word())));
               DPUSHI(i);
           }
         NEXT;
@@ -439,7 +540,7 @@ void Interpreter::executePrimitive(Token const xt)
           THROW_IF_NO_DELIMITER("\"");
           if (m_state == State::Compile)
           {
-              if (STREAM.word().size() > size::tib)
+              if (STREAM.word().size() > size::string)
                   THROW("Max string chars reached");
               m_dictionary.append(Primitives::PSLITERAL);
               m_dictionary.append(STREAM.word(), m_dictionary.here());
@@ -470,7 +571,7 @@ void Interpreter::executePrimitive(Token const xt)
         CODE(CLIB_END) // ( -- )
           if (!m_clibs.end(/* options */))
               THROW(m_clibs.error());
-          m_clibs.saveToDictionary(m_dictionary);
+          m_clibs.saveToDictionary(*this);
         NEXT;
 
         // ---------------------------------------------------------------------
@@ -505,7 +606,48 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         // Run the C function refered by TOSc
         CODE(CLIB_EXEC) // ( -- )
+          DDEEP(1);
           m_clibs.exec(DPOPI(), DS);
+          RETHROW_REENTRY_ERROR();
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Remove the shared libraries compiled by END-C-LIB from the build
+        // cache: the next END-C-LIB calls the compiler again.
+        CODE(CLIB_CACHE_CLEAR) // ( -- )
+          CLib::clearCache();
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Bind a C function of a shared library without compiling C code:
+        // C-IMPORT name library symbol params. The new word is a primitive.
+        CODE(CLIB_IMPORT) // ( -- )
+        {
+          CImport const* import = m_clibs.import(STREAM);
+          if (import == nullptr)
+              THROW(m_clibs.error());
+          int32_t const outputs = (import->result == 0) ? 0 : 1;
+          registerPrimitive(import->forthName,
+                            { import->trampoline, import->context,
+                              int32_t(import->params.size()), outputs },
+                            nullptr);
+        }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Return a C function calling back the word xt: C-CALLBACK params.
+        // To be given to C functions expecting a function pointer.
+        CODE(CLIB_CALLBACK) // ( xt -- c-addr )
+        {
+          DDEEP(1);
+          TOSi = DPOPI();
+          if ((TOSi < 0) || (TOSi >= Int(m_dictionary.here())))
+              THROW("C-CALLBACK: invalid execution token " + std::to_string(TOSi));
+          void* function = m_clibs.callback(*this, Token(TOSi), STREAM);
+          if (function == nullptr)
+              THROW(m_clibs.error());
+          DPUSHI(Int(reinterpret_cast<intptr_t>(function)));
+        }
         NEXT;
 
         // ---------------------------------------------------------------------
@@ -515,6 +657,265 @@ void Interpreter::executePrimitive(Token const xt)
           DPUSH(Cell::integer(fork()));
         NEXT;
 
+        // ---------------------------------------------------------------------
+        // Execute xt on a worker thread with the n top elements of the data
+        // stack as its own data stack (see TaskPool).
+        CODE(SPAWN) // ( args.. n xt -- task )
+          DDEEP(2);
+          TOSt = static_cast<Token>(DPOPI());
+          TOSi = DPOPI();
+          if ((TOSi < 0) || (TOSi > DS.depth()))
+          {
+              THROW("SPAWN: invalid number of arguments " + std::to_string(TOSi));
+          }
+          {
+              std::vector<Cell> args(DS.top() - TOSi, DS.top());
+              DS.top() -= TOSi;
+              DPUSHI(tasks().spawn(TOSt, std::move(args)));
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Wait for the end of a task and push the data stack it left.
+        CODE(AWAIT) // ( task -- results.. )
+          {
+            DDEEP(1);
+              std::shared_ptr<Task> task = tasks().await(DPOPI());
+              if (task == nullptr)
+              {
+                  THROW("AWAIT: invalid task");
+              }
+              if (!task->done)
+              {
+                  THROW("AWAIT: task cancelled");
+              }
+              if (!task->error.empty())
+              {
+                  THROW("AWAIT: task failed: " + task->error);
+              }
+              if (task->results.size() > size_t(DS.capacity() - DS.depth()))
+              {
+                  THROW("AWAIT: too many results for the data stack");
+              }
+              for (auto const& it: task->results)
+                  DS.push(it);
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // dst[i] = xt(src[i]) for the n cells of src, computed by chunks on
+        // worker threads. xt ( x -- y ) shall only compute from its stack.
+        CODE(PAR_MAP) // ( src dst n xt -- )
+          DDEEP(4);
+          TOSt = static_cast<Token>(DPOPI());
+          TOSi = DPOPI();
+          {
+              Int const dst = DPOPI();
+              std::vector<Cell> const cells = fetchCells(DPOPI(), TOSi, false);
+              storeCells(dst, tasks().map(TOSt, cells), false);
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Like PAR-MAP on arrays of floats: cells are read like FLOAT@ and
+        // results are stored as floats.
+        CODE(FPAR_MAP) // ( src dst n xt -- )
+          DDEEP(4);
+          TOSt = static_cast<Token>(DPOPI());
+          TOSi = DPOPI();
+          {
+              Int const dst = DPOPI();
+              std::vector<Cell> const cells = fetchCells(DPOPI(), TOSi, true);
+              storeCells(dst, tasks().map(TOSt, cells), true);
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Fold the n cells of src with xt ( acc x -- acc' ) on worker threads.
+        // Chunks do not depend on the number of threads: xt shall be
+        // associative for getting the same result than a sequential loop.
+        CODE(PAR_REDUCE) // ( src n init xt -- result )
+          DDEEP(4);
+          TOSt = static_cast<Token>(DPOPI());
+          TOSc0 = DPOP();
+          TOSi = DPOPI();
+          {
+              std::vector<Cell> const cells = fetchCells(DPOPI(), TOSi, false);
+              DPUSH(tasks().reduce(TOSt, cells, TOSc0));
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Like PAR-REDUCE on an array of floats (cells are read like FLOAT@).
+        CODE(FPAR_REDUCE) // ( src n init xt -- result )
+          DDEEP(4);
+          TOSt = static_cast<Token>(DPOPI());
+          TOSc0 = DPOP();
+          TOSi = DPOPI();
+          {
+              std::vector<Cell> const cells = fetchCells(DPOPI(), TOSi, true);
+              DPUSH(tasks().reduce(TOSt, cells, TOSc0));
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Create an idle cooperative task having its own stacks.
+        CODE(NEW_TASK) // ( -- task )
+          DPUSHI(createTask());
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Switch to the next awake task. Tasks run on the thread of the
+        // interpreter: only the stacks and IP are exchanged.
+        CODE(PAUSE) // ( -- )
+          pauseTask();
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Sleep until another task wakes the running one.
+        CODE(STOP) // ( -- )
+          stopTask();
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        //
+        CODE(WAKE) // ( task -- )
+          DDEEP(1);
+          wakeTask(DPOPI());
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Create a channel of cells shared by all interpreters of the process.
+        CODE(CHANNEL) // ( capacity -- ch )
+          DDEEP(1);
+          TOSi = DPOPI();
+          TOSi = (TOSi <= 0) ? 0 : Channel::create(size_t(TOSi));
+          if (TOSi == 0)
+          {
+              THROW("CHANNEL: invalid capacity");
+          }
+          DPUSHI(TOSi);
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Send a cell. While the channel is full, other cooperative tasks run
+        // or the thread sleeps (see RECV).
+        CODE(SEND) // ( x ch -- )
+          DDEEP(2);
+          {
+              Channel& ch = channel(DTOS().integer(), "SEND");
+              if (ch.trySend(DPICK(1)))
+                  DS.top() -= 2;
+              else if (canRetryLater(xt))
+                  retryLater();
+              else
+              {
+                  checkDeadlock("SEND");
+                  ch.send(DPICK(1));
+                  DS.top() -= 2;
+              }
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Receive a cell. While the channel is empty, other cooperative tasks
+        // run or the thread sleeps. Outside a definition, tasks cannot run:
+        // waiting while some are awake is refused as a deadlock.
+        CODE(RECV) // ( ch -- x )
+          DDEEP(1);
+          {
+              Channel& ch = channel(DTOS().integer(), "RECV");
+              if (ch.tryRecv(TOSc0))
+                  DTOS() = TOSc0;
+              else if (canRetryLater(xt))
+                  retryLater();
+              else
+              {
+                  checkDeadlock("RECV");
+                  DTOS() = ch.recv();
+              }
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        //
+        CODE(TRY_RECV) // ( ch -- x true | false )
+          DDEEP(1);
+          if (channel(DTOS().integer(), "TRY-RECV").tryRecv(TOSc0))
+          {
+              DTOS() = TOSc0;
+              DPUSHI(-1);
+          }
+          else
+          {
+              DTOS() = Cell::integer(0);
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Send the n cells x1 first with a single wake-up of receivers.
+        CODE(SEND_N) // ( x1 .. xn n ch -- )
+          DDEEP(2);
+          {
+              Channel& ch = channel(DTOS().integer(), "SEND-N");
+              TOSi = DPICK(1).integer();
+              if ((TOSi < 0) || (TOSi > DS.depth() - 2))
+              {
+                  THROW("SEND-N: invalid number of cells " + std::to_string(TOSi));
+              }
+              Cell* cells = DS.top() - 2 - TOSi;
+              size_t const sent = ch.trySend(cells, size_t(TOSi));
+              if ((sent < size_t(TOSi)) && canRetryLater(xt))
+              {
+                  // Keep the cells not sent for the next try
+                  TOSc0 = DTOS();
+                  std::copy(cells + sent, cells + TOSi, cells);
+                  DS.top() = cells + (size_t(TOSi) - sent);
+                  DPUSHI(TOSi - Int(sent));
+                  DPUSH(TOSc0);
+                  retryLater();
+              }
+              else
+              {
+                  if (sent < size_t(TOSi))
+                      checkDeadlock("SEND-N");
+                  ch.send(cells + sent, size_t(TOSi) - sent);
+                  DS.top() = cells;
+              }
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Receive n cells, the first received being the deepest.
+        CODE(RECV_N) // ( n ch -- x1 .. xn )
+          DDEEP(2);
+          {
+              Channel& ch = channel(DTOS().integer(), "RECV-N");
+              TOSi = DPICK(1).integer();
+              if ((TOSi < 0) || (TOSi > DS.capacity() - DS.depth() + 2))
+              {
+                  THROW("RECV-N: invalid number of cells " + std::to_string(TOSi));
+              }
+              TOSc0 = DTOS();
+              Cell* cells = DS.top() - 2;
+              size_t const received = ch.tryRecv(cells, size_t(TOSi));
+              if ((received < size_t(TOSi)) && canRetryLater(xt))
+              {
+                  DS.top() = cells + received;
+                  DPUSHI(TOSi - Int(received));
+                  DPUSH(TOSc0);
+                  retryLater();
+              }
+              else
+              {
+                  if (received < size_t(TOSi))
+                      checkDeadlock("RECV-N");
+                  ch.recv(cells + received, size_t(TOSi) - received);
+                  DS.top() = cells + TOSi;
+              }
+          }
+        NEXT;
+
         // ---------------------------------------------------------------------
         //
         CODE(SELF) // ( -- pid )
@@ -526,7 +927,7 @@ void Interpreter::executePrimitive(Token const xt)
         CODE(SYSTEM)
           DDEEP(2);
           DDROP();
-          TOSi = system(reinterpret_cast<char*>(&m_dictionary[DPOPI() + 1]));
+          TOSi = system(cstring(DPOPI()));
           DPUSHI(TOSi);
         NEXT;
 
@@ -537,23 +938,36 @@ void Interpreter::executePrimitive(Token const xt)
             DDEEP(4);
 
             DDROP();
-            char* pattern = reinterpret_cast<char*>(&m_dictionary[DPOPI() + 1]);
+            std::string pattern_(cstring(DPOPI()));
+            char* pattern = &pattern_[0];
             std::cout << "Pattern: '" << pattern << "'" << std::endl;
 
             DDROP();
-            Token reg = DPOPI();
-            char* subject = reinterpret_cast<char*>(&m_dictionary[reg + 1]);
-            std::cout << "Subject: '" << subject << "'" << std::endl;
-            std::cout << "Reg: " << reg << std::endl;
+            if (StringHeap::owns(DPICK(0).integer()))
+            {
+                // Interned strings are immutable: work on a copy
+                std::string subject_(cstring(DPOPI()));
+                char* subject = &subject_[0];
+                TOSi = match(pattern, &subject);
+                pushString(subject);
+                DPUSHI(TOSi);
+            }
+            else
+            {
+                Token reg = DPOPI();
+                char* subject = reinterpret_cast<char*>(&m_dictionary[reg + 1]);
+                std::cout << "Subject: '" << subject << "'" << std::endl;
+                std::cout << "Reg: " << reg << std::endl;
 
-            TOSi = match(pattern, &subject);
-            m_dictionary[reg] = strlen(subject);
-            std::cout << "Res: '" << subject << "'  s:" << m_dictionary[reg] << std::endl;
+                TOSi = match(pattern, &subject);
+                m_dictionary[reg] = strlen(subject);
+                std::cout << "Res: '" << subject << "'  s:" << m_dictionary[reg] << std::endl;
 
 
-            DPUSHI(reg);
-            DPUSHI(m_dictionary[reg]);
-            DPUSHI(TOSi);
+                DPUSHI(reg);
+                DPUSHI(m_dictionary[reg]);
+                DPUSHI(TOSi);
+            }
         }
         NEXT;
 
@@ -564,22 +978,35 @@ void Interpreter::executePrimitive(Token const xt)
             DDEEP(4);
 
             DDROP();
-            char* pattern = reinterpret_cast<char*>(&m_dictionary[DPOPI() + 1]);
+            std::string pattern_(cstring(DPOPI()));
+            char* pattern = &pattern_[0];
             std::cout << "Pattern: '" << pattern << "'" << std::endl;
 
             DDROP();
-            Token reg = DPOPI();
-            char* subject = reinterpret_cast<char*>(&m_dictionary[reg + 1]);
-            std::cout << "Subject: '" << subject << "'" << std::endl;
-            std::cout << "Reg: " << reg << std::endl;
-
-            TOSi = split(pattern, &subject);
-            m_dictionary[reg] = strlen(subject);
-            std::cout << "Res: '" << subject << "'  s:" << m_dictionary[reg] << std::endl;
-
-            DPUSHI(reg);
-            DPUSHI(m_dictionary[reg]);
-            DPUSHI(TOSi);
+            if (StringHeap::owns(DPICK(0).integer()))
+            {
+                // Interned strings are immutable: work on a copy
+                std::string subject_(cstring(DPOPI()));
+                char* subject = &subject_[0];
+                TOSi = split(pattern, &subject);
+                pushString(subject);
+                DPUSHI(TOSi);
+            }
+            else
+            {
+                Token reg = DPOPI();
+                char* subject = reinterpret_cast<char*>(&m_dictionary[reg + 1]);
+                std::cout << "Subject: '" << subject << "'" << std::endl;
+                std::cout << "Reg: " << reg << std::endl;
+
+                TOSi = split(pattern, &subject);
+                m_dictionary[reg] = strlen(subject);
+                std::cout << "Res: '" << subject << "'  s:" << m_dictionary[reg] << std::endl;
+
+                DPUSHI(reg);
+                DPUSHI(m_dictionary[reg]);
+                DPUSHI(TOSi);
+            }
         }
         NEXT;
 
@@ -592,12 +1019,20 @@ void Interpreter::executePrimitive(Token const xt)
         // restored at the end of the file.
         CODE(INCLUDE) // ( C: file name -- )
           THROW_IF_NO_NEXT_WORD();
-          include<FileStream>(STREAM.word());
+          {
+              std::string const filename(STREAM.word());
+              if (m_options.pipeline)
+                  include<PipelinedFileStream>(filename.c_str());
+              else
+                  include<MappedFileStream>(filename.c_str());
+          }
         NEXT;
 
         // ---------------------------------------------------------------------
         // Branch IP to the relative address stored in the next token.
         CODE(BRANCH) // ( -- )
+          if (int16_t(m_dictionary[IP + 1u]) < 0)
+              tick();
           IP += m_dictionary[IP + 1u];
           if (m_options.traces)
           {
@@ -614,6 +1049,9 @@ void Interpreter::executePrimitive(Token const xt)
         // only if the top value in the data stack is 0. This value is eaten.
         CODE(ZERO_BRANCH) // ( false -- )
           DDEEP(1);
+          // Before eating the flag: a suspended slice executes again this word
+          if ((DTOS().integer() == 0) && (int16_t(m_dictionary[IP + 1u]) < 0))
+              tick();
           IP += ((DPOPI() == 0) ? m_dictionary[IP + 1u] : 1u);
           if (m_options.traces)
           {
@@ -702,7 +1140,7 @@ void Interpreter::executePrimitive(Token const xt)
                 std::cout << "Looking for " << STREAM.word() << std::endl;
             }
             Token nfa;
-            int res = m_dictionary.find(toUpper(STREAM.word()), nfa);
+            int res = m_dictionary.find(STREAM.word(), nfa);
             DPUSHI(nfa);
             DPUSHI(res);
         }
@@ -715,9 +1153,21 @@ void Interpreter::executePrimitive(Token const xt)
           TOSc0 = DPOP(); // value
           TOSc1 = DPOP(); // nb bytes
           TOSc2 = DPOP(); // source
-          m_dictionary.fill(TOSc2.integer(),
-                          TOSc1.integer(),
-                          TOSc0.integer());
+          if (Heap::owns(TOSc2.integer()))
+          {
+              if (TOSc1.integer() < 0)
+              {
+                  THROW("Invalid heap address " + std::to_string(TOSc2.integer()));
+              }
+              std::memset(memory(TOSc2.integer(), (TOSc1.integer() + 1) / 2),
+                          int(TOSc0.integer()), size_t(TOSc1.integer()));
+          }
+          else
+          {
+              m_dictionary.fill(TOSc2.integer(),
+                                TOSc1.integer(),
+                                TOSc0.integer());
+          }
         NEXT;
 
         // ---------------------------------------------------------------------
@@ -728,9 +1178,19 @@ void Interpreter::executePrimitive(Token const xt)
           TOSc0 = DPOP(); // nb bytes
           TOSc1 = DPOP(); // destination
           TOSc2 = DPOP(); // source
-          m_dictionary.move(TOSc2.integer(),
-                          TOSc1.integer(),
-                          TOSc0.integer());
+          if (Heap::owns(TOSc2.integer()) || Heap::owns(TOSc1.integer()))
+          {
+              TOSi = TOSc0.integer();
+              std::memmove(memory(TOSc1.integer(), TOSi),
+                           memory(TOSc2.integer(), TOSi),
+                           size_t(TOSi) * size::token);
+          }
+          else
+          {
+              m_dictionary.move(TOSc2.integer(),
+                                TOSc1.integer(),
+                                TOSc0.integer());
+          }
         NEXT;
 
         // ---------------------------------------------------------------------
@@ -738,7 +1198,7 @@ void Interpreter::executePrimitive(Token const xt)
         CODE(BYTE_FETCH) // ( 2*addr -- x )
         {
           DDEEP(1);
-          char* ptr = reinterpret_cast<char*>(dictionary()() + DPOPT());
+          char* ptr = BYTE_ADDRESS(DPOPI());
           DPUSHI(*ptr);
         }
         NEXT;
@@ -748,7 +1208,7 @@ void Interpreter::executePrimitive(Token const xt)
         CODE(BYTE_STORE) // ( x addr -- )
         {
           DDEEP(2);
-          char* ptr = reinterpret_cast<char*>(dictionary()() + DPOPT());
+          char* ptr = BYTE_ADDRESS(DPOPI());
           *ptr = char(DPOPI());
         }
         NEXT;
@@ -763,8 +1223,8 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         // x is the value stored at addr.
         CODE(TOKEN_FETCH) // ( addr -- x )
-          DDEEP(1);
-          DPUSHI(m_dictionary.fetch<Token>(DPOPT()));
+          TOSi = DPOPI();
+          DPUSHI(*memory(TOSi, 1));
         NEXT;
 
         // ---------------------------------------------------------------------
@@ -772,7 +1232,7 @@ void Interpreter::executePrimitive(Token const xt)
         CODE(TOKEN_STORE) // ( x addr -- )
           DDEEP(2);
           TOSi = DPOPI(); // addr
-          m_dictionary[Token(TOSi)] = DPOPT();
+          *memory(TOSi, 1) = DPOPT();
         NEXT;
 
 
@@ -793,15 +1253,31 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         // x is the floating point value stored at addr.
         CODE(FLOAT_FETCH) // ( addr -- r )
-          DDEEP(1);
-          DPUSH(Cell::real(m_dictionary.fetch<Real>(DPOPT())));
+          TOSi = DPOPI();
+          if (Heap::owns(TOSi))
+          {
+              std::memcpy(&TOSr, memory(TOSi, size::cell / size::token), sizeof(Real));
+              DPUSHR(TOSr);
+          }
+          else
+          {
+              DPUSH(Cell::real(m_dictionary.fetch<Real>(Token(TOSi))));
+          }
         NEXT;
 
         // ---------------------------------------------------------------------
         // x is the value stored at addr.
         CODE(CELL_FETCH) // ( addr -- x )
-          DDEEP(1);
-          DPUSHI(m_dictionary.fetch<Int>(DPOPT()));
+          TOSi = DPOPI();
+          if (Heap::owns(TOSi))
+          {
+              std::memcpy(&TOSi, memory(TOSi, size::cell / size::token), sizeof(Int));
+              DPUSHI(TOSi);
+          }
+          else
+          {
+              DPUSHI(m_dictionary.fetch<Int>(Token(TOSi)));
+          }
         NEXT;
 
         // ---------------------------------------------------------------------
@@ -810,7 +1286,185 @@ void Interpreter::executePrimitive(Token const xt)
         CODE(CELL_STORE) // ( x addr -- )
           DDEEP(2);
           TOSi = DPOPI(); // addr
-          m_dictionary.store(Token(TOSi), DPOP());
+          if (Heap::owns(TOSi))
+          {
+              Token* ptr = memory(TOSi, size::cell / size::token);
+              TOSc0 = DPOP();
+              if (TOSc0.isInteger())
+              {
+                  Int i = TOSc0.integer();
+                  std::memcpy(ptr, &i, sizeof(Int));
+              }
+              else
+              {
+                  Real r = TOSc0.real();
+                  std::memcpy(ptr, &r, sizeof(Real));
+              }
+          }
+          else
+          {
+              m_dictionary.store(Token(TOSi), DPOP());
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Allocate u tokens in the heap. ior is 0 on success.
+        CODE(ALLOCATE) // ( u -- addr ior )
+          DDEEP(1);
+          TOSi = DPOPI();
+          TOSi = ((TOSi < 0) || (size_t(TOSi) > SIZE_MAX / size::token))
+                 ? 0 : m_heap.allocate(size_t(TOSi) * size::token);
+          DPUSHI(TOSi);
+          DPUSHI((TOSi == 0) ? -1 : 0);
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Release a memory block given by ALLOCATE or RESIZE. ior is 0 on
+        // success.
+        CODE(FREE) // ( addr -- ior )
+          DDEEP(1);
+          DPUSHI(m_heap.free(DPOPI()) ? 0 : -1);
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Change the size of a memory block to u tokens. Its content is
+        // preserved. On failure, addr1 is left unchanged and ior is not 0.
+        CODE(RESIZE) // ( addr1 u -- addr2 ior )
+          DDEEP(2);
+          TOSi = DPOPI();
+          TOSc0 = DPOP();
+          TOSi = ((TOSi < 0) || (size_t(TOSi) > SIZE_MAX / size::token))
+                 ? 0 : m_heap.resize(TOSc0.integer(), size_t(TOSi) * size::token);
+          if (TOSi == 0)
+          {
+              DPUSH(TOSc0);
+              DPUSHI(-1);
+          }
+          else
+          {
+              DPUSHI(TOSi);
+              DPUSHI(0);
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Save the state of the interpreter (see Interpreter::checkpoint()).
+        // The identifier is pushed before saving: after a ROLLBACK it is
+        // still on the top of the data stack.
+        CODE(CHECKPOINT) // ( -- id )
+          DPUSHI(Int(m_snapshots.size()));
+          checkpoint();
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Restore the state saved by CHECKPOINT. This is done when the
+        // outermost word being executed returns.
+        CODE(ROLLBACK) // ( id -- )
+          DDEEP(1);
+          TOSi = DPOPI();
+          if ((TOSi < 0) || (size_t(TOSi) >= m_snapshots.size()))
+          {
+              THROW("Invalid checkpoint " + std::to_string(TOSi));
+          }
+          m_rollback = TOSi;
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Compare two strings. n is 0 if they are identical, -1 if the first
+        // string is lower than the second, else 1. Interned strings having the
+        // same handle are compared in O(1).
+        CODE(COMPARE) // ( addr1 u1 addr2 u2 -- n )
+          TOSc1 = DPOP(); // u2
+          TOSc0 = DPOP(); // addr2
+          TOSc3 = DPOP(); // u1
+          TOSc2 = DPOP(); // addr1
+          if ((TOSc0.integer() == TOSc2.integer()) &&
+              (TOSc1.integer() == TOSc3.integer()))
+          {
+              DPUSHI(0);
+          }
+          else
+          {
+              TOSi = string(TOSc2.integer(), TOSc3.integer()).compare(
+                  string(TOSc0.integer(), TOSc1.integer()));
+              DPUSHI((TOSi < 0) ? -1 : ((TOSi > 0) ? 1 : 0));
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Search the string 2 inside the string 1. If found, flag is true and
+        // addr3 u3 is the part of the string 1 starting with the string 2 else
+        // flag is false and addr3 u3 is the string 1.
+        CODE(SEARCH) // ( addr1 u1 addr2 u2 -- addr3 u3 flag )
+          {
+              TOSc1 = DPOP(); // u2
+              TOSc0 = DPOP(); // addr2
+              TOSc3 = DPOP(); // u1
+              TOSc2 = DPOP(); // addr1
+              std::string_view const s = string(TOSc2.integer(), TOSc3.integer());
+              size_t const pos = s.find(string(TOSc0.integer(), TOSc1.integer()));
+              if (pos == std::string_view::npos)
+              {
+                  DPUSH(TOSc2);
+                  DPUSH(TOSc3);
+                  DPUSHI(0);
+              }
+              else if (pos == 0u)
+              {
+                  DPUSH(TOSc2);
+                  DPUSH(TOSc3);
+                  DPUSHI(-1);
+              }
+              else
+              {
+                  pushString(s.substr(pos));
+                  DPUSHI(-1);
+              }
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Concatenate two strings into a new interned string.
+        // Note: this word is not in the ANSI-Forth.
+        CODE(STRING_CONCAT) // ( addr1 u1 addr2 u2 -- addr3 u3 )
+          {
+              TOSc1 = DPOP(); // u2
+              TOSc0 = DPOP(); // addr2
+              TOSc3 = DPOP(); // u1
+              TOSc2 = DPOP(); // addr1
+              std::string_view const s1 = string(TOSc2.integer(), TOSc3.integer());
+              std::string_view const s2 = string(TOSc0.integer(), TOSc1.integer());
+              std::string s;
+              s.reserve(s1.size() + s2.size());
+              s.append(s1).append(s2);
+              pushString(s);
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Extract at most n chars starting at the given position. Out of range
+        // positions and lengths are clamped.
+        // Note: this word is not in the ANSI-Forth.
+        CODE(SUBSTRING) // ( addr u pos n -- addr2 u2 )
+          {
+              TOSi = DPOPI(); // n
+              Int const pos = DPOPI();
+              TOSc3 = DPOP(); // u
+              std::string_view const s = string(DPOPI(), TOSc3.integer());
+              size_t const from = size_t(std::clamp(pos, Int(0), Int(s.size())));
+              pushString(s.substr(from, size_t(std::max(TOSi, Int(0)))));
+          }
+        NEXT;
+
+        // ---------------------------------------------------------------------
+        // Remove the n first chars of the string.
+        CODE(SLASH_STRING) // ( addr u n -- addr2 u2 )
+          {
+              TOSi = DPOPI(); // n
+              TOSc3 = DPOP(); // u
+              std::string_view const s = string(DPOPI(), TOSc3.integer());
+              pushString(s.substr(size_t(std::clamp(TOSi, Int(0), Int(s.size())))));
+          }
         NEXT;
 
         // ---------------------------------------------------------------------
@@ -879,6 +1533,14 @@ void Interpreter::executePrimitive(Token const xt)
           m_state = State::Interprete;
         NEXT;
 
+        // ---------------------------------------------------------------------
+        // Start the task on the rest of the current definition, then return
+        // from the definition like EXIT.
+        CODE(ACTIVATE) // ( task -- )
+          DDEEP(1);
+          activateTask(DPOPI());
+          [[fallthrough]];
+
         // ---------------------------------------------------------------------
         // Restore the IP when interpreting the definition of a non primitive word
         //TODO THROW_COMPILE_ONLY();
@@ -886,6 +1548,9 @@ void Interpreter::executePrimitive(Token const xt)
         CODE(RETURN) // FIXME to avoid complex logic when displaying the dictionary
           RDEEP(1);
           IP = RPOP();
+          // A task returning from the definition which activated it ends
+          if ((RS.depth() == 0) && (m_task != 0u))
+              endTask();
           if (m_options.traces)
           {
               indent();
@@ -1024,7 +1689,6 @@ void Interpreter::executePrimitive(Token const xt)
         CODE(HIDE)
           {
               THROW_IF_NO_NEXT_WORD();
-              toUpper(STREAM.word());
               if (!m_dictionary.smudge(STREAM.word()))
               {
                   std::cerr << FORTH_WARNING_COLOR
@@ -1199,7 +1863,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(EQ_ZERO)
-          DDEEP(1);
           TOSi = DTOS().integer();
           DTOS() = Cell::integer((TOSi == 0) ? -1 : 0);
         NEXT;
@@ -1207,7 +1870,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(NE_ZERO)
-          DDEEP(1);
           TOSi = DTOS().integer();
           DTOS() = Cell::integer((TOSi != 0) ? -1 : 0);
         NEXT;
@@ -1215,7 +1877,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(GREATER_ZERO)
-          DDEEP(1);
           TOSi = DTOS().integer();
           DTOS() = Cell::integer((TOSi > 0) ? -1 : 0);
         NEXT;
@@ -1223,7 +1884,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(LOWER_ZERO)
-          DDEEP(1);
           TOSi = DTOS().integer();
           DTOS() = Cell::integer((TOSi < 0) ? -1 : 0);
         NEXT;
@@ -1231,84 +1891,72 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(FLOOR)
-          DDEEP(1);
           DPUSHR(::floor(DPOPR()));
         NEXT;
 
         // ---------------------------------------------------------------------
         //
         CODE(ROUND)
-          DDEEP(1);
           DPUSHR(::round(DPOPR()));
         NEXT;
 
         // ---------------------------------------------------------------------
         //
         CODE(CEIL)
-          DDEEP(1);
           DPUSHR(::ceil(DPOPR()));
         NEXT;
 
         // ---------------------------------------------------------------------
         //
         CODE(SQRT)
-          DDEEP(1);
           DPUSHR(::sqrt(DPOPR()));
         NEXT;
 
         // ---------------------------------------------------------------------
         //
         CODE(EXP)
-          DDEEP(1);
           DPUSHR(::exp(DPOPR()));
         NEXT;
 
         // ---------------------------------------------------------------------
         //
         CODE(LN)
-          DDEEP(1);
           DPUSHR(::log(DPOPR()));
         NEXT;
 
         // ---------------------------------------------------------------------
         //
         CODE(LOG)
-          DDEEP(1);
           DPUSHR(::log10(DPOPR()));
         NEXT;
 
         // ---------------------------------------------------------------------
         //
         CODE(ASIN)
-          DDEEP(1);
           DPUSHR(::asin(DPOPR()));
         NEXT;
 
         // ---------------------------------------------------------------------
         //
         CODE(SIN)
-          DDEEP(1);
           DPUSHR(::sin(DPOPR()));
         NEXT;
 
         // ---------------------------------------------------------------------
         //
         CODE(ACOS)
-          DDEEP(1);
           DPUSHR(::acos(DPOPR()));
         NEXT;
 
         // ---------------------------------------------------------------------
         //
         CODE(COS)
-          DDEEP(1);
           DPUSHR(::cos(DPOPR()));
         NEXT;
 
         // ---------------------------------------------------------------------
         //
         CODE(ATAN)
-          DDEEP(2);
           TOSr = DPOPR();
           DPUSHR(::atan2(DPOPR(), TOSr));
         NEXT;
@@ -1316,7 +1964,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(TAN)
-          DDEEP(1);
           DPUSHR(::tan(DPOPR()));
         NEXT;
 
@@ -1341,21 +1988,18 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         // Decrement
         CODE(MINUS_ONE)
-          DDEEP(1);
           --DTOS();
         NEXT;
 
        // ---------------------------------------------------------------------
         // Increment
         CODE(PLUS_ONE)
-          DDEEP(1);
           ++DTOS();
         NEXT;
 
         // ---------------------------------------------------------------------
         //
         CODE(LSHIFT)
-          DDEEP(2);
           TOSi = DPOPI();
           DPUSHI(DPOPI() << TOSi);
         NEXT;
@@ -1363,7 +2007,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(RSHIFT)
-          DDEEP(2);
           TOSi = DPOPI();
           DPUSHI(DPOPI() >> TOSi);
         NEXT;
@@ -1371,49 +2014,42 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         // Binary exclusive or
         CODE(XOR)
-          DDEEP(2);
           DTOS() ^= DPOP();
         NEXT;
 
         // ---------------------------------------------------------------------
         // Binary inclusive or
         CODE(OR)
-          DDEEP(2);
           DTOS() |= DPOP();
         NEXT;
 
         // ---------------------------------------------------------------------
         // Binary and
         CODE(AND)
-          DDEEP(2);
           DTOS() &= DPOP();
         NEXT;
 
         // ---------------------------------------------------------------------
         // Addition
         CODE(ADD)
-          DDEEP(2);
           DTOS() += DPOP();
         NEXT;
 
         // ---------------------------------------------------------------------
         // Substraction
         CODE(MINUS)
-          DDEEP(2);
           DTOS() -= DPOP();
         NEXT;
 
         // ---------------------------------------------------------------------
         // Multiplication
         CODE(TIMES)
-          DDEEP(2);
           DTOS() *= DPOP();
         NEXT;
 
         // ---------------------------------------------------------------------
         // Division
         CODE(DIVIDE)
-          DDEEP(2);
           if (DTOS().integer() == 0)
               THROW("Division by zero");
           DTOS() /= DPOP();
@@ -1422,7 +2058,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(GREATER)
-          DDEEP(2);
           TOSc0 = DPOP();
           DTOS() = Cell::integer((DTOS() > TOSc0) ? -1 : 0);
         NEXT;
@@ -1430,7 +2065,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(GREATER_EQUAL)
-          DDEEP(2);
           TOSc0 = DPOP();
           DTOS() = Cell::integer((DTOS() >= TOSc0) ? -1 : 0);
         NEXT;
@@ -1438,7 +2072,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(LOWER)
-          DDEEP(2);
           TOSc0 = DPOP();
           DTOS() = Cell::integer((DTOS() < TOSc0) ? -1 : 0);
         NEXT;
@@ -1446,7 +2079,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(LOWER_EQUAL)
-          DDEEP(2);
           TOSc0 = DPOP();
           DTOS() = Cell::integer((DTOS() <= TOSc0) ? -1 : 0);
         NEXT;
@@ -1454,7 +2086,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(EQUAL)
-          DDEEP(2);
           TOSc0 = DPOP();
           DTOS() = Cell::integer((DTOS() == TOSc0) ? -1 : 0);
         NEXT;
@@ -1462,7 +2093,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(NOT_EQUAL)
-          DDEEP(2);
           TOSc0 = DPOP();
           DTOS() = Cell::integer((DTOS() != TOSc0) ? -1 : 0);
         NEXT;
@@ -1470,7 +2100,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         // ( a b c d -- c d a b )
         CODE(TWO_SWAP)
-          DDEEP(4);
           TOSc0 = DPOP();
           TOSc1 = DPOP();
           TOSc2 = DPOP();
@@ -1484,7 +2113,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         // ( a b c d -- a b c d a b )
         CODE(TWO_OVER)
-          DDEEP(4);
           TOSc0 = DPICK(2);
           TOSc1 = DPICK(3);
           DPUSH(TOSc1);
@@ -1503,7 +2131,6 @@ void Interpreter::executePrimitive(Token const xt)
         // Duplicate the two top elements of the data stack
         // 2DUP = OVER OVER
         CODE(TWO_DUP)
-          DDEEP(2);
           TOSc0 = DTOS();
           TOSc1 = DPICK(1);
           DPUSH(TOSc1);
@@ -1514,7 +2141,6 @@ void Interpreter::executePrimitive(Token const xt)
         // NIP = SWAP DROP
         // ( a b -- b )
         CODE(NIP)
-          DDEEP(2);
           TOSc0 = DPOP();
           TOSc1 = DPOP();
           DPUSH(TOSc0);
@@ -1554,7 +2180,6 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         // ( a b -- b a )
         CODE(SWAP)
-          DDEEP(2);
           TOSc0 = DPOP();
           TOSc2 = DPOP();
           DPUSH(TOSc0);
@@ -1564,14 +2189,12 @@ void Interpreter::executePrimitive(Token const xt)
         // ---------------------------------------------------------------------
         //
         CODE(OVER)
-          DDEEP(1);
           DPUSH(DPICK(1));
         NEXT;
 
         // ---------------------------------------------------------------------
         // ( a b c -- b c a )
         CODE(ROT)
-          DDEEP(3);
           TOSc0 = DPOP();
           TOSc2 = DPOP();
           TOSc3 = DPOP();
@@ -1591,7 +2214,6 @@ void Interpreter::executePrimitive(Token const xt)
         // Duplicate the top element of the data stack
         // ( a -- a a )
         CODE(DUP)
-          DDEEP(1);
           DDUP();
         NEXT;
 
@@ -1599,7 +2221,6 @@ void Interpreter::executePrimitive(Token const xt)
         // Duplicate the top element of the data stack if it is non-zero.
         // ( x -- 0 | x x )
         CODE(QDUP)
-          DDEEP(1);
           if (DTOS().integer() != 0) { DDUP(); }
         NEXT;
 
@@ -1635,9 +2256,12 @@ void Interpreter::executePrimitive(Token const xt)
         NEXT;
 
         // ---------------------------------------------------------------------
+        // ---------------------------------------------------------------------
+        // Tokens following primitives are C++ functions registered by the
+        // host.
         CODE(MAX_PRIMITIVES_)
         UNKNOWN
-          THROW("Unknown Token " + std::to_string(xt));
+          executeNative(xt);
         NEXT;
     }
 }
@@ -61,11 +61,17 @@ namespace forth
 
        // Interfaces with C libraries
        TO_C_PTR, CLIB_BEGIN, CLIB_END, CLIB_ADD_LIB, CLIB_PKG_CONFIG, CLIB_C_FUN,
-       CLIB_C_CODE, CLIB_EXEC,
+       CLIB_C_CODE, CLIB_EXEC, CLIB_CACHE_CLEAR, CLIB_IMPORT, CLIB_CALLBACK,
 
        //
        FORK, SELF, SYSTEM, MATCH, SPLIT,
 
+       // Tasks
+       SPAWN, AWAIT, PAR_MAP, PAR_REDUCE, FPAR_MAP, FPAR_REDUCE, NEW_TASK, ACTIVATE, PAUSE, STOP, WAKE,
+
+       // Channels
+       CHANNEL, SEND, RECV, TRY_RECV, SEND_N, RECV_N,
+
        // Branching
        INCLUDE, BRANCH, ZERO_BRANCH, QI, I, QJ, J,
 
@@ -82,6 +88,15 @@ namespace forth
        BYTE_FETCH, BYTE_STORE,
        TOKEN_COMMA, TOKEN_FETCH, TOKEN_STORE,
        CELL_COMMA, ALLOT, FLOAT_FETCH, CELL_FETCH, CELL_STORE,
+
+       // Dynamic memory
+       ALLOCATE, FREE, RESIZE,
+
+       // Checkpoints
+       CHECKPOINT, ROLLBACK,
+
+       // Strings
+       COMPARE, SEARCH, STRING_CONCAT, SUBSTRING, SLASH_STRING,
        //PLUS_STORE,
 
        // Auxiliary stack manipulation
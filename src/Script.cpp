@@ -0,0 +1,116 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+
+#include "Script.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace forth
+{
+
+//------------------------------------------------------------------------------
+Script::Script(Interpreter& forth, std::string const& source)
+    : m_forth(&forth), m_source(source)
+{
+    compile();
+}
+
+//------------------------------------------------------------------------------
+Token Script::resolve(std::string const& word) const
+{
+    Token xt;
+    bool immediate;
+
+    if (!m_forth->dictionary().findWord(word, xt, immediate))
+        return NO_WORD;
+    return xt;
+}
+
+//------------------------------------------------------------------------------
+void Script::compile()
+{
+    Dictionary& dictionary = m_forth->dictionary();
+
+    // Nothing has been compiled after the previous definition: it is
+    // replaced instead of being left unused in the dictionary.
+    if ((m_compilations != 0u) && (dictionary.last() == m_last) &&
+        (size_t(dictionary.here()) == size_t(m_xt) + m_code.size()) &&
+        std::equal(m_code.begin(), m_code.end(), &dictionary[m_xt]))
+    {
+        dictionary.rewind(m_before.first, m_before.second);
+    }
+
+    std::pair<Token, Token> const before(dictionary.here(), dictionary.last());
+    m_xt = m_forth->compile(m_source);
+    m_before = before;
+    m_last = dictionary.last();
+    ++m_compilations;
+
+    // Words inside comments and strings are also recorded: they only cause
+    // useless compilations.
+    m_references.clear();
+    std::istringstream stream(m_source);
+    std::string word;
+    while (stream >> word)
+    {
+        m_references.emplace_back(word, resolve(word));
+    }
+
+    m_code.assign(&dictionary[m_xt], &dictionary[m_xt] + (dictionary.here() - m_xt));
+    m_generation = dictionary.generation();
+}
+
+//------------------------------------------------------------------------------
+bool Script::outdated() const
+{
+    Dictionary const& dictionary = m_forth->dictionary();
+
+    if (size_t(dictionary.here()) < size_t(m_xt) + m_code.size())
+        return true;
+
+    if (!std::equal(m_code.begin(), m_code.end(), &dictionary[m_xt]))
+        return true;
+
+    for (auto const& it: m_references)
+    {
+        if (resolve(it.first) != it.second)
+            return true;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void Script::run()
+{
+    // Cheap check for the usual case: no word created or removed.
+    if (m_generation != m_forth->dictionary().generation())
+    {
+        if (outdated())
+        {
+            compile();
+        }
+        m_generation = m_forth->dictionary().generation();
+    }
+
+    m_forth->call(m_xt);
+}
+
+} // namespace forth
@@ -0,0 +1,135 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+
+#ifndef INTERNAL_FORTH_SCRIPT_HPP
+#  define INTERNAL_FORTH_SCRIPT_HPP
+
+#  include "Interpreter.hpp"
+#  include <string>
+#  include <utility>
+#  include <vector>
+
+namespace forth
+{
+
+//******************************************************************************
+//! \brief Forth script parsed once and executed many times (see
+//! SimForth::compile()). The script is compiled into an anonymous definition:
+//! run() calls it directly, without tokenizing nor searching words again.
+//!
+//! Each time the dictionary has changed since the last run() (see
+//! Dictionary::generation()), the script checks that its definition is still
+//! in the dictionary and that the words it refers to still resolve to the
+//! same definitions. Otherwise it is compiled again: redefining a word or
+//! rolling back the interpreter does not leave a dangling script.
+//!
+//! Example:
+//! \code
+//! forth::Script area = forth.compile("WIDTH @ HEIGHT @ *");
+//! area.run();
+//! \endcode
+//!
+//! \note Like a definition, the script shall only use words allowed in
+//! compilation mode.
+//******************************************************************************
+class Script
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //! \brief Compile the script.
+    //! \throw forth::Exception if the script does not compile.
+    //--------------------------------------------------------------------------
+    Script(Interpreter& forth, std::string const& source);
+
+    //--------------------------------------------------------------------------
+    //! \brief Execute the script. Results are left on the data stack.
+    //! \throw forth::Exception on Forth errors or if the script has to be
+    //! compiled again and no longer compiles. The interpreter is then aborted
+    //! (see Interpreter::call()).
+    //--------------------------------------------------------------------------
+    void run();
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the execution token of the compiled script.
+    //--------------------------------------------------------------------------
+    inline Token xt() const
+    {
+        return m_xt;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the Forth source of the script.
+    //--------------------------------------------------------------------------
+    inline std::string const& source() const
+    {
+        return m_source;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return how many times the script has been compiled.
+    //--------------------------------------------------------------------------
+    inline size_t compilations() const
+    {
+        return m_compilations;
+    }
+
+private:
+
+    //--------------------------------------------------------------------------
+    //! \brief Compile the source and remember what it depends on. The
+    //! previous definition is removed if it is still the last one.
+    //--------------------------------------------------------------------------
+    void compile();
+
+    //--------------------------------------------------------------------------
+    //! \brief Return true if the dictionary no longer holds the code compiled
+    //! by the last compile() or if a word of the script has been redefined.
+    //--------------------------------------------------------------------------
+    bool outdated() const;
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the execution token of the word or NO_WORD.
+    //--------------------------------------------------------------------------
+    Token resolve(std::string const& word) const;
+
+    static constexpr Token NO_WORD = Token(~0u);
+
+    Interpreter* m_forth;
+    std::string m_source;
+    Token m_xt = 0u;
+    size_t m_compilations = 0u;
+    //! \brief Generation of the dictionary checked by the last run().
+    uint32_t m_generation = 0u;
+    //! \brief Words of the source with their execution token (or NO_WORD
+    //! for numbers and words not yet defined).
+    std::vector<std::pair<std::string, Token>> m_references;
+    //! \brief Copy of the byte code of the anonymous definition.
+    std::vector<Token> m_code;
+    //! \brief HERE and LAST before the anonymous definition, and LAST after
+    //! it: the definition can be replaced while it is the last one.
+    std::pair<Token, Token> m_before;
+    Token m_last = 0u;
+};
+
+} // namespace forth
+
+#endif // INTERNAL_FORTH_SCRIPT_HPP
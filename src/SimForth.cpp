@@ -110,6 +110,60 @@ bool SimForth::interactive()
     return m_interpreter->interactive();
 }
 
+//------------------------------------------------------------------------------
+void SimForth::setWorkers(size_t const count)
+{
+    m_interpreter->setWorkers(count);
+}
+
+//------------------------------------------------------------------------------
+forth::SharedDictionary SimForth::freeze() const
+{
+    return m_dictionary->freeze();
+}
+
+//------------------------------------------------------------------------------
+size_t SimForth::checkpoint()
+{
+    return m_interpreter->checkpoint();
+}
+
+//------------------------------------------------------------------------------
+bool SimForth::rollback(size_t const id)
+{
+    return m_interpreter->rollback(id);
+}
+
+//------------------------------------------------------------------------------
+bool SimForth::start(char const* script)
+{
+    return m_interpreter->start(script);
+}
+
+//------------------------------------------------------------------------------
+forth::Status SimForth::run(size_t const steps)
+{
+    return m_interpreter->run(steps);
+}
+
+//------------------------------------------------------------------------------
+forth::Status SimForth::status() const
+{
+    return m_interpreter->status();
+}
+
+//------------------------------------------------------------------------------
+forth::Int SimForth::createChannel(size_t const capacity)
+{
+    return forth::Channel::create(capacity);
+}
+
+//------------------------------------------------------------------------------
+forth::Channel* SimForth::channel(forth::Int const handle)
+{
+    return forth::Channel::get(handle);
+}
+
 //------------------------------------------------------------------------------
 forth::DataStack& SimForth::dataStack()
 {
@@ -201,10 +255,30 @@ void SimForth::bootCore()
     PRIMITIVE(CLIB_C_FUN, "C-FUNCTION");
     PRIMITIVE(CLIB_C_CODE, "\\C");
     HIDDEN(CLIB_EXEC, "(EXEC-C)");
+    PRIMITIVE(CLIB_CACHE_CLEAR, "C-LIB-CACHE-CLEAR");
+    PRIMITIVE(CLIB_IMPORT, "C-IMPORT");
+    PRIMITIVE(CLIB_CALLBACK, "C-CALLBACK");
 
     // Processus
     PRIMITIVE(FORK, "FORK");
     PRIMITIVE(SELF, "SELF");
+    PRIMITIVE(SPAWN, "SPAWN");
+    PRIMITIVE(AWAIT, "AWAIT");
+    PRIMITIVE(PAR_MAP, "PAR-MAP");
+    PRIMITIVE(PAR_REDUCE, "PAR-REDUCE");
+    PRIMITIVE(FPAR_MAP, "FPAR-MAP");
+    PRIMITIVE(FPAR_REDUCE, "FPAR-REDUCE");
+    PRIMITIVE(NEW_TASK, "NEW-TASK");
+    PRIMITIVE(ACTIVATE, "ACTIVATE");
+    PRIMITIVE(PAUSE, "PAUSE");
+    PRIMITIVE(STOP, "STOP");
+    PRIMITIVE(WAKE, "WAKE");
+    PRIMITIVE(CHANNEL, "CHANNEL");
+    PRIMITIVE(SEND, "SEND");
+    PRIMITIVE(RECV, "RECV");
+    PRIMITIVE(TRY_RECV, "TRY-RECV");
+    PRIMITIVE(SEND_N, "SEND-N");
+    PRIMITIVE(RECV_N, "RECV-N");
     PRIMITIVE(SYSTEM, "SYSTEM");
     PRIMITIVE(MATCH, "MATCH");
     PRIMITIVE(SPLIT, "SPLIT");
@@ -274,6 +348,22 @@ void SimForth::bootCore()
     PRIMITIVE(CELL_STORE, "!");
     //PRIMITIVE(PLUS_STORE, "+!");
 
+    // Dynamic memory
+    PRIMITIVE(ALLOCATE, "ALLOCATE");
+    PRIMITIVE(FREE, "FREE");
+    PRIMITIVE(RESIZE, "RESIZE");
+
+    // Checkpoints
+    PRIMITIVE(CHECKPOINT, "CHECKPOINT");
+    PRIMITIVE(ROLLBACK, "ROLLBACK");
+
+    // Strings
+    PRIMITIVE(COMPARE, "COMPARE");
+    PRIMITIVE(SEARCH, "SEARCH");
+    PRIMITIVE(STRING_CONCAT, "S+");
+    PRIMITIVE(SUBSTRING, "SUBSTRING");
+    PRIMITIVE(SLASH_STRING, "/STRING");
+
     // Return stack manipulation
     PRIMITIVE(TWOTO_ASTACK, "2>R");
     PRIMITIVE(TWOFROM_ASTACK, "2R>");
@@ -346,6 +436,14 @@ void SimForth::bootCore()
     IMMEDIATE(RPARENT, ")");
     IMMEDIATE(COMMENT, "\\");
     IMMEDIATE(COMMENT_EOF, "\\EOF");
+
+    // Tokens following the ones of primitives are given to C++ and C
+    // functions registered at run time: secondary words are stored after.
+    forth::Token const end = forth::Token(m_interpreter->countPrimitives() + forth::size::natives);
+    if (m_dictionary->here() < end)
+    {
+        m_dictionary->allot(int(end - m_dictionary->here()));
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -25,6 +25,9 @@
 #include <unistd.h>            // To get the home path
 #include <sys/types.h>         // To get the home path
 #include <pwd.h>               // To get the home path
+#include <fcntl.h>             // MappedFileStream
+#include <sys/mman.h>          // MappedFileStream
+#include <sys/stat.h>          // MappedFileStream
 
 namespace forth
 {
@@ -32,6 +35,25 @@ namespace forth
 //----------------------------------------------------------------------------
 static Dictionary* dictionary = nullptr;
 
+//----------------------------------------------------------------------------
+//! \brief Count the number of '\n' in the n first chars of the buffer. memchr
+//! is used because it is vectorized by the libc.
+//----------------------------------------------------------------------------
+static size_t countLines(char const* buffer, size_t n)
+{
+    size_t lines = 0u;
+    char const* end = buffer + n;
+    char const* p = buffer;
+
+    while ((p < end) && ((p = static_cast<char const*>(memchr(p, '\n', size_t(end - p)))) != nullptr))
+    {
+        ++lines;
+        ++p;
+    }
+
+    return lines;
+}
+
 //----------------------------------------------------------------------------
 //! \brief Personal implementation of strdup because this is a POSIX function
 //! which is unknown on Windows (msys2).
@@ -74,10 +96,12 @@ void InputStream::reset()
 {
     // !!! Do not do reset m_countLines
     m_scriptLine.clear();
-    m_splitWord.clear();
+    m_buffer = {};
+    m_splitWord = {};
     m_splitEnd = m_splitStart = 0;
-    m_countChar = 0;
     m_eol = true;
+    m_lexemes.clear();
+    m_lexeme = 0;
 }
 
 //--------------------------------------------------------------------------
@@ -99,34 +123,53 @@ bool InputStream::split()
 //--------------------------------------------------------------------------
 bool InputStream::doSplit()
 {
+    // Words already split by a lexer: use them as long as the cursor has not
+    // been moved inside a word by a parsing word (i.e. S" abc"def). In this
+    // case, split characters until the cursor reaches a word boundary.
+    if (!m_lexemes.empty())
+    {
+        while ((m_lexeme < m_lexemes.size()) && (m_lexemes[m_lexeme].start < m_splitEnd))
+            ++m_lexeme;
+
+        size_t const end = (m_lexeme == 0u) ? 0u
+                           : m_lexemes[m_lexeme - 1u].start + m_lexemes[m_lexeme - 1u].size;
+        if (m_splitEnd >= end)
+        {
+            if (m_lexeme == m_lexemes.size())
+            {
+                m_splitEnd = m_splitStart = std::string::npos;
+                m_splitWord = {};
+                return false;
+            }
+
+            Lexeme const& lexeme = m_lexemes[m_lexeme];
+            m_splitStart = lexeme.start;
+            m_splitEnd = lexeme.start + lexeme.size;
+            m_splitWord = m_buffer.substr(lexeme.start, lexeme.size);
+            m_eol = lexeme.eol;
+            return true;
+        }
+    }
+
     // Skip whitespaces
-    size_t begin = m_splitStart;
-    m_splitStart = m_scriptLine.find_first_not_of(SPACES, m_splitEnd);
+    m_splitStart = m_buffer.find_first_not_of(SPACES, m_splitEnd);
     if (m_splitStart == std::string::npos)
     {
         m_splitEnd = m_splitStart;
-        m_splitWord.clear();
+        m_splitWord = {};
         return false;
     }
 
-    for (size_t i = begin; i < m_splitStart; ++i)
-    {
-        if (m_scriptLine[i] == '\n')
-        {
-            ++m_countLines;
-            m_countChar = 0; // FIXME
-        }
-    }
-
-    // Then parse input delimited by one of delimiter characters.
-    m_splitEnd = m_scriptLine.find_first_of(SPACES, m_splitStart);
-    m_splitWord = m_scriptLine.substr(m_splitStart, m_splitEnd - m_splitStart);
+    // Then parse input delimited by one of delimiter characters. The word is
+    // not copied: only a view on the line buffer is kept.
+    m_splitEnd = m_buffer.find_first_of(SPACES, m_splitStart);
+    m_splitWord = m_buffer.substr(m_splitStart, m_splitEnd - m_splitStart);
 
     // Skip spaces after the extracted word to get the information if we reached
     // the end of the line. Indeed this information is difficult to have since
     // this function is called inside a loop.
-    size_t eol = m_scriptLine.find_first_not_of(" \t", m_splitEnd);
-    m_eol = ((eol == std::string::npos) || (m_scriptLine[eol] == '\n'));
+    size_t eol = m_buffer.find_first_not_of(" \t", m_splitEnd);
+    m_eol = ((eol == std::string::npos) || (m_buffer[eol] == '\n'));
 
     return true;
 }
@@ -152,8 +195,8 @@ void InputStream::skip(int const nb)
 {
     m_splitEnd += size_t(nb);
     m_splitStart += size_t(nb);
-    size_t eol = m_scriptLine.find_first_not_of(" \t", m_splitEnd);
-    m_eol = ((eol == std::string::npos) || (m_scriptLine[eol] == '\n'));
+    size_t eol = m_buffer.find_first_not_of(" \t", m_splitEnd);
+    m_eol = ((eol == std::string::npos) || (m_buffer[eol] == '\n'));
 }
 
 //--------------------------------------------------------------------------
@@ -162,33 +205,23 @@ bool InputStream::doSplit(std::string const& delimiters)
     static const std::string spaces = " \t\n";
 
     // Skip whitespaces
-    size_t begin = m_splitStart;
-    m_splitStart = m_scriptLine.find_first_not_of(spaces, m_splitEnd);
+    m_splitStart = m_buffer.find_first_not_of(spaces, m_splitEnd);
     if (m_splitStart == std::string::npos)
     {
         m_splitEnd = m_splitStart;
-        m_splitWord.clear();
+        m_splitWord = {};
         return false;
     }
 
-    for (size_t i = begin; i < m_splitStart; ++i)
-    {
-        if (m_scriptLine[i] == '\n')
-        {
-            ++m_countLines;
-            m_countChar = 0; // FIXME
-        }
-    }
-
     // Then parse input delimited by one of delimiter characters.
-    m_splitEnd = m_scriptLine.find_first_of(delimiters, m_splitStart);
-    m_splitWord = m_scriptLine.substr(m_splitStart, m_splitEnd - m_splitStart);
+    m_splitEnd = m_buffer.find_first_of(delimiters, m_splitStart);
+    m_splitWord = m_buffer.substr(m_splitStart, m_splitEnd - m_splitStart);
 
     // Skip spaces after the extracted word to get the information if we reached
     // the end of the line. Indeed this information is difficult to have since
     // this function is called inside a loop.
-    size_t eol = m_scriptLine.find_first_not_of(" \t", m_splitEnd);
-    m_eol = ((eol == std::string::npos) || (m_scriptLine[eol] == '\n'));
+    size_t eol = m_buffer.find_first_not_of(" \t", m_splitEnd);
+    m_eol = ((eol == std::string::npos) || (m_buffer[eol] == '\n'));
 
     if (m_splitEnd != std::string::npos)
     {
@@ -198,18 +231,48 @@ bool InputStream::doSplit(std::string const& delimiters)
     return true;
 }
 
+//----------------------------------------------------------------------------
+bool InputStream::number(int const base, Cell& number) const
+{
+    if (m_lexeme >= m_lexemes.size())
+        return false;
+
+    Lexeme const& lexeme = m_lexemes[m_lexeme];
+    if ((lexeme.start != m_splitStart) || (lexeme.size != m_splitWord.size()))
+        return false;
+    if ((lexeme.kind == Lexeme::Kind::Word) || (lexeme.base != base))
+        return false;
+
+    number = lexeme.value;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+std::pair<size_t, size_t> InputStream::cursor() const
+{
+    // Position of the last split word. When the end of the line has been
+    // reached, point after the last character.
+    size_t const pos = std::min(m_splitStart, m_buffer.size());
+
+    size_t const lines = m_countLines + countLines(m_buffer.data(), pos);
+    size_t const bol = (pos == 0u) ? std::string::npos : m_buffer.rfind('\n', pos - 1u);
+    size_t const column = (bol == std::string::npos) ? pos : pos - bol - 1u;
+
+    return { lines, column };
+}
+
 //----------------------------------------------------------------------------
 std::string InputStream::getLineAtCursor() const
 {
     if (m_splitEnd == std::string::npos)
         return {};
-    return m_scriptLine.substr(m_splitEnd + 1);
+    return std::string(m_buffer.substr(m_splitEnd + 1));
 }
 
 //----------------------------------------------------------------------------
 std::string InputStream::getLine() const
 {
-    return m_scriptLine;
+    return std::string(m_buffer);
 }
 
 //----------------------------------------------------------------------------
@@ -242,6 +305,7 @@ bool FileStream::refill()
         return false;
     }
 
+    m_buffer = m_scriptLine;
     m_countLines += 1;
     return true;
 }
@@ -256,10 +320,331 @@ bool FileStream::skipFile()
 //----------------------------------------------------------------------------
 bool FileStream::skipLine()
 {
-    m_countChar = 0;
-    m_splitStart = m_scriptLine.find_first_of("\n", m_splitStart);
+    m_splitStart = m_buffer.find_first_of("\n", m_splitStart);
+    m_splitEnd = m_splitStart;
+    m_splitWord = {};
+    m_eol = true;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+MappedFileStream::~MappedFileStream()
+{
+    LOGD("Close MappedFileStream '%s'", m_name.c_str());
+    unmap();
+}
+
+//----------------------------------------------------------------------------
+void MappedFileStream::unmap()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<char*>(m_data), m_size);
+        m_data = nullptr;
+    }
+    m_size = m_next = 0;
+}
+
+//----------------------------------------------------------------------------
+bool MappedFileStream::feed(char const* filename)
+{
+    if (!filename)
+        return false;
+
+    unmap();
+    reset();
+    m_countLines = 0;
+    m_name = filename;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        m_errno = "Failed opening '" + m_name + "'. Reason '"
+                  + std::strerror(errno) + "'";
+        LOGE("%s", m_errno.c_str());
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        m_errno = "Failed reading in '" + m_name + "'. Reason '"
+                  + std::strerror(errno) + "'";
+        LOGE("%s", m_errno.c_str());
+        close(fd);
+        return false;
+    }
+
+    // Empty file: nothing to map (mmap does not accept 0 byte). Same behavior
+    // than FileStream: no error but nothing to read.
+    if (st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid after closing the file descriptor
+    if (data == MAP_FAILED)
+    {
+        m_errno = "Failed mapping '" + m_name + "'. Reason '"
+                  + std::strerror(errno) + "'";
+        LOGE("%s", m_errno.c_str());
+        return false;
+    }
+
+    // The file is read once from its begining to its end.
+    madvise(data, size_t(st.st_size), MADV_SEQUENTIAL);
+    m_data = static_cast<char const*>(data);
+    m_size = size_t(st.st_size);
+
+    return refill();
+}
+
+//----------------------------------------------------------------------------
+bool MappedFileStream::refill()
+{
+    reset();
+
+    // End of file reached.
+    if (m_next >= m_size)
+        return false;
+
+    // Point the next line directly inside the mapped memory. No copy is made.
+    char const* begin = m_data + m_next;
+    char const* eol = static_cast<char const*>(memchr(begin, '\n', m_size - m_next));
+    size_t length = (eol == nullptr) ? (m_size - m_next) : size_t(eol - begin);
+
+    m_buffer = std::string_view(begin, length);
+    m_next += length + 1u;
+    m_countLines += 1;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+bool MappedFileStream::skipFile()
+{
+    m_next = m_size;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+bool MappedFileStream::skipLine()
+{
+    m_splitStart = m_buffer.find_first_of("\n", m_splitStart);
+    m_splitEnd = m_splitStart;
+    m_splitWord = {};
+    m_eol = true;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+PipelinedFileStream::~PipelinedFileStream()
+{
+    LOGD("Close PipelinedFileStream '%s'", m_name.c_str());
+    stop();
+}
+
+//----------------------------------------------------------------------------
+void PipelinedFileStream::wakeUp(std::atomic<bool> const& waiting)
+{
+    // The change has been stored before this check and the other side sets
+    // its flag before checking the ring buffer (sequentially consistent):
+    // either it sees the change or it is seen waiting. Only then the mutex is
+    // taken, once the other side is inside wait(): the notification cannot be
+    // lost.
+    if (!waiting.load())
+        return ;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_cond.notify_all();
+}
+
+//----------------------------------------------------------------------------
+void PipelinedFileStream::stop()
+{
+    m_halt.store(true);
+    wakeUp(m_lexer_waiting);
+    if (m_lexer.joinable())
+        m_lexer.join();
+    m_halt.store(false, std::memory_order_relaxed);
+    m_infile.close();
+    m_infile.clear();
+    m_head.store(0u, std::memory_order_relaxed);
+    m_tail.store(0u, std::memory_order_relaxed);
+    m_eof = true;
+}
+
+//----------------------------------------------------------------------------
+bool PipelinedFileStream::feed(char const* filename)
+{
+    if (!filename)
+        return false;
+
+    stop();
+    reset();
+    m_countLines = 0;
+    m_name = filename;
+    m_infile.open(filename);
+    if (!m_infile.is_open())
+    {
+        m_errno = "Failed reading in '" + m_name + "'. Reason '"
+                  + std::strerror(errno) + "'";
+        LOGE("%s", m_errno.c_str());
+        return false;
+    }
+
+    m_eof = false;
+    m_lexer = std::thread(&PipelinedFileStream::lex, this);
+    return refill();
+}
+
+//----------------------------------------------------------------------------
+void PipelinedFileStream::lex()
+{
+    size_t head = m_head.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        // Ring buffer full: sleep until the interpreter pops a line.
+        if (head - m_tail.load(std::memory_order_acquire) == RING_SIZE)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_lexer_waiting.store(true);
+            m_cond.wait(lock, [this, head]()
+            {
+                return m_halt.load() || (head - m_tail.load() != RING_SIZE);
+            });
+            m_lexer_waiting.store(false, std::memory_order_relaxed);
+        }
+        if (m_halt.load(std::memory_order_relaxed))
+            return ;
+
+        Line& line = m_ring[head & (RING_SIZE - 1u)];
+        line.error.clear();
+        line.eof = !std::getline(m_infile, line.text);
+        if (line.eof)
+        {
+            if (!m_infile.eof())
+            {
+                line.error = "Failed reading in '" + m_name + "'. Reason '"
+                             + std::strerror(errno) + "'";
+            }
+        }
+        else
+        {
+            tokenize(line);
+        }
+
+        bool const eof = line.eof;
+        m_head.store(++head);
+        wakeUp(m_reader_waiting);
+        if (eof)
+            return ;
+    }
+}
+
+//----------------------------------------------------------------------------
+void PipelinedFileStream::tokenize(Line& line) const
+{
+    std::string_view const text(line.text);
+    size_t end = 0u;
+
+    line.lexemes.clear();
+    while (true)
+    {
+        size_t const start = text.find_first_not_of(SPACES, end);
+        if (start == std::string::npos)
+            break;
+
+        end = text.find_first_of(SPACES, start);
+        std::string_view const word = text.substr(start, end - start);
+
+        // Same end of line detection than InputStream::doSplit()
+        size_t const eol = text.find_first_not_of(" \t", end);
+
+        Lexeme lexeme;
+        lexeme.start = start;
+        lexeme.size = word.size();
+        lexeme.base = m_base;
+        lexeme.eol = ((eol == std::string::npos) || (text[eol] == '\n'));
+
+        // Integers too huge for a cell are let to the interpreter which warns
+        // about their conversion into float.
+        if (toInteger(word, m_base, lexeme.value))
+            lexeme.kind = lexeme.value.isInteger() ? Lexeme::Kind::Integer : Lexeme::Kind::Word;
+        else if (toReal(word, lexeme.value))
+            lexeme.kind = Lexeme::Kind::Float;
+        else
+            lexeme.kind = Lexeme::Kind::Word;
+
+        line.lexemes.push_back(lexeme);
+        if (end == std::string::npos)
+            break;
+    }
+}
+
+//----------------------------------------------------------------------------
+bool PipelinedFileStream::refill()
+{
+    reset();
+
+    if (m_eof)
+        return false;
+
+    // Sleep until the lexer pushes a line.
+    size_t const tail = m_tail.load(std::memory_order_relaxed);
+    if (m_head.load(std::memory_order_acquire) == tail)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_reader_waiting.store(true);
+        m_cond.wait(lock, [this, tail]()
+        {
+            return m_head.load() != tail;
+        });
+        m_reader_waiting.store(false, std::memory_order_relaxed);
+    }
+
+    Line& line = m_ring[tail & (RING_SIZE - 1u)];
+    if (line.eof)
+    {
+        m_eof = true;
+        if (!line.error.empty())
+        {
+            m_errno = line.error;
+            LOGE("%s", m_errno.c_str());
+        }
+        m_tail.store(tail + 1u);
+        wakeUp(m_lexer_waiting);
+        return false;
+    }
+
+    // Swap buffers instead of copying them: the lexer reuses their memory.
+    m_scriptLine.swap(line.text);
+    m_lexemes.swap(line.lexemes);
+    m_tail.store(tail + 1u);
+    wakeUp(m_lexer_waiting);
+
+    m_buffer = m_scriptLine;
+    m_countLines += 1;
+    return true;
+}
+
+//----------------------------------------------------------------------------
+bool PipelinedFileStream::skipFile()
+{
+    stop();
+    return true;
+}
+
+//----------------------------------------------------------------------------
+bool PipelinedFileStream::skipLine()
+{
+    m_splitStart = m_buffer.find_first_of("\n", m_splitStart);
     m_splitEnd = m_splitStart;
-    m_splitWord.clear();
+    m_splitWord = {};
     m_eol = true;
     return true;
 }
@@ -270,19 +655,32 @@ bool StringStream::feed(char const* script)
     if (!script)
         return false;
 
+    return feed(script, Mode::Copy);
+}
+
+//----------------------------------------------------------------------------
+bool StringStream::feed(std::string_view const& script, Mode const mode)
+{
     reset();
     m_name = "String";
-    m_scriptLine = script;
+    if (mode == Mode::Copy)
+    {
+        m_scriptLine = script;
+        m_buffer = m_scriptLine;
+    }
+    else
+    {
+        m_buffer = script;
+    }
     return true;
 }
 
 //----------------------------------------------------------------------------
 bool StringStream::skipLine()
 {
-    m_countChar = 0;
-    m_splitStart = m_scriptLine.find_first_of("\n", m_splitStart);
+    m_splitStart = m_buffer.find_first_of("\n", m_splitStart);
     m_splitEnd = m_splitStart;
-    m_splitWord.clear();
+    m_splitWord = {};
     m_eol = true;
     return true;
 }
@@ -290,7 +688,7 @@ bool StringStream::skipLine()
 //----------------------------------------------------------------------------
 bool StringStream::skipFile()
 {
-    m_splitStart = m_scriptLine.size();
+    m_splitStart = m_buffer.size();
     m_splitEnd = m_splitStart;
     return true;
 }
@@ -377,6 +775,7 @@ bool InteractiveStream::refill()
     saveCommand(input);
 
     m_scriptLine = input;
+    m_buffer = m_scriptLine;
     free(input);
 
     return true;
@@ -385,7 +784,6 @@ bool InteractiveStream::refill()
 //----------------------------------------------------------------------------
 bool InteractiveStream::skipLine()
 {
-    m_countChar = 0;
     return refill();
 }
 
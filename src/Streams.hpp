@@ -24,13 +24,43 @@
 #  include "Dictionary.hpp"
 #  include "MyLogger/Logger.hpp"
 #  include <string>
+#  include <string_view>
 #  include <fstream>
+#  include <vector>
+#  include <array>
+#  include <atomic>
+#  include <condition_variable>
+#  include <mutex>
+#  include <thread>
 
 namespace forth
 {
 
 static const std::string SPACES = " \t\n\v\f\r";
 
+//****************************************************************************
+//! \brief Word split ahead of the interpretation (by a lexer thread) and
+//! already classified.
+//****************************************************************************
+struct Lexeme
+{
+    //! \brief Classification of the word.
+    enum class Kind : uint8_t { Word, Integer, Float };
+
+    //! \brief Position of the word inside the line.
+    size_t start;
+    //! \brief Number of chars of the word.
+    size_t size;
+    //! \brief Value of the number if the word is a number.
+    Cell value;
+    //! \brief Base used for converting the number.
+    int base;
+    //! \brief Number or dictionary word.
+    Kind kind;
+    //! \brief Is the word the last one of the line ?
+    bool eol;
+};
+
 //****************************************************************************
 //! \brief Modern version of the classical Forth Terminal Input Buffer.
 //!
@@ -56,11 +86,14 @@ public:
     virtual ~InputStream() = default;
 
     //--------------------------------------------------------------------------
-    //! \brief Return the reference to the last word split by split().
+    //! \brief Return the last word split by split().
+    //! \note the returned view refers to the internal line buffer: it is only
+    //! valid until the next call to split(), skipLine() or refill(). Make a copy
+    //! of it if you need to keep it longer.
     //! \note the return string can be dummy if not stream have been given or
     //! the end of the stream is reached.
     //--------------------------------------------------------------------------
-    std::string& word()
+    inline std::string_view word() const
     {
         return m_splitWord;
     }
@@ -91,14 +124,13 @@ public:
     //! \brief Return the current position in the stram.
     //!
     //! Used for indicating the impacted line and the word when an error is
-    //! detected.
+    //! detected. Lines and columns are not tracked by split(): they are
+    //! computed on demand from the position of the last split word, since this
+    //! information is only needed when reporting an error.
     //!
     //! \return the pair <line, columns>.
     //--------------------------------------------------------------------------
-    std::pair<size_t, size_t> const cursor() const
-    {
-        return { m_countLines, m_countChar };
-    }
+    std::pair<size_t, size_t> cursor() const;
 
     //--------------------------------------------------------------------------
     //! \brief Skip the current line. Used for skipping one-line comments.
@@ -153,6 +185,18 @@ public:
         return m_base;
     }
 
+    //--------------------------------------------------------------------------
+    //! \brief Get the number converted ahead of the interpretation for the
+    //! last split word.
+    //! \param[in] base the current base of the interpreter. The number is only
+    //! returned if it has been converted with the same base.
+    //! \param[out] number the converted number.
+    //! \return false if the word was not pre-converted (unknown conversion,
+    //! not a number or different base) in this case the caller shall convert
+    //! the word by itself.
+    //--------------------------------------------------------------------------
+    bool number(int const base, Cell& number) const;
+
 private:
 
     //--------------------------------------------------------------------------
@@ -183,20 +227,28 @@ protected:
     //! \brief Memorize the current base needed when a script includes other
     //! files.
     int         m_base;
-    //! \brief Cache the current line of the script.
+    //! \brief Cache the current line of the script (for streams having to
+    //! copy their input).
     std::string m_scriptLine;
-    //! \brief Extracted word.
-    std::string m_splitWord;
+    //! \brief Characters currently split: refers either to m_scriptLine or
+    //! to memory not owned by the stream (mapped file, borrowed string).
+    std::string_view m_buffer;
+    //! \brief Extracted word (view on m_buffer, no copy is made).
+    std::string_view m_splitWord;
     //! \brief Cursor for extracting the next word.
     size_t      m_splitStart = 0;
     //! \brief Cursor for extracting the next word.
     size_t      m_splitEnd = 0;
-    //! \brief Count lines of the script.
+    //! \brief Count lines of the script already consumed by refill(). Lines
+    //! inside m_buffer are counted lazily by cursor().
     size_t      m_countLines = 0;
-    //! \brief Count the character position
-    size_t      m_countChar = 0;
     //! \brief End Of Line reached ?
     bool        m_eol = true;
+    //! \brief Words of m_buffer already split by a lexer. Empty for streams
+    //! splitting words on demand.
+    std::vector<Lexeme> m_lexemes;
+    //! \brief Index of the last split word inside m_lexemes.
+    size_t      m_lexeme = 0;
 };
 
 //****************************************************************************
@@ -206,6 +258,19 @@ class StringStream : public InputStream
 {
 public:
 
+    //--------------------------------------------------------------------------
+    //! \brief Does the stream make its own copy of the script or does it refer
+    //! to the caller's buffer ?
+    //--------------------------------------------------------------------------
+    enum class Mode
+    {
+        //! \brief The script is copied: the caller can release it.
+        Copy,
+        //! \brief The script is not copied: the caller shall keep it alive and
+        //! unmodified until the stream is closed.
+        Borrow
+    };
+
     //--------------------------------------------------------------------------
     //! \brief
     //--------------------------------------------------------------------------
@@ -223,6 +288,17 @@ public:
         feed(script);
     }
 
+    //--------------------------------------------------------------------------
+    //! \brief Open a script given with its size (does not have to be ended by
+    //! '\0') and choose if it has to be copied or borrowed.
+    //--------------------------------------------------------------------------
+    StringStream(std::string_view const& script, Mode const mode, int const base = 10)
+        : InputStream(base)
+    {
+        LOGD("Open StringStream '%.*s'", int(script.size()), script.data());
+        feed(script, mode);
+    }
+
     ~StringStream()
     {
         LOGD("Close StringStream '%s'", m_name.c_str());
@@ -235,6 +311,14 @@ public:
     //--------------------------------------------------------------------------
     virtual bool feed(char const* script) override;
 
+    //--------------------------------------------------------------------------
+    //! \brief For feeding the Forth interpreter from a Forth string script.
+    //! \param script the Forth string script.
+    //! \param mode copy or borrow the script.
+    //! \return true in case of success.
+    //--------------------------------------------------------------------------
+    bool feed(std::string_view const& script, Mode const mode);
+
     virtual bool skipLine() override;
     virtual bool skipFile() override;
 
@@ -314,6 +398,213 @@ protected:
     std::ifstream m_infile;
 };
 
+//****************************************************************************
+//! \brief Read a Forth file mapped in memory.
+//!
+//! Contrary to FileStream, lines are not copied: they are split directly from
+//! the mapped memory and their boundaries are found by memchr. This makes the
+//! inclusion of huge (generated) Forth files limited by the speed of the
+//! interpreter and not by reads and copies.
+//****************************************************************************
+class MappedFileStream : public InputStream
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //! \brief
+    //--------------------------------------------------------------------------
+    MappedFileStream(int const base = 10)
+        : InputStream(base)
+    {}
+
+    //--------------------------------------------------------------------------
+    //! \brief
+    //--------------------------------------------------------------------------
+    MappedFileStream(char const* filename, int const base = 10)
+        : InputStream(base)
+    {
+        LOGD("Open MappedFileStream '%s'", filename);
+        feed(filename);
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Release the mapped memory.
+    //--------------------------------------------------------------------------
+    virtual ~MappedFileStream();
+
+    //--------------------------------------------------------------------------
+    //! \brief For feeding the Forth interpreter from an ASCII Forth file.
+    //! \param filename the path of the Forth file script.
+    //! \return true in case of success, else use error() to
+    //--------------------------------------------------------------------------
+    virtual bool feed(char const* filename) override;
+
+    virtual bool skipLine() override;
+    virtual bool skipFile() override;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //! \brief
+    //--------------------------------------------------------------------------
+    virtual bool canRefill() const override
+    {
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Point to the next line of the mapped file.
+    //--------------------------------------------------------------------------
+    virtual bool refill() override;
+
+    //--------------------------------------------------------------------------
+    //! \brief Release the mapped memory.
+    //--------------------------------------------------------------------------
+    void unmap();
+
+private:
+
+    //! \brief Mapped file
+    char const* m_data = nullptr;
+    //! \brief Size of the mapped file
+    size_t m_size = 0;
+    //! \brief Offset of the next line to read
+    size_t m_next = 0;
+};
+
+//****************************************************************************
+//! \brief Read a Forth file with a lexer thread running ahead of the
+//! interpreter.
+//!
+//! A producer thread reads lines, splits them into words and converts numbers
+//! while the interpreter is executing or compiling the previous lines. Lines
+//! are given to the interpreter through a lock-free single producer single
+//! consumer ring buffer.
+//!
+//! The original line is kept along with its words, therefore parsing words
+//! (such as ( \ S" ." or >IN) still work on characters: when they move the
+//! cursor inside a pre-split word, split() does not use lexemes until the
+//! cursor reaches a word boundary again.
+//!
+//! \note numbers are converted with the base given to the constructor. If the
+//! script changes the base, numbers are converted again by the interpreter.
+//****************************************************************************
+class PipelinedFileStream : public InputStream
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //! \brief
+    //--------------------------------------------------------------------------
+    PipelinedFileStream(int const base = 10)
+        : InputStream(base)
+    {}
+
+    //--------------------------------------------------------------------------
+    //! \brief
+    //--------------------------------------------------------------------------
+    PipelinedFileStream(char const* filename, int const base = 10)
+        : InputStream(base)
+    {
+        LOGD("Open PipelinedFileStream '%s'", filename);
+        feed(filename);
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Stop the lexer thread.
+    //--------------------------------------------------------------------------
+    virtual ~PipelinedFileStream();
+
+    //--------------------------------------------------------------------------
+    //! \brief For feeding the Forth interpreter from an ASCII Forth file.
+    //! Start the lexer thread.
+    //! \param filename the path of the Forth file script.
+    //! \return true in case of success, else use error() to
+    //--------------------------------------------------------------------------
+    virtual bool feed(char const* filename) override;
+
+    virtual bool skipLine() override;
+    virtual bool skipFile() override;
+
+private:
+
+    //--------------------------------------------------------------------------
+    //! \brief Line read and split by the lexer thread.
+    //--------------------------------------------------------------------------
+    struct Line
+    {
+        std::string text;
+        std::vector<Lexeme> lexemes;
+        std::string error;
+        bool eof;
+    };
+
+    //--------------------------------------------------------------------------
+    //! \brief
+    //--------------------------------------------------------------------------
+    virtual bool canRefill() const override
+    {
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Get the next line from the lexer thread. Wait for it if the
+    //! lexer is late.
+    //--------------------------------------------------------------------------
+    virtual bool refill() override;
+
+    //--------------------------------------------------------------------------
+    //! \brief Body of the lexer thread: read, split lines and push them in the
+    //! ring buffer until the end of the file or until stop() is called.
+    //--------------------------------------------------------------------------
+    void lex();
+
+    //--------------------------------------------------------------------------
+    //! \brief Split a line into words and convert numbers.
+    //--------------------------------------------------------------------------
+    void tokenize(Line& line) const;
+
+    //--------------------------------------------------------------------------
+    //! \brief Stop the lexer thread and close the file.
+    //--------------------------------------------------------------------------
+    void stop();
+
+    //--------------------------------------------------------------------------
+    //! \brief Wake up the other side after m_head, m_tail or m_halt changed,
+    //! only if it is sleeping: the mutex is not taken on the hot path.
+    //! \param waiting the flag of the other side.
+    //--------------------------------------------------------------------------
+    void wakeUp(std::atomic<bool> const& waiting);
+
+private:
+
+    //! \brief Number of lines the lexer can be ahead of the interpreter
+    //! (shall be a power of two).
+    static constexpr size_t RING_SIZE = 64u;
+
+    //! \brief Opened file (only accessed by the lexer thread once started).
+    std::ifstream m_infile;
+    //! \brief Lines read ahead.
+    std::array<Line, RING_SIZE> m_ring;
+    //! \brief Number of lines pushed by the lexer.
+    alignas(64) std::atomic<size_t> m_head{0u};
+    //! \brief Number of lines popped by the interpreter.
+    alignas(64) std::atomic<size_t> m_tail{0u};
+    //! \brief Ask the lexer thread to halt.
+    std::atomic<bool> m_halt{false};
+    //! \brief The lexer sleeps while the ring buffer is full and the
+    //! interpreter while it is empty: they are woken up by the other side.
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    //! \brief Set by each side before sleeping on m_cond.
+    alignas(64) std::atomic<bool> m_lexer_waiting{false};
+    alignas(64) std::atomic<bool> m_reader_waiting{false};
+    //! \brief The lexer thread.
+    std::thread m_lexer;
+    //! \brief The last line has been popped.
+    bool m_eof = true;
+};
+
 //****************************************************************************
 //! \brief
 //****************************************************************************
@@ -0,0 +1,117 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+#include "StringHeap.hpp"
+#include "Heap.hpp"
+#include <algorithm>
+
+namespace forth
+{
+
+static_assert(StringHeap::base >= 2 * Heap::end,
+              "String handles shall not be heap addresses");
+
+//------------------------------------------------------------------------------
+Int StringHeap::intern(std::string_view const& s)
+{
+    auto it = m_index.find(s);
+    if (it != m_index.end())
+        return it->second;
+
+    size_t index;
+    if (m_free.empty())
+    {
+        index = m_strings.size();
+        m_strings.emplace_back(s);
+        m_states.push_back(Used);
+    }
+    else
+    {
+        index = m_free.back();
+        m_free.pop_back();
+        m_strings[index].assign(s.data(), s.size());
+        m_states[index] = Used;
+    }
+
+    Int const handle = base + Int(index);
+    m_index.emplace(std::string_view(m_strings[index]), handle);
+    ++m_live;
+    return handle;
+}
+
+//------------------------------------------------------------------------------
+void StringHeap::release(size_t const index)
+{
+    m_index.erase(std::string_view(m_strings[index]));
+    std::string().swap(m_strings[index]);
+    m_states[index] = Free;
+    --m_live;
+}
+
+//------------------------------------------------------------------------------
+size_t StringHeap::sweep(size_t const floor)
+{
+    size_t released = 0u;
+
+    for (size_t index = 0u; index < m_states.size(); ++index)
+    {
+        if (m_states[index] == Marked)
+        {
+            m_states[index] = Used;
+        }
+        else if ((m_states[index] == Used) && (index >= floor))
+        {
+            release(index);
+            m_free.push_back(index);
+            ++released;
+        }
+    }
+
+    m_threshold = std::max(MIN_THRESHOLD, 2u * m_live);
+    return released;
+}
+
+//------------------------------------------------------------------------------
+void StringHeap::truncate(size_t const count)
+{
+    while (m_strings.size() > count)
+    {
+        if (m_states.back() != Free)
+            release(m_strings.size() - 1u);
+        m_strings.pop_back();
+        m_states.pop_back();
+    }
+    m_free.erase(std::remove_if(m_free.begin(), m_free.end(),
+                                [count](size_t const index) { return index >= count; }),
+                 m_free.end());
+}
+
+//------------------------------------------------------------------------------
+void StringHeap::reset()
+{
+    m_index.clear();
+    m_strings.clear();
+    m_states.clear();
+    m_free.clear();
+    m_live = 0u;
+    m_threshold = MIN_THRESHOLD;
+}
+
+} // namespace forth
@@ -0,0 +1,174 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+#ifndef INTERNAL_FORTH_STRING_HEAP_HPP
+#  define INTERNAL_FORTH_STRING_HEAP_HPP
+
+#  include "SimForth/Cell.hpp"
+#  include <deque>
+#  include <string>
+#  include <string_view>
+#  include <vector>
+#  include <unordered_map>
+
+namespace forth
+{
+
+//******************************************************************************
+//! \brief Interned strings referred by handles.
+//!
+//! Strings built at run time (S" in interpretation mode, S+, SEARCH,
+//! SUBSTRING ...) are stored here instead of the dictionary. Each distinct
+//! string is stored once: identical strings share the same handle, so
+//! checking the equality of two interned strings is O(1). Strings are
+//! immutable, their length is known in O(1), have no size limit and are
+//! ended by an extra '\0' char to be usable by C functions.
+//!
+//! Handles are Forth addresses placed far above the dictionary and heap
+//! address spaces: words consuming strings as ( addr u ) accept both
+//! dictionary count strings and handles.
+//!
+//! Strings no longer referred are released by a mark and sweep collection
+//! (see Interpreter::collectStrings()): every value looking like a handle
+//! inside the stacks, the dictionary, the heap or the channels is marked,
+//! then unmarked strings are released and their handles are recycled.
+//******************************************************************************
+class StringHeap
+{
+public:
+
+    //! \brief First handle.
+    static constexpr Int base = Int(1) << 40;
+
+    //--------------------------------------------------------------------------
+    //! \brief Return true if the address is a string handle.
+    //--------------------------------------------------------------------------
+    static inline bool owns(Int const address)
+    {
+        return address >= base;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the handle of the given string. Store a copy of the
+    //! string if it has not yet been interned.
+    //--------------------------------------------------------------------------
+    Int intern(std::string_view const& s);
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the string referred by the handle or nullptr if the
+    //! handle is not valid.
+    //--------------------------------------------------------------------------
+    inline std::string const* get(Int const handle) const
+    {
+        Int const index = handle - base;
+        if ((index < 0) || (size_t(index) >= m_strings.size()) ||
+            (m_states[size_t(index)] == Free))
+            return nullptr;
+        return &m_strings[size_t(index)];
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the number of handles ever given (released ones
+    //! included). Handles below this number are left untouched by
+    //! truncate(size()).
+    //--------------------------------------------------------------------------
+    inline size_t size() const
+    {
+        return m_strings.size();
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the number of strings not yet released.
+    //--------------------------------------------------------------------------
+    inline size_t live() const
+    {
+        return m_live;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Return true when enough strings have been interned since the
+    //! last collection.
+    //--------------------------------------------------------------------------
+    inline bool crowded() const
+    {
+        return m_live >= m_threshold;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Keep the string referred by the value at the next sweep(). Values
+    //! which are not handles are ignored.
+    //--------------------------------------------------------------------------
+    inline void mark(Int const value)
+    {
+        Int const index = value - base;
+        if ((index >= 0) && (size_t(index) < m_states.size()) &&
+            (m_states[size_t(index)] == Used))
+            m_states[size_t(index)] = Marked;
+    }
+
+    //--------------------------------------------------------------------------
+    //! \brief Release strings not marked since the previous sweep, except
+    //! the ones whose handle is below floor (kept by checkpoints).
+    //! \return the number of released strings.
+    //--------------------------------------------------------------------------
+    size_t sweep(size_t const floor);
+
+    //--------------------------------------------------------------------------
+    //! \brief Release strings interned after the first count ones. Their
+    //! handles become invalid.
+    //--------------------------------------------------------------------------
+    void truncate(size_t const count);
+
+    //--------------------------------------------------------------------------
+    //! \brief Release all strings. Handles become invalid.
+    //--------------------------------------------------------------------------
+    void reset();
+
+private:
+
+    //! \brief State of a handle.
+    enum State : uint8_t { Free, Used, Marked };
+
+    //! \brief Minimal number of strings triggering a collection.
+    static constexpr size_t MIN_THRESHOLD = 1024u;
+
+    //--------------------------------------------------------------------------
+    //! \brief Release the string of the given index.
+    //--------------------------------------------------------------------------
+    void release(size_t const index);
+
+    //! \brief Interned strings. A deque never moves its elements: views
+    //! stored in m_index stay valid.
+    std::deque<std::string> m_strings;
+    //! \brief State of each element of m_strings.
+    std::vector<State> m_states;
+    //! \brief Indices of released strings, recycled by intern().
+    std::vector<size_t> m_free;
+    //! \brief Hash table from string contents to handles.
+    std::unordered_map<std::string_view, Int> m_index;
+    //! \brief Number of strings not released.
+    size_t m_live = 0u;
+    //! \brief Value of m_live triggering the next collection.
+    size_t m_threshold = MIN_THRESHOLD;
+};
+
+} // namespace forth
+
+#endif // INTERNAL_FORTH_STRING_HEAP_HPP
@@ -0,0 +1,539 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+#include "TaskPool.hpp"
+#include "Interpreter.hpp"
+#include "Primitives.hpp"
+#include "Exceptions.hpp"
+#include <algorithm>
+
+namespace forth
+{
+
+//! \brief Pool and worker index of the current thread (nullptr if the thread
+//! is not a worker).
+static thread_local TaskPool* t_pool = nullptr;
+static thread_local size_t t_id = 0u;
+//! \brief Interpreters of the current worker thread. A worker awaiting a task
+//! runs other tasks: each nested task gets its own interpreter.
+static thread_local std::vector<std::unique_ptr<Interpreter>>* t_interpreters = nullptr;
+static thread_local size_t t_depth = 0u;
+
+//------------------------------------------------------------------------------
+TaskPool::TaskPool(Dictionary& dictionary, Options const& options, size_t workers,
+                   std::shared_ptr<Natives> natives)
+    : m_dictionary(dictionary), m_options(options), m_natives(std::move(natives))
+{
+    if (workers == 0u)
+        workers = std::max(1u, std::thread::hardware_concurrency());
+
+    for (size_t i = 0u; i < workers; ++i)
+        m_workers.push_back(std::make_unique<Worker>());
+    for (size_t i = 0u; i < workers; ++i)
+        m_workers[i]->thread = std::thread(&TaskPool::loop, this, i);
+}
+
+//------------------------------------------------------------------------------
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_work.notify_all();
+    m_done.notify_all();
+
+    for (auto& it: m_workers)
+        it->thread.join();
+}
+
+//------------------------------------------------------------------------------
+Int TaskPool::spawn(Token const xt, std::vector<Cell>&& args)
+{
+    verify(xt, "SPAWN", true);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_spawned >= MAX_TASKS)
+        {
+            THROW("SPAWN: too many tasks not awaited (" + std::to_string(MAX_TASKS) + ")");
+        }
+        ++m_spawned;
+    }
+
+    auto task = std::make_shared<Task>();
+    task->xt = xt;
+    task->args = std::move(args);
+    return queue(std::move(task));
+}
+
+//------------------------------------------------------------------------------
+Int TaskPool::spawn(std::function<void(Interpreter&)>&& job)
+{
+    auto task = std::make_shared<Task>();
+    task->job = std::move(job);
+    return queue(std::move(task));
+}
+
+//------------------------------------------------------------------------------
+Int TaskPool::queue(std::shared_ptr<Task> task)
+{
+    Int handle;
+    size_t target;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        handle = m_next++;
+        m_tasks[handle] = task;
+        ++m_queued;
+        target = (t_pool == this) ? t_id : (m_round++ % m_workers.size());
+    }
+
+    {
+        Worker& worker = *m_workers[target];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queue.push_back(std::move(task));
+    }
+    m_work.notify_one();
+    return handle;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<Task> TaskPool::await(Int const handle)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_tasks.find(handle);
+    if (it == m_tasks.end())
+        return nullptr;
+
+    std::shared_ptr<Task> task = it->second;
+    m_tasks.erase(it);
+    if (!task->job)
+        --m_spawned;
+
+    if (t_pool != this)
+    {
+        m_done.wait(lock, [&]() { return task->done.load(); });
+        return task;
+    }
+
+    // Worker thread: do not block the pool, run other tasks in the meantime.
+    while (!task->done)
+    {
+        lock.unlock();
+        std::shared_ptr<Task> other = pick(t_id);
+        if (other != nullptr)
+        {
+            run(std::move(other));
+            lock.lock();
+            continue;
+        }
+        lock.lock();
+        m_done.wait(lock, [&]() { return task->done || (m_queued > 0u) || m_stop; });
+        if (m_stop)
+            break;
+    }
+    return task;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<Task> TaskPool::pick(size_t const id)
+{
+    std::shared_ptr<Task> task;
+    size_t const count = m_workers.size();
+
+    // Newest task of its own queue (hot in cache), else oldest task of the
+    // others.
+    for (size_t i = 0u; (i < count) && (task == nullptr); ++i)
+    {
+        Worker& worker = *m_workers[(id + i) % count];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.queue.empty())
+            continue;
+
+        if (i == 0u)
+        {
+            task = std::move(worker.queue.back());
+            worker.queue.pop_back();
+        }
+        else
+        {
+            task = std::move(worker.queue.front());
+            worker.queue.pop_front();
+        }
+    }
+
+    if (task != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_queued;
+    }
+    return task;
+}
+
+//------------------------------------------------------------------------------
+void TaskPool::loop(size_t const id)
+{
+    std::vector<std::unique_ptr<Interpreter>> interpreters;
+    t_pool = this;
+    t_id = id;
+    t_interpreters = &interpreters;
+
+    while (true)
+    {
+        std::shared_ptr<Task> task = pick(id);
+        if (task != nullptr)
+        {
+            run(std::move(task));
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_work.wait(lock, [this]() { return m_stop || (m_queued > 0u); });
+        if (m_stop)
+            break;
+    }
+
+    t_pool = nullptr;
+    t_interpreters = nullptr;
+}
+
+//------------------------------------------------------------------------------
+void TaskPool::run(std::shared_ptr<Task> ptr)
+{
+    Task& task = *ptr;
+    if (t_depth == t_interpreters->size())
+    {
+        t_interpreters->push_back(std::make_unique<Interpreter>(m_dictionary, m_options));
+        t_interpreters->back()->m_tasks = this;
+        t_interpreters->back()->m_natives = m_natives;
+    }
+    Interpreter& forth = *(*t_interpreters)[t_depth];
+    ++t_depth;
+
+    try
+    {
+        if (task.job)
+        {
+            task.job(forth);
+        }
+        else
+        {
+            if (task.args.size() > size_t(forth.DS.capacity()))
+            {
+                THROW("Too many arguments for the data stack");
+            }
+            for (auto const& it: task.args)
+                forth.DS.push(it);
+            forth.execute(task.xt);
+            task.results.assign(forth.DS.bottom(), forth.DS.top());
+        }
+    }
+    catch (Exception const& e)
+    {
+        task.error = e.message();
+    }
+    catch (std::exception const& e)
+    {
+        task.error = e.what();
+    }
+
+    // Interpreter::abort() would also restore the shared dictionary.
+    forth.DS.reset();
+    forth.AS.reset();
+    forth.RS.reset();
+    forth.m_heap.reset();
+    forth.m_strings.reset();
+    --t_depth;
+
+    {
+        // Release the task while locked: the awaiting thread may delete it
+        // as soon as it sees it done.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        task.done = true;
+        ptr.reset();
+    }
+    m_done.notify_all();
+}
+
+//------------------------------------------------------------------------------
+void TaskPool::join(std::vector<Int> const& handles, std::string const& word)
+{
+    std::string error;
+
+    // Jobs refer to the memory of the caller: await all of them before
+    // throwing.
+    for (auto const handle: handles)
+    {
+        std::shared_ptr<Task> task = await(handle);
+        if (error.empty())
+        {
+            if ((task == nullptr) || !task->done)
+                error = "task cancelled";
+            else
+                error = task->error;
+        }
+    }
+
+    if (!error.empty())
+    {
+        THROW(word + ": " + error);
+    }
+}
+
+//------------------------------------------------------------------------------
+Cell TaskPool::call(Interpreter& forth, Token const xt, Cell const* args,
+                    size_t const count)
+{
+    for (size_t i = 0u; i < count; ++i)
+        forth.DS.push(args[i]);
+    forth.execute(xt);
+    if (forth.DS.depth() != 1)
+    {
+        THROW("the word shall leave a single cell on the data stack");
+    }
+    return forth.DS.pop();
+}
+
+//------------------------------------------------------------------------------
+std::vector<Cell> TaskPool::map(Token const xt, std::vector<Cell> const& cells)
+{
+    verify(xt, "PAR-MAP", false);
+
+    // Each task writes its own slots: no lock needed.
+    std::vector<Cell> results(cells.size());
+    std::vector<Int> handles;
+    for (size_t begin = 0u; begin < cells.size(); begin += CHUNK)
+    {
+        size_t const end = std::min(begin + CHUNK, cells.size());
+        handles.push_back(spawn([&, begin, end](Interpreter& forth)
+        {
+            for (size_t i = begin; i < end; ++i)
+                results[i] = call(forth, xt, &cells[i], 1u);
+        }));
+    }
+
+    join(handles, "PAR-MAP");
+    return results;
+}
+
+//------------------------------------------------------------------------------
+Cell TaskPool::reduce(Token const xt, std::vector<Cell> const& cells, Cell const init)
+{
+    verify(xt, "PAR-REDUCE", false);
+
+    std::vector<Cell> partials((cells.size() + CHUNK - 1u) / CHUNK);
+    std::vector<Int> handles;
+    for (size_t c = 0u; c < partials.size(); ++c)
+    {
+        handles.push_back(spawn([&, c](Interpreter& forth)
+        {
+            size_t const end = std::min((c + 1u) * CHUNK, cells.size());
+            Cell acc[2] = { cells[c * CHUNK], Cell::integer(0) };
+            for (size_t i = c * CHUNK + 1u; i < end; ++i)
+            {
+                acc[1] = cells[i];
+                acc[0] = call(forth, xt, acc, 2u);
+            }
+            partials[c] = acc[0];
+        }));
+    }
+    join(handles, "PAR-REDUCE");
+
+    // Fold partial results in the order of chunks, on a worker interpreter
+    // too: the caller is still executing the word PAR-REDUCE.
+    Cell result = init;
+    join({ spawn([&](Interpreter& forth)
+    {
+        Cell acc[2] = { init, Cell::integer(0) };
+        for (auto const& it: partials)
+        {
+            acc[1] = it;
+            acc[0] = call(forth, xt, acc, 2u);
+        }
+        result = acc[0];
+    }) }, "PAR-REDUCE");
+
+    return result;
+}
+
+//------------------------------------------------------------------------------
+//! \brief Primitives allowed in words run by map() and reduce(): they only
+//! use the stacks of the worker interpreter or read memory.
+static bool isParallelSafe(Token const xt)
+{
+    if ((xt >= Primitives::TWOTO_ASTACK) && (xt < Primitives::LPARENT))
+        return true;
+
+    switch (xt)
+    {
+    case Primitives::NOP:
+    case Primitives::BRANCH: case Primitives::ZERO_BRANCH:
+    case Primitives::QI: case Primitives::I: case Primitives::QJ: case Primitives::J:
+    case Primitives::EXIT: case Primitives::RETURN:
+    case Primitives::PSLITERAL: case Primitives::PFLITERAL:
+    case Primitives::PILITERAL: case Primitives::PLITERAL:
+    case Primitives::PCREATE: case Primitives::PDOES:
+    case Primitives::TOKEN: case Primitives::CELL:
+    case Primitives::BYTE_FETCH: case Primitives::TOKEN_FETCH:
+    case Primitives::FLOAT_FETCH: case Primitives::CELL_FETCH:
+        return true;
+    default:
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------
+//! \brief Primitives refused in words run by spawn(): they define words,
+//! interpret or compile code, write into memory shared with the caller or
+//! execute a token which cannot be checked before running.
+static bool isTaskSafe(Token const xt)
+{
+    if ((xt >= Primitives::CLIB_BEGIN) && (xt <= Primitives::CLIB_CALLBACK))
+        return false;
+
+    switch (xt)
+    {
+    case Primitives::BYE: case Primitives::SOURCE: case Primitives::WORD:
+    case Primitives::EVALUATE: case Primitives::INCLUDE:
+    case Primitives::STORE_STRING: case Primitives::SSTRING: case Primitives::ZSTRING:
+    case Primitives::FORK: case Primitives::PAR_MAP: case Primitives::FPAR_MAP:
+    case Primitives::NEW_TASK: case Primitives::ACTIVATE:
+    case Primitives::COMPILE_ONLY: case Primitives::NONAME:
+    case Primitives::COLON: case Primitives::SEMI_COLON:
+    case Primitives::RECURSE: case Primitives::LITERAL:
+    case Primitives::CREATE: case Primitives::BUILDS: case Primitives::DOES:
+    case Primitives::IMMEDIATE: case Primitives::HIDE: case Primitives::TICK:
+    case Primitives::COMPILE: case Primitives::ICOMPILE: case Primitives::POSTPONE:
+    case Primitives::EXECUTE: case Primitives::LEFT_BRACKET: case Primitives::RIGHT_BRACKET:
+    case Primitives::FILL: case Primitives::CELLS_MOVE:
+    case Primitives::BYTE_STORE: case Primitives::TOKEN_COMMA: case Primitives::TOKEN_STORE:
+    case Primitives::CELL_COMMA: case Primitives::ALLOT: case Primitives::CELL_STORE:
+    case Primitives::CHECKPOINT: case Primitives::ROLLBACK:
+        return false;
+    default:
+        return true;
+    }
+}
+
+//------------------------------------------------------------------------------
+void TaskPool::verify(Token const xt, std::string const& word, bool const task) const
+{
+    Token const here = m_dictionary.here();
+    std::vector<bool> visited(here, false);
+    std::vector<Token> definitions;
+
+    auto check = [&](Token const token)
+    {
+        if (token < Primitives::MAX_PRIMITIVES_)
+        {
+            if (!(task ? isTaskSafe(token) : isParallelSafe(token)))
+            {
+                THROW(word + ": the word " + m_dictionary.token2name(token)
+                      + " is not allowed in the " + (task ? "task" : "parallel")
+                      + " word " + m_dictionary.token2name(xt));
+            }
+        }
+        else if (token < Primitives::MAX_PRIMITIVES_ + m_natives->count.load())
+        {
+            // C++ functions are not known to be reentrant. They cannot define
+            // words: tasks may call them.
+            if (!task)
+            {
+                THROW(word + ": the C++ function " + m_dictionary.token2name(token)
+                      + " is not allowed in the parallel word "
+                      + m_dictionary.token2name(xt));
+            }
+        }
+        else if (token >= here)
+        {
+            THROW(word + ": invalid execution token " + std::to_string(token));
+        }
+        else if (!visited[token])
+        {
+            visited[token] = true;
+            definitions.push_back(token);
+        }
+    };
+
+    check(xt);
+    while (!definitions.empty())
+    {
+        // Decode the definition until its last EXIT: an EXIT reached by a
+        // forward branch is not the end of the definition.
+        Token const definition = definitions.back();
+        Token ip = definition;
+        definitions.pop_back();
+        Token end = 0u;
+        while (true)
+        {
+            if (++ip >= here)
+            {
+                THROW(word + ": the definition of the word "
+                      + m_dictionary.token2name(definition) + " has no end");
+            }
+
+            Token const token = m_dictionary[ip];
+            check(token);
+            switch (token)
+            {
+            case Primitives::EXIT:
+            case Primitives::RETURN:
+                if (ip >= end)
+                    break;
+                continue;
+            case Primitives::BRANCH:
+            case Primitives::ZERO_BRANCH:
+                {
+                    int16_t const offset = static_cast<int16_t>(m_dictionary[ip + 1u]);
+                    if (offset > 0)
+                        end = std::max(end, Token(ip + offset + 1));
+                    ++ip;
+                }
+                continue;
+            case Primitives::PLITERAL:
+                ++ip;
+                continue;
+            case Primitives::PILITERAL:
+                ip = Token(ip + sizeof(Int) / size::token);
+                continue;
+            case Primitives::PFLITERAL:
+                ip = Token(ip + sizeof(Real) / size::token);
+                continue;
+            case Primitives::PSLITERAL:
+                ++ip;
+                ip = Token(ip + NEXT_MULTIPLE_OF_2(m_dictionary[ip] + 1) / 2);
+                continue;
+            case Primitives::PDOES:
+                // Code after DOES> is decoded like a definition.
+                ++ip;
+                if ((m_dictionary[ip] < here) && !visited[m_dictionary[ip]])
+                {
+                    visited[m_dictionary[ip]] = true;
+                    definitions.push_back(m_dictionary[ip]);
+                }
+                continue;
+            default:
+                continue;
+            }
+            break;
+        }
+    }
+}
+
+} // namespace forth
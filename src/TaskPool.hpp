@@ -0,0 +1,251 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+#ifndef INTERNAL_FORTH_TASK_POOL_HPP
+#  define INTERNAL_FORTH_TASK_POOL_HPP
+
+#  include "SimForth/Cell.hpp"
+#  include "SimForth/Options.hpp"
+#  include <atomic>
+#  include <condition_variable>
+#  include <deque>
+#  include <functional>
+#  include <memory>
+#  include <mutex>
+#  include <string>
+#  include <thread>
+#  include <unordered_map>
+#  include <vector>
+
+namespace forth
+{
+
+class Dictionary;
+class Interpreter;
+struct Natives;
+
+//******************************************************************************
+//! \brief Forth word executed by a worker thread (word SPAWN).
+//******************************************************************************
+struct Task
+{
+    //! \brief Execution token of the word to run.
+    Token xt;
+    //! \brief Data stack given to the word (bottom first).
+    std::vector<Cell> args;
+    //! \brief Data stack left by the word (bottom first).
+    std::vector<Cell> results;
+    //! \brief Error message if the word failed.
+    std::string error;
+    //! \brief If set, called instead of executing xt (words PAR-MAP and
+    //! PAR-REDUCE).
+    std::function<void(Interpreter&)> job;
+    //! \brief Set when results or error are available.
+    std::atomic<bool> done{false};
+};
+
+//******************************************************************************
+//! \brief Work-stealing pool of threads running Forth words (words SPAWN and
+//! AWAIT).
+//!
+//! Each worker thread owns an interpreter sharing the dictionary of the
+//! interpreter having created the pool: tasks shall only read it and shall
+//! keep their data in their stacks. spawn() checks the word before queuing it:
+//! defining words, words interpreting or compiling code and words storing into
+//! memory are refused (see verify()). The heap and interned strings of workers
+//! are released after each task.
+//!
+//! At most MAX_TASKS tasks spawned by words can be left not awaited: their
+//! results are kept until AWAIT.
+//!
+//! map() and reduce() split an array into chunks of CHUNK cells and run a
+//! task per chunk. The word they apply is checked before starting: it shall
+//! only compute from its stack (see verify()).
+//!
+//! Each worker has its own queue: it runs its newest task first and, when its
+//! queue is empty, steals the oldest task of another worker. Tasks spawned
+//! from a non-worker thread are distributed round-robin. A worker awaiting a
+//! task runs other tasks in the meantime instead of blocking the pool.
+//******************************************************************************
+class TaskPool
+{
+public:
+
+    //--------------------------------------------------------------------------
+    //! \brief Number of cells handled by a task of map() and reduce(). It does
+    //! not depend on the number of threads: reductions are deterministic.
+    //--------------------------------------------------------------------------
+    static constexpr size_t CHUNK = 256u;
+
+    //--------------------------------------------------------------------------
+    //! \brief Maximal number of tasks spawned by spawn(xt, args) and not yet
+    //! awaited.
+    //--------------------------------------------------------------------------
+    static constexpr size_t MAX_TASKS = 4096u;
+
+    //--------------------------------------------------------------------------
+    //! \brief Constructor. Start the worker threads.
+    //! \param[in] dictionary the dictionary shared by workers.
+    //! \param[in] options options of the worker interpreters.
+    //! \param[in] workers number of threads. 0 for the number of cores.
+    //! \param[in] natives C++ functions registered as primitives, shared
+    //! with the worker interpreters.
+    //--------------------------------------------------------------------------
+    TaskPool(Dictionary& dictionary, Options const& options, size_t workers,
+             std::shared_ptr<Natives> natives);
+
+    //--------------------------------------------------------------------------
+    //! \brief Destructor. Tasks not yet started are dropped, running tasks
+    //! are finished, then threads are joined.
+    //--------------------------------------------------------------------------
+    ~TaskPool();
+
+    TaskPool(TaskPool const&) = delete;
+    TaskPool& operator=(TaskPool const&) = delete;
+
+    //--------------------------------------------------------------------------
+    //! \brief Queue the execution of the word xt on the given data stack.
+    //! \return the handle of the task for await().
+    //! \throw Exception if the word is not allowed or if MAX_TASKS tasks are
+    //! not yet awaited.
+    //--------------------------------------------------------------------------
+    Int spawn(Token const xt, std::vector<Cell>&& args);
+
+    //--------------------------------------------------------------------------
+    //! \brief Queue the call of the job on the interpreter of a worker.
+    //! \return the handle of the task for await().
+    //--------------------------------------------------------------------------
+    Int spawn(std::function<void(Interpreter&)>&& job);
+
+    //--------------------------------------------------------------------------
+    //! \brief Wait for the end of the task. The handle is no longer valid.
+    //! \return the finished task or nullptr if the handle is not valid.
+    //--------------------------------------------------------------------------
+    std::shared_ptr<Task> await(Int const handle);
+
+    //--------------------------------------------------------------------------
+    //! \brief Apply the word xt ( x -- y ) on each cell in parallel (word
+    //! PAR-MAP).
+    //! \return the cells y in the same order than cells x.
+    //! \throw Exception if the word is not allowed or if it failed.
+    //--------------------------------------------------------------------------
+    std::vector<Cell> map(Token const xt, std::vector<Cell> const& cells);
+
+    //--------------------------------------------------------------------------
+    //! \brief Fold the cells with the word xt ( acc x -- acc' ) in parallel
+    //! (word PAR-REDUCE). Each chunk is folded from its first cell, then init
+    //! is folded with the results of chunks in their order: the word shall be
+    //! associative.
+    //! \throw Exception if the word is not allowed or if it failed.
+    //--------------------------------------------------------------------------
+    Cell reduce(Token const xt, std::vector<Cell> const& cells, Cell const init);
+
+    //--------------------------------------------------------------------------
+    //! \brief Return the number of worker threads.
+    //--------------------------------------------------------------------------
+    inline size_t size() const
+    {
+        return m_workers.size();
+    }
+
+private:
+
+    //--------------------------------------------------------------------------
+    //! \brief Queue of tasks of a worker thread.
+    //--------------------------------------------------------------------------
+    struct Worker
+    {
+        std::thread thread;
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Task>> queue;
+    };
+
+    //--------------------------------------------------------------------------
+    //! \brief Main loop of worker threads.
+    //--------------------------------------------------------------------------
+    void loop(size_t const id);
+
+    //--------------------------------------------------------------------------
+    //! \brief Pop a task from the queue of the worker id or steal one from
+    //! other workers.
+    //--------------------------------------------------------------------------
+    std::shared_ptr<Task> pick(size_t const id);
+
+    //--------------------------------------------------------------------------
+    //! \brief Execute a task on the calling worker thread.
+    //--------------------------------------------------------------------------
+    void run(std::shared_ptr<Task> task);
+
+    //--------------------------------------------------------------------------
+    //! \brief Queue the task and return its handle.
+    //--------------------------------------------------------------------------
+    Int queue(std::shared_ptr<Task> task);
+
+    //--------------------------------------------------------------------------
+    //! \brief Await all tasks and throw the error of the first failed one.
+    //--------------------------------------------------------------------------
+    void join(std::vector<Int> const& handles, std::string const& word);
+
+    //--------------------------------------------------------------------------
+    //! \brief Check the word xt and the words it calls. For map() and reduce()
+    //! they shall only use the stacks, literals, branches and memory fetches:
+    //! nothing writing into the shared dictionary or depending on the
+    //! interpreter state. For spawn() (task set) they shall not define words,
+    //! interpret or compile code, store into memory or execute tokens not
+    //! known before running.
+    //! \throw Exception naming the first forbidden word.
+    //--------------------------------------------------------------------------
+    void verify(Token const xt, std::string const& word, bool const task) const;
+
+    //--------------------------------------------------------------------------
+    //! \brief Execute the word xt on the given arguments.
+    //! \return the single cell it shall leave.
+    //--------------------------------------------------------------------------
+    static Cell call(Interpreter& forth, Token const xt, Cell const* args,
+                     size_t const count);
+
+private:
+
+    Dictionary& m_dictionary;
+    Options m_options;
+    std::shared_ptr<Natives> m_natives;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    //! \brief Protects m_tasks, m_queued and m_stop.
+    std::mutex m_mutex;
+    //! \brief Notified when a task is queued or when stopping.
+    std::condition_variable m_work;
+    //! \brief Notified when a task is done.
+    std::condition_variable m_done;
+    //! \brief Tasks not yet awaited.
+    std::unordered_map<Int, std::shared_ptr<Task>> m_tasks;
+    //! \brief Number of tasks of m_tasks spawned by words.
+    size_t m_spawned = 0u;
+    //! \brief Handle of the next task.
+    Int m_next = 1;
+    //! \brief Number of tasks waiting in queues.
+    size_t m_queued = 0u;
+    //! \brief Round-robin of tasks spawned from non-worker threads.
+    size_t m_round = 0u;
+    bool m_stop = false;
+};
+
+} // namespace forth
+
+#endif // INTERNAL_FORTH_TASK_POOL_HPP
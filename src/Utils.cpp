@@ -21,7 +21,8 @@
 #include "Utils.hpp"
 #include <termios.h> // used by key()
 #include <unistd.h>  // used by key()
-#include <climits>   // used by toInteger()
+#include <charconv>  // used by toInteger() and toReal()
+#include <type_traits> // used by toInteger()
 #include <regex.h>
 
 namespace forth
@@ -38,105 +39,163 @@ void restoreOutStates()
     std::cerr.flags(ifs2);
 }
 
-// TODO: redo it completely
-// *****************************************************************************
-bool toReal(std::string const& word, Cell& number)
+//----------------------------------------------------------------------------
+//! \brief Return the value of the digit c or 36 if c is not a digit.
+//----------------------------------------------------------------------------
+static inline int digitValue(char const c)
 {
-    char *p;
+    if ((c >= '0') && (c <= '9'))
+        return c - '0';
+    if ((c >= 'a') && (c <= 'z'))
+        return c - 'a' + 10;
+    if ((c >= 'A') && (c <= 'Z'))
+        return c - 'A' + 10;
+    return 36;
+}
 
-    errno = 0;
-    Real f = strtod(word.c_str(), &p);
-    if (errno)
-        return false;
+//----------------------------------------------------------------------------
+bool toReal(std::string_view const& word, Cell& number)
+{
+    char const* first = word.data();
+    char const* last = first + word.size();
+
+    // std::from_chars does not accept the leading '+' that strtod accepted.
+    if ((first != last) && ('+' == *first) && (first + 1 != last) && ('-' != first[1]))
+        ++first;
 
-    // Entire string valid ?
-    bool ret = (*p == 0);
-    if (ret)
-        number = Cell::real(f);
+    Real f;
+    auto const [p, ec] = std::from_chars(first, last, f);
+    if ((ec != std::errc()) || (p != last))
+        return false;
 
-    return ret;
+    number = Cell::real(f);
+    return true;
 }
 
-// TODO: redo it completely
 //----------------------------------------------------------------------------
-bool toInteger(std::string const& word, int base, Cell& number)
+bool toInteger(std::string_view const& word, int base, Cell& number)
 {
-  size_t i = 0;
-  bool negative = false;
+    size_t const size = word.size();
+    size_t i = 0;
+    bool negative = false;
 
-  // Fast checking if the string is not a float preventing integer out_of_range
-  // exception while passing huge float value such as 92233720368547758080.0
-  if (word.find('.') != std::string::npos)
-      return false;
+    if ((base < 2) || (base > 36) || (size == 0u))
+        return false;
 
-  // sign
-  if ('-' == word[i])
+    // sign
+    if ('-' == word[i])
     {
-      ++i;
-      negative = true;
+        ++i;
+        negative = true;
     }
-  else if ('+' == word[i])
+    else if ('+' == word[i])
     {
-      ++i;
+        ++i;
     }
 
-  // decimal
-  if (('&' == word[i]) || ('#' == word[i]))
+    if (i == size)
+        return false;
+
+    // decimal
+    if (('&' == word[i]) || ('#' == word[i]))
     {
-      ++i;
-      base = 10;
+        ++i;
+        base = 10;
     }
-  // binary ('b' is non standard)
-  else if (('B' == word[i]) || ('b' == word[i]) || ('%' == word[i]))
+    // binary ('b' is non standard and is a digit for bases > 11)
+    else if (('%' == word[i]) || ((base <= 11) && (('B' == word[i]) || ('b' == word[i]))))
     {
-      ++i;
-      base = 2;
+        ++i;
+        base = 2;
     }
-  // hexadecimal ('h' is non standard)
-  else if (('H' == word[i]) || ('h' == word[i]) || ('$' == word[i]))
+    // hexadecimal ('h' is non standard and is a digit for bases > 17)
+    else if (('$' == word[i]) || ((base <= 17) && (('H' == word[i]) || ('h' == word[i]))))
     {
-      ++i;
-      base = 16;
-      if (base >= 33)
-        return false;
+        ++i;
+        base = 16;
     }
-  // hexadecimal, if base < 33.
-  else if (('0' == word[i]) && (('X' == word[i + 1]) || ('x' == word[i + 1])))
+    // hexadecimal, if base < 33.
+    else if (('0' == word[i]) && (i + 1u < size) && (('X' == word[i + 1]) || ('x' == word[i + 1])))
     {
-      if (base < 33)
-        {
-          i += 2U;
-          base = 16;
-        }
-      else
+        if (base >= 33)
+            return false;
+        i += 2u;
+        base = 16;
+    }
+    // numeric value (e.g., ASCII code) an optional ' may be present
+    // after the character
+    else if ('\'' == word[i])
+    {
+        if ((3u == size) && ('\'' == word[i + 2]))
         {
-          return false;
+            number = (negative ? Cell::integer(-word[i + 1]) : Cell::integer(word[i + 1]));
+            return true;
         }
+        return false;
     }
-  // numeric value (e.g., ASCII code) an optional ' may be present
-  // after the character
-  else if ('\'' == word[i])
-  {
-      if ((3u == word.size()) && ('\'' == word[i + 2]))
-      {
-          number = (negative ? Cell::integer(-word[i + 1]) : Cell::integer(word[i + 1]));
-          return true;
-      }
-      return false;
-  }
-
-  // Try to convert the string into number
-  try
+
+    // Sign placed after the prefix (i.e. $-7B)
+    if ((i < size) && (!negative) && ('-' == word[i] || '+' == word[i]))
     {
-      std::size_t sz;
-      Int val = std::stoll(word.substr(i, word.length() - i), &sz, base);
-      number = (negative ? Cell::integer(-val) : Cell::integer(val));
-      return (sz + i) == word.length();
+        negative = ('-' == word[i]);
+        ++i;
     }
-  catch (const std::invalid_argument& /*ia*/)
+
+    // At least one digit is needed
+    if (i == size)
+        return false;
+
+    // Accumulate digits without overflowing the cell: the magnitude of the
+    // most negative integer is one more than the most positive integer.
+    using UInt = std::make_unsigned<Int>::type;
+    UInt const limit = negative
+                       ? UInt(Cell::MAX_INTEGER) + 1u
+                       : UInt(Cell::MAX_INTEGER);
+    size_t const start = i;
+    UInt val = 0u;
+    for (; i < size; ++i)
+    {
+        int const d = digitValue(word[i]);
+        if (d >= base)
+            return false;
+        if (val > (limit - UInt(d)) / UInt(base))
+            break;
+        val = val * UInt(base) + UInt(d);
+    }
+
+    if (i == size)
+    {
+        number = Cell::integer(negative ? Int(~val + 1u) : Int(val));
+        return true;
+    }
+
+    // The integer does not fit inside a cell: convert it to a float. In
+    // base 10 rely on the correctly rounded conversion, in other bases
+    // continue the accumulation with floats.
+    Real f;
+    if (base == 10)
     {
-      return false;
+        for (size_t j = i; j < size; ++j)
+        {
+            if (digitValue(word[j]) >= 10)
+                return false;
+        }
+        std::from_chars(word.data() + start, word.data() + size, f);
     }
+    else
+    {
+        f = Real(val);
+        for (; i < size; ++i)
+        {
+            int const d = digitValue(word[i]);
+            if (d >= base)
+                return false;
+            f = f * Real(base) + Real(d);
+        }
+    }
+
+    number = Cell::real(negative ? -f : f);
+    return true;
 }
 
 //----------------------------------------------------------------------------
@@ -26,6 +26,7 @@
 #  include "MyLogger/Logger.hpp"
 #  include "TerminalColor/TerminalColor.hpp"
 #  include <string>
+#  include <string_view>
 #  include <algorithm>
 #  include <cstddef>
 #  include <memory>
@@ -175,7 +176,7 @@ void restoreOutStates();
 
 //! \brief Currently open stream.
 //! \note We suppose the stack is not empty
-#  define HAS_STREAM() (SS.pick(0) != nullptr)
+#  define HAS_STREAM() ((SS.depth() > 0) && (SS.pick(0) != nullptr))
 #  define STREAM (*SS.pick(0))
 
 //! \brief Convert a string to upper case
@@ -185,6 +186,13 @@ static inline std::string& toUpper(std::string& s)
     return s;
 }
 
+//! \brief Return an upper case copy of a string view
+static inline std::string toUpper(std::string_view const& s)
+{
+    std::string u(s);
+    return toUpper(u);
+}
+
 // ***************************************************************************
 // Word entry: <NFA> <LFA> <CFA> <PFA>
 //  - NFA: Name Field Adress: adress of the begining of the word entry.
@@ -397,9 +405,6 @@ static inline Token const* NFA2PFA(Token const* nfa)
 
 #  pragma GCC diagnostic pop
 
-bool toInteger(std::string const& word, int base, Cell& number);
-bool toReal(std::string const& word, Cell& number);
-
 // ***************************************************************************
 //! \brief Escape unprintable character stored in a string
 //! \param[in] msg the string with possible invisble char.
@@ -408,17 +413,28 @@ bool toReal(std::string const& word, Cell& number);
 std::string escapeString(std::string const msg);
 
 // ***************************************************************************
-//! \brief Try converting a string into a integer value.
-//! \todo To be reworked
+//! \brief Try converting a string into a integer value. The conversion
+//! never throws exception and does not depend on the locale.
 //! \param word (in) the number to convert.
-//! \param base (in) the current base.
+//! \param base (in) the current base (2 .. 36).
 //! \param number (out) the result of the conversion if the function
-//! returned true (else the number is undefined).
+//! returned true (else the number is undefined). When the integer is too
+//! huge to be stored in a cell, number holds its float approximation.
 //! \return false if the number is malformed (not a number in the
-//! current base or too huge to store in a cell.
+//! current base).
 //! \note: prefixes 'b', 'h' and '0x' are not Forth standard.
 // ***************************************************************************
-bool toNumber(std::string const& word, int base, Cell& number);
+bool toInteger(std::string_view const& word, int base, Cell& number);
+
+// ***************************************************************************
+//! \brief Try converting a string into a float value. The conversion
+//! never throws exception and does not depend on the locale.
+//! \param word (in) the number to convert.
+//! \param number (out) the result of the conversion if the function
+//! returned true (else the number is undefined).
+//! \return false if the number is malformed.
+// ***************************************************************************
+bool toReal(std::string_view const& word, Cell& number);
 
 // ***************************************************************************
 //! \brief The word KEY awaits the entry of a single key from your terminal
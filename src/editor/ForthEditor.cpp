@@ -399,9 +399,22 @@ bool ForthEditor::interpreteScript(std::string const& script, std::string const&
     Glib::RefPtr<Gtk::TextBuffer> buf = m_results.get_buffer();
     buf->erase(buf->begin(), buf->end());
 
-    // Execute the Forth script and measure its execution time
+    // Execute the Forth script by slices and measure its execution time. GTK
+    // events are processed between slices: the IDE stays responsive during
+    // long scripts.
+    if (!m_forth.start(script.c_str()))
+    {
+        m_status_bar.push("A Forth script is already running");
+        return false;
+    }
     auto t0 = Time::now();
-    bool res = m_forth.interpretString(script.c_str());
+    Glib::RefPtr<Glib::MainContext> context = Glib::MainContext::get_default();
+    while (m_forth.run(10000u) == forth::Status::Running)
+    {
+        while (context->pending())
+            context->iteration(false);
+    }
+    bool res = (m_forth.status() == forth::Status::Success);
     auto t1 = Time::now();
 
     if (res)
@@ -38,6 +38,7 @@ static void usage(const char* fun)
     std::cout << "         " << "-p path         Append new pathes to look for file. Pathes are separated by character ':'" << std::endl;
     std::cout << "         " << "-r path         Replace pathes to look for file. Pathes are separated by character ':'" << std::endl;
     std::cout << "         " << "-i              Interactive mode. Type BYE to leave" << std::endl;
+    std::cout << "         " << "-t threads      Number of worker threads for SPAWN, PAR-MAP ... (default: number of cores)" << std::endl;
     std::cout << "         " << "-x              Do not use color when displaying dictionary" << std::endl;
 }
 
@@ -90,7 +91,7 @@ int main(int argc,char *argv[])
     }
 
     int opt;
-    while ((opt = getopt(argc, argv, "hua:l:s:f:e:p:r:dix")) != -1)
+    while ((opt = getopt(argc, argv, "hua:l:s:f:e:p:r:t:dix")) != -1)
     {
         switch (opt)
         {
@@ -147,6 +148,10 @@ int main(int argc,char *argv[])
                 forth.interactive();
                 break;
 
+            case 't':
+                forth.setWorkers(size_t(atoi(optarg)));
+                break;
+
             case 'p':
                 forth.path().add(optarg);
                 std::cout << "Path='" << forth.path().toString() << "'" << std::endl;
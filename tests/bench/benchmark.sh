@@ -6,6 +6,9 @@ PFORTH_DIR="/home/qq/pforth/build/unix"
 SIMFORTH_DIR="/home/qq/MyGitHub/SimForth/build"
 SIMTADYN_DIR="/home/qq/MyGitHub/SimTaDyn/src/forth/standalone/build"
 
+# Scripts generated at run time
+./numbers.sh > numbers.fth
+
 echo -n "file" > $OUTPUT
 for FORTH in "${FORTHS[@]}"
 do
@@ -35,3 +38,5 @@ do
 	rm -f foo
     done
 done
+
+rm -f numbers.fth
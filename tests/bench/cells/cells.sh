@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# Tagged (16-byte) versus packed (8-byte, -DUSE_PACKED_CELL) cells.
+# Build SimForth twice, once with each cell layout, then:
+# Usage: ./cells.sh <tagged SimForth binary> <packed SimForth binary>
+
+if [ "$#" -ne 2 ]; then
+    echo "Usage: $0 <tagged SimForth binary> <packed SimForth binary>"
+    exit 1
+fi
+
+OUTPUT='cells_results.csv'
+FILE="$(dirname $0)/cells.fth"
+
+echo "cells,time,speedup" > $OUTPUT
+REFERENCE=
+for BUILD in "tagged:$1" "packed:$2"
+do
+    NAME="${BUILD%%:*}"
+    SIMFORTH="${BUILD#*:}"
+    echo "Benchmarking $NAME cells ..."
+    START=$(date +%s.%N)
+    ${SIMFORTH} -f ${FILE} > /dev/null 2>&1
+    END=$(date +%s.%N)
+
+    ELAPSED=$(echo "$END - $START" | bc)
+    if [ -z "$REFERENCE" ]; then
+        REFERENCE=$ELAPSED
+    fi
+    SPEEDUP=$(echo "scale=2; $REFERENCE / $ELAPSED" | bc)
+    echo "$NAME,$ELAPSED,$SPEEDUP" >> $OUTPUT
+    echo "  ${ELAPSED}s speedup x${SPEEDUP}"
+done
@@ -0,0 +1,29 @@
+#!/bin/bash
+
+# Generate a numeric literal heavy script for the benchmark: decimal, hexa,
+# binary, prefixed decimal and float literals, each one dropped.
+# Usage: ./numbers.sh [number of literals] > numbers.fth
+
+COUNT="${1:-20000}"
+
+awk -v count="$COUNT" 'BEGIN {
+    srand(42);
+    for (i = 0; i < count; ++i) {
+        n = int(rand() * 1000000000);
+        kind = i % 5;
+        if (kind == 0) {
+            printf("%d DROP\n", n);
+        } else if (kind == 1) {
+            printf("$%X DROP\n", n);
+        } else if (kind == 2) {
+            s = ""; b = n % 256;
+            for (k = 0; k < 8; ++k) { s = (b % 2) s; b = int(b / 2); }
+            printf("%%%s DROP\n", s);
+        } else if (kind == 3) {
+            printf("#%d DROP\n", n % 1000000);
+        } else {
+            printf("%.6f DROP\n", (rand() - 0.5) * 2000.0);
+        }
+    }
+    print "bye";
+}'
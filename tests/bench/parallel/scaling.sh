@@ -0,0 +1,27 @@
+#!/bin/bash
+
+# Scaling of PAR-MAP and PAR-REDUCE with the number of worker threads.
+# Usage: ./scaling.sh [path of the SimForth binary]
+
+readonly THREADS=( 1 2 4 8 16 32 64 )
+SIMFORTH="${1:-../../../build/SimForth}"
+OUTPUT='scaling_results.csv'
+FILE="$(dirname $0)/par-map.fth"
+
+echo "threads,time,speedup" > $OUTPUT
+REFERENCE=
+for T in "${THREADS[@]}"
+do
+    echo "Benchmarking $T threads ..."
+    START=$(date +%s.%N)
+    ${SIMFORTH} -t $T -f ${FILE} > /dev/null 2>&1
+    END=$(date +%s.%N)
+
+    ELAPSED=$(echo "$END - $START" | bc)
+    if [ -z "$REFERENCE" ]; then
+        REFERENCE=$ELAPSED
+    fi
+    SPEEDUP=$(echo "scale=2; $REFERENCE / $ELAPSED" | bc)
+    echo "$T,$ELAPSED,$SPEEDUP" >> $OUTPUT
+    echo "  ${ELAPSED}s speedup x${SPEEDUP}"
+done
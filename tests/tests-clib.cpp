@@ -19,6 +19,7 @@
 //==============================================================================
 
 #include "main.hpp"
+#include <sys/stat.h>
 
 #define protected public
 #define private public
@@ -133,7 +134,7 @@ END-C-LIB)FORTH";
     ASSERT_EQ(forth.dataStack().depth(), 0);
     ASSERT_EQ(forth.interpretString("HELLO"), true);
     ASSERT_EQ(forth.dataStack().depth(), 1);
-    Int val = forth.dataStack().pop().i;
+    Int val = forth.dataStack().pop().integer();
     ASSERT_EQ(val, 42);
 }
 
@@ -165,8 +166,16 @@ END-C-LIB)FORTH";
     // Run
     ASSERT_EQ(forth.interpretString("42 HELLO"), true);
     ASSERT_EQ(forth.dataStack().depth(), 1);
-    Int val = forth.dataStack().pop().i;
+    Int val = forth.dataStack().pop().integer();
     ASSERT_EQ(val, 84);
+
+    // C functions are primitives checking the depth of the stack
+    Token xt; bool immediate;
+    ASSERT_EQ(forth.dictionary().findWord("HELLO", xt, immediate), true);
+    ASSERT_EQ(forth.interpreter().isPrimitive(xt), true);
+    ASSERT_EQ(forth.interpretString("HELLO"), false);
+    ASSERT_EQ(forth.interpretString(": FOO 1 HELLO HELLO ; FOO"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 4);
 }
 
 // Check Call C function with two inputs and a single output
@@ -198,7 +207,7 @@ END-C-LIB)FORTH";
     // Run
     ASSERT_EQ(forth.interpretString("42 66 HELLO"), true);
     ASSERT_EQ(forth.dataStack().depth(), 1);
-    Int val = forth.dataStack().pop().i;
+    Int val = forth.dataStack().pop().integer();
     ASSERT_EQ(val, 108);
 }
 
@@ -253,10 +262,14 @@ C-FUNCTION BAD bad
 END-C-LIB)FORTH";
     toString("/tmp/f1.fth", script);
 
-    // Compile even with
+    // Compiled in background: errors are reported at the first call
+    ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 0);
+
+    // Run
     std::stringstream buffer;
     std::streambuf* old = std::cerr.rdbuf(buffer.rdbuf());
-    ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), false);
+    ASSERT_EQ(forth.interpretString("BAD"), false);
     std::cerr.rdbuf(old);
     EXPECT_THAT(buffer.str().c_str(), HasSubstr("[ERROR]"));
 #ifdef __APPLE__
@@ -266,14 +279,13 @@ END-C-LIB)FORTH";
 #endif
     ASSERT_EQ(forth.dataStack().depth(), 0);
 
-    // Run
+    // Still failing
     buffer.str(std::string());
     old = std::cerr.rdbuf(buffer.rdbuf());
     ASSERT_EQ(forth.interpretString("BAD"), false);
     std::cerr.rdbuf(old);
     ASSERT_EQ(forth.dataStack().depth(), 0);
     EXPECT_THAT(buffer.str().c_str(), HasSubstr("[ERROR]"));
-    EXPECT_THAT(buffer.str().c_str(), HasSubstr("Unknown word BAD"));
 }
 
 // Try to compile a C code but look for the wrong symbol
@@ -294,25 +306,352 @@ C-FUNCTION HELLO bad
 END-C-LIB)FORTH";
     toString("/tmp/f1.fth", script);
 
-    // Compile even with
+    // Compiled in background: errors are reported at the first call
+    ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 0);
+
+    // Run
     std::stringstream buffer;
     std::streambuf* old = std::cerr.rdbuf(buffer.rdbuf());
-    ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), false);
+    ASSERT_EQ(forth.interpretString("HELLO"), false);
     std::cerr.rdbuf(old);
+    ASSERT_EQ(forth.dataStack().depth(), 0);
     EXPECT_THAT(buffer.str().c_str(), HasSubstr("[ERROR]"));
 #ifdef __APPLE__
     EXPECT_THAT(buffer.str().c_str(), HasSubstr("Symbol not found: _bad"));
 #else
     EXPECT_THAT(buffer.str().c_str(), HasSubstr("undefined symbol: bad"));
 #endif
-    ASSERT_EQ(forth.dataStack().depth(), 0);
+}
 
-    // Run
-    buffer.str(std::string());
-    old = std::cerr.rdbuf(buffer.rdbuf());
-    ASSERT_EQ(forth.interpretString("HELLO"), false);
-    std::cerr.rdbuf(old);
+// Check the second compilation of the same C code is taken from the cache
+TEST(CheckForth, CLibCache)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    std::string script = R"FORTH(
+C-LIB libcached
+\C int cached_add(int a, int b) { return a + b; }
+C-FUNCTION CACHED-ADD cached_add i i -- i
+END-C-LIB)FORTH";
+    toString("/tmp/f1.fth", script);
+
+    {
+        SimForth forth(options);
+        ASSERT_EQ(forth.boot(), true);
+        ASSERT_EQ(forth.interpretString("C-LIB-CACHE-CLEAR"), true);
+        ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+        ASSERT_EQ(forth.m_interpreter->m_clibs.cached(), false);
+        ASSERT_EQ(forth.interpretString("1 2 CACHED-ADD"), true);
+        ASSERT_EQ(forth.dataStack().pop().integer(), 3);
+    }
+
+    // Warm boot: no compilation
+    {
+        SimForth forth(options);
+        ASSERT_EQ(forth.boot(), true);
+        ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+        ASSERT_EQ(forth.m_interpreter->m_clibs.cached(), true);
+        ASSERT_EQ(forth.interpretString("3 4 CACHED-ADD"), true);
+        ASSERT_EQ(forth.dataStack().pop().integer(), 7);
+    }
+
+    // Other code: other library
+    {
+        SimForth forth(options);
+        ASSERT_EQ(forth.boot(), true);
+        std::string::size_type pos = script.find("a + b");
+        toString("/tmp/f1.fth", script.replace(pos, 5u, "a * b"));
+        ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+        ASSERT_EQ(forth.m_interpreter->m_clibs.cached(), false);
+        ASSERT_EQ(forth.interpretString("3 4 CACHED-ADD"), true);
+        ASSERT_EQ(forth.dataStack().pop().integer(), 12);
+    }
+
+    ASSERT_GE(CLib::clearCache(), 2u);
+    ASSERT_EQ(CLib::clearCache(), 0u);
+
+    // The cache is a folder of the user: not used when others can write in
+    char const* xdg = getenv("XDG_CACHE_HOME");
+    std::string const old = (xdg != nullptr) ? xdg : "";
+    setenv("XDG_CACHE_HOME", "/tmp/simforth-xdg", 1);
+    for (int i = 0; i < 2; ++i)
+    {
+        SimForth forth(options);
+        ASSERT_EQ(forth.boot(), true);
+        ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+        ASSERT_EQ(forth.m_interpreter->m_clibs.cached(), i == 1);
+        ASSERT_EQ(forth.interpretString("3 4 CACHED-ADD"), true);
+        ASSERT_EQ(forth.dataStack().pop().integer(), 12);
+    }
+    struct stat st;
+    ASSERT_EQ(stat("/tmp/simforth-xdg/simforth", &st), 0);
+    ASSERT_EQ(st.st_mode & 0777, 0700u);
+    ASSERT_EQ(chmod("/tmp/simforth-xdg/simforth", 0777), 0);
+    {
+        SimForth forth(options);
+        ASSERT_EQ(forth.boot(), true);
+        ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+        ASSERT_EQ(forth.m_interpreter->m_clibs.cached(), false);
+        ASSERT_EQ(forth.interpretString("3 4 CACHED-ADD"), true);
+        ASSERT_EQ(forth.dataStack().pop().integer(), 12);
+    }
+    ASSERT_EQ(chmod("/tmp/simforth-xdg/simforth", 0700), 0);
+    ASSERT_EQ(CLib::clearCache(), 1u);
+    if (old.empty())
+        unsetenv("XDG_CACHE_HOME");
+    else
+        setenv("XDG_CACHE_HOME", old.c_str(), 1);
+}
+
+// Check several libraries are compiled in parallel and bound when used
+TEST(CheckForth, CLibAsync)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+    ASSERT_EQ(forth.interpretString("C-LIB-CACHE-CLEAR"), true);
+
+    std::string script = R"FORTH(
+C-LIB libasync1
+\C int async_add(int a, int b) { return a + b; }
+C-FUNCTION ASYNC-ADD async_add i i -- i
+END-C-LIB
+C-LIB libasync2
+\C int async_mul(int a, int b) { return a * b; }
+C-FUNCTION ASYNC-MUL async_mul i i -- i
+END-C-LIB
+C-LIB libasync3
+\C int async_sub(int a, int b) { return a - b; }
+C-FUNCTION ASYNC-SUB async_sub i i -- i
+END-C-LIB)FORTH";
+    toString("/tmp/f1.fth", script);
+
+    ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+    ASSERT_EQ(forth.m_interpreter->m_clibs.m_libraries.size(), 3u);
+    ASSERT_EQ(forth.interpretString("6 7 ASYNC-MUL 2 ASYNC-SUB 3 ASYNC-ADD"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 43);
+    ASSERT_EQ(forth.m_interpreter->m_clibs.wait(), true);
+
+    // First calls from several worker threads: the library is bound once
+    toString("/tmp/f1.fth", R"FORTH(
+C-LIB libasync4
+\C int async_neg(int a) { return -a; }
+C-FUNCTION ASYNC-NEG async_neg i -- i
+END-C-LIB)FORTH");
+    forth.setWorkers(4u);
+    ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+    ASSERT_EQ(forth.interpretString(
+                  ": NEG ASYNC-NEG ; 1 1 ' NEG SPAWN 2 1 ' NEG SPAWN 3 1 ' NEG SPAWN "
+                  "4 1 ' NEG SPAWN AWAIT SWAP AWAIT + SWAP AWAIT + SWAP AWAIT +"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), -10);
+
+    // Functions declared after a checkpoint are forgotten with their tokens
+    size_t const natives = forth.m_interpreter->m_natives->count.load();
+    size_t const id = forth.checkpoint();
+    toString("/tmp/f1.fth", R"FORTH(
+C-LIB libasync5
+\C int async_dec(int a) { return a - 1; }
+C-FUNCTION ASYNC-DEC async_dec i -- i
+END-C-LIB)FORTH");
+    ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+    ASSERT_EQ(forth.m_interpreter->m_natives->count.load(), natives + 1u);
+    ASSERT_EQ(forth.rollback(id), true);
+    ASSERT_EQ(forth.has("ASYNC-DEC"), false);
+    ASSERT_EQ(forth.m_interpreter->m_natives->count.load(), natives);
+    toString("/tmp/f1.fth", R"FORTH(
+C-LIB libasync6
+\C int async_inc(int a) { return a + 1; }
+C-FUNCTION ASYNC-INC async_inc i -- i
+END-C-LIB)FORTH");
+    ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+    ASSERT_EQ(forth.interpretString("41 ASYNC-INC 5 ASYNC-NEG"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), -5);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 42);
+}
+
+// Check C functions are bound with dlsym without compiling C code
+TEST(CheckForth, CLibImport)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+    ASSERT_EQ(forth.interpretString("C-IMPORT LABS - labs l -- l"), true);
+    ASSERT_EQ(forth.interpretString("C-IMPORT ABS - abs i -- i"), true);
+    ASSERT_EQ(forth.interpretString("C-IMPORT HYPOT - hypot f f -- f"), true);
+    ASSERT_EQ(forth.interpretString("C-IMPORT SRAND - srand i"), true);
+    ASSERT_EQ(forth.interpretString("-42 LABS -7 ABS"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 7);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 42);
+    ASSERT_EQ(forth.interpretString("3.0 4.0 HYPOT"), true);
+    ASSERT_EQ(forth.dataStack().pop().real(), 5.0);
+    ASSERT_EQ(forth.interpretString("1 SRAND"), true);
     ASSERT_EQ(forth.dataStack().depth(), 0);
-    EXPECT_THAT(buffer.str().c_str(), HasSubstr("[ERROR]"));
-    EXPECT_THAT(buffer.str().c_str(), HasSubstr("Unknown word HELLO"));
+
+    // Functions are called with their exact C prototype: i is an int
+    ASSERT_EQ(forth.interpretString("C-IMPORT LDEXP - ldexp f i -- f"), true);
+    ASSERT_EQ(forth.interpretString("1.5 3 LDEXP"), true);
+    ASSERT_EQ(forth.dataStack().pop().real(), 12.0);
+    ASSERT_EQ(forth.interpretString("-4294967289 ABS"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 7);
+
+    // Imported words are compiled as primitives
+    ASSERT_EQ(forth.interpretString(": FOO -5 ABS 2 ABS + ; FOO"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 7);
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+    // More than 4 parameters: generic trampoline
+    ASSERT_EQ(forth.interpretString("C-IMPORT MMAP - mmap a l i i i l -- a"), true);
+    ASSERT_EQ(forth.interpretString("C-IMPORT MUNMAP - munmap a l -- i"), true);
+    ASSERT_EQ(forth.interpretString("0 4096 1 34 -1 0 MMAP DUP 4096 MUNMAP"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+    ASSERT_NE(forth.dataStack().pop().integer(), -1);
+#endif
+
+    // Errors
+    ASSERT_EQ(forth.interpretString("C-IMPORT FOO - this_symbol_does_not_exist i"), false);
+    ASSERT_EQ(forth.interpretString("C-IMPORT FOO libnotexisting abs i -- i"), false);
+    ASSERT_EQ(forth.interpretString("C-IMPORT FOO - abs x -- i"), false);
+    ASSERT_EQ(forth.interpretString("C-IMPORT FOO - abs i -- i i"), false);
+    ASSERT_EQ(forth.interpretString("ABS"), false);
+}
+
+// Check Forth buffers are given to C functions as arrays without copy
+TEST(CheckForth, CLibArrays)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+
+    std::string script = R"FORTH(
+C-LIB libarrays
+\C double fsum(double const* x, int64_t n) { double s = 0.0; for (int64_t i = 0; i < n; ++i) s += x[i]; return s; }
+\C int64_t isum(int64_t const* x, int64_t n) { int64_t s = 0; for (int64_t i = 0; i < n; ++i) s += x[i]; return s; }
+\C void iota(int64_t* x, int64_t n) { for (int64_t i = 0; i < n; ++i) x[i] = i + 1; }
+C-FUNCTION FSUM fsum f[] i -- f
+C-FUNCTION ISUM isum i[] i -- i
+C-FUNCTION IOTA iota i[] i
+END-C-LIB)FORTH";
+    toString("/tmp/f1.fth", script);
+    ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+
+    // Dictionary buffer
+    ASSERT_EQ(forth.interpretString("HERE NEGATE 3 AND ALLOT HERE 1.5 , 2.5 , 3.0 , 3 3 FSUM"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().real(), 7.0);
+
+    // Buffers of a task belong to the interpreter of its worker: the block
+    // of the worker has the same address than the one of the main thread
+    ASSERT_EQ(forth.interpretString(
+                  ": WORK 12 ALLOCATE DROP DUP 3 3 IOTA 3 3 ISUM ;\n"
+                  "12 ALLOCATE DROP 100 OVER ! 0 ' WORK SPAWN AWAIT SWAP @"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 2);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 100);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 6);
+
+    // Heap buffer modified by the C function
+    ASSERT_EQ(forth.interpretString("12 ALLOCATE DROP DUP 3 3 IOTA 3 3 ISUM"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 6);
+
+    // Invalid ranges
+    ASSERT_EQ(forth.interpretString("HERE -1 1 ISUM"), false);
+    ASSERT_EQ(forth.interpretString("12 ALLOCATE DROP 100000000 DUP ISUM"), false);
+    ASSERT_EQ(forth.interpretString("HERE 1 ISUM"), false);
+
+    // Arrays shall be aligned on 8 bytes (4 tokens)
+    ASSERT_EQ(forth.interpretString("12 ALLOCATE DROP 1 + 1 1 ISUM"), false);
+    ASSERT_EQ(forth.interpretString("12 ALLOCATE DROP 2 + 1 1 ISUM"), false);
+    ASSERT_EQ(forth.interpretString("HERE NEGATE 3 AND 1+ ALLOT HERE 1 1 ISUM"), false);
+    ASSERT_EQ(forth.interpretString("12 ALLOCATE DROP 4 + 7 OVER ! 1 1 ISUM"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 7);
+}
+
+// Check C functions calling back Forth words
+TEST(CheckForth, CLibCallback)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+
+    std::string script = R"FORTH(
+C-LIB libcallback
+\C int64_t fold(int64_t (*f)(int64_t, int64_t), int64_t n) { int64_t s = 0; for (int64_t i = 1; i <= n; ++i) s = f(s, i); return s; }
+\C double integrate(double (*f)(double), int64_t n) { double s = 0.0; for (int64_t i = 0; i < n; ++i) s += f((i + 0.5) / n) / n; return s; }
+\C int64_t count(int (*pred)(int), int64_t n) { int64_t c = 0; for (int i = -n; i <= n; ++i) c += (pred(i) != 0); return c; }
+\C void each(void (*f)(int64_t), int64_t n) { for (int64_t i = 0; i < n; ++i) f(i); }
+C-FUNCTION FOLD fold a i -- i
+C-FUNCTION INTEGRATE integrate a i -- f
+C-FUNCTION COUNT count a i -- i
+C-FUNCTION EACH each a i
+END-C-LIB
+: ADD-SQ DUP * + ;
+: SQ DUP * ;
+: NEG? 0 < ;
+: SUMSQ 3 FOLD 100 + ;
+: BAD DROP DROP ;)FORTH";
+    toString("/tmp/f1.fth", script);
+    ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+
+    ASSERT_EQ(forth.interpretString("' ADD-SQ C-CALLBACK l l -- l\n3 FOLD"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 14);
+
+    // The same word gets the same C function
+    ASSERT_EQ(forth.interpretString("' ADD-SQ C-CALLBACK l l -- l\n' ADD-SQ C-CALLBACK l l -- l"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), forth.dataStack().pop().integer());
+
+    // IP of the calling definition is restored
+    ASSERT_EQ(forth.interpretString("' ADD-SQ C-CALLBACK l l -- l\nSUMSQ"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 114);
+
+    ASSERT_EQ(forth.interpretString("' SQ C-CALLBACK f -- f\n1000 INTEGRATE"), true);
+    ASSERT_NEAR(forth.dataStack().pop().real(), 1.0 / 3.0, 1e-6);
+
+    ASSERT_EQ(forth.interpretString("' NEG? C-CALLBACK i -- i\n5 COUNT"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 5);
+
+    ASSERT_EQ(forth.interpretString("42 ' DROP C-CALLBACK l\n3 EACH"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 42);
+
+    // Errors are thrown again when the C function returns
+    ASSERT_EQ(forth.interpretString("' BAD C-CALLBACK l\n3 EACH"), false);
+    ASSERT_EQ(forth.interpretString("' ADD-SQ C-CALLBACK l l -- l\n2 FOLD"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 5);
+    ASSERT_EQ(forth.interpretString("' SQ C-CALLBACK f f f f f -- f"), false);
+    ASSERT_EQ(forth.interpretString("' SQ C-CALLBACK x"), false);
+
+    // A thunk called on another thread is refused: it returns 0 and the
+    // error is thrown when the C function returns
+    toString("/tmp/f1.fth", R"FORTH(
+C-LIB libcallback2
+\C #include <pthread.h>
+\C struct away { int64_t (*f)(int64_t, int64_t); int64_t r; };
+\C static void* away_run(void* p) { struct away* a = p; a->r = a->f(3, 4) + 1; return NULL; }
+\C int64_t away(int64_t (*f)(int64_t, int64_t)) { struct away a = { f, 0 }; pthread_t t; pthread_create(&t, NULL, away_run, &a); pthread_join(t, NULL); return a.r; }
+C-FUNCTION AWAY away a -- i
+END-C-LIB)FORTH");
+    ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
+    ASSERT_EQ(forth.interpretString("' ADD-SQ C-CALLBACK l l -- l\nAWAY"), false);
+    ASSERT_EQ(forth.interpretString("' ADD-SQ C-CALLBACK l l -- l\n2 FOLD"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 5);
+
+    // Thunks of the words forgotten by a rollback are released: C code
+    // still calling them gets 0 and their slots are taken again
+    Int stale = 0;
+    for (int i = 0; i < 12; ++i)
+    {
+        size_t const id = forth.checkpoint();
+        ASSERT_EQ(forth.interpretString(": TMP NEG? ; ' TMP C-CALLBACK i -- i"), true);
+        stale = forth.dataStack().pop().integer();
+        ASSERT_EQ(forth.rollback(id), true);
+    }
+    forth.dataStack().push(Cell::integer(stale));
+    ASSERT_EQ(forth.interpretString("5 COUNT"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
 }
@@ -19,6 +19,8 @@
 //==============================================================================
 
 #include "main.hpp"
+#include <cmath>
+#include <thread>
 
 #define protected public
 #define private public
@@ -35,6 +37,48 @@ TEST(CheckForth, Size)
 {
     ASSERT_EQ(sizeof(Int), sizeof(Real));
     ASSERT_EQ(size::cell, sizeof(Real));
+#ifdef USE_PACKED_CELL
+    ASSERT_EQ(sizeof(Cell), sizeof(Int));
+#endif
+}
+
+// Check mixing integers and floats inside cells
+TEST(CheckForth, CellTypes)
+{
+    Cell c = Cell::integer(-42);
+    ASSERT_EQ(c.isInteger(), true);
+    ASSERT_EQ(c.isReal(), false);
+    ASSERT_EQ(c.integer(), -42);
+    ASSERT_EQ(c.real(), -42.0);
+
+    c += Cell::integer(2);
+    ASSERT_EQ(c.isInteger(), true);
+    ASSERT_EQ(c.integer(), -40);
+
+    c *= Cell::real(0.5);
+    ASSERT_EQ(c.isReal(), true);
+    ASSERT_EQ(c.real(), -20.0);
+    ASSERT_EQ(c.integer(), -20);
+
+    c = Cell::real(-2.5);
+    ASSERT_EQ(c.integer(), -3);
+    ++c;
+    ASSERT_EQ(c.real(), -1.5);
+    ASSERT_EQ(c < Cell::integer(0), true);
+    ASSERT_EQ(c == Cell::real(-1.5), true);
+
+    c = Cell::integer(0xF0);
+    c &= Cell::integer(0x3C);
+    ASSERT_EQ(c.integer(), 0x30);
+    c |= Cell::integer(0x01);
+    ASSERT_EQ(c.integer(), 0x31);
+    c ^= Cell::integer(0xFF);
+    ASSERT_EQ(c.integer(), 0xCE);
+    ASSERT_EQ(c.byte(0), char(0xCE));
+
+    c = Cell::integer(-1);
+    c /= Cell::integer(2);
+    ASSERT_EQ(c.integer(), 0);
 }
 
 // Check skipping comments
@@ -367,6 +411,37 @@ TEST(CheckForth, Includes)
     ASSERT_EQ(forth.dataStack().pick(0).integer(), 6);
 }
 
+// Check evaluate of strings
+TEST(CheckForth, Evaluate)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+
+    ASSERT_EQ(forth.boot(), true);
+    ASSERT_EQ(forth.interpretString("S\" 1 2 +\" EVALUATE"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 3);
+
+    // Only the given number of chars is evaluated
+    ASSERT_EQ(forth.interpretString("S\" 1 2 + 99\" 3 - EVALUATE"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 3);
+
+    // Strings from HERE are copied: the definition compiled by the script
+    // overwrites them
+    ASSERT_EQ(forth.interpretString("HERE ,\" : SQ DUP * ; 3 SQ\" "
+                                    "DUP HERE - ALLOT 1+ 17 EVALUATE"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 9);
+
+    // Strings outside the dictionary
+    ASSERT_EQ(forth.interpretString("HERE 100 + 100000000 EVALUATE"), false);
+    ASSERT_EQ(forth.interpretString("-5 3 EVALUATE"), false);
+    ASSERT_EQ(forth.interpretString("HERE -3 EVALUATE"), false);
+    ASSERT_EQ(forth.dataStack().depth(), 0);
+}
+
 // Check immediate
 TEST(CheckForth, Immediate)
 {
@@ -453,7 +528,7 @@ TEST(CheckForth, Here)
     // Initial position
     ASSERT_EQ(forth.interpretString("HERE"), true);
     ASSERT_EQ(forth.dataStack().depth(), 1);
-    size_t here = size_t(forth.dataStack().pop().i);
+    size_t here = size_t(forth.dataStack().pop().integer());
     ASSERT_EQ(forth.dataStack().depth(), 0);
 
     // 10 tokens
@@ -461,7 +536,7 @@ TEST(CheckForth, Here)
     ASSERT_EQ(forth.dataStack().depth(), 0);
     ASSERT_EQ(forth.interpretString("HERE"), true);
     ASSERT_EQ(forth.dataStack().depth(), 1);
-    size_t here_allot = size_t(forth.dataStack().pop().i);
+    size_t here_allot = size_t(forth.dataStack().pop().integer());
     ASSERT_EQ(here_allot, here + 10);
 
     // 10 cells
@@ -469,7 +544,7 @@ TEST(CheckForth, Here)
     ASSERT_EQ(forth.dataStack().depth(), 0);
     ASSERT_EQ(forth.interpretString("HERE"), true);
     ASSERT_EQ(forth.dataStack().depth(), 1);
-    here_allot = size_t(forth.dataStack().pop().i);
+    here_allot = size_t(forth.dataStack().pop().integer());
     ASSERT_EQ(here_allot, here + 10 + 10 * size::cell / size::token);
 
     // 1 token
@@ -477,7 +552,7 @@ TEST(CheckForth, Here)
     ASSERT_EQ(forth.dataStack().depth(), 0);
     ASSERT_EQ(forth.interpretString("HERE"), true);
     ASSERT_EQ(forth.dataStack().depth(), 1);
-    size_t here_allot_comma = size_t(forth.dataStack().pop().i);
+    size_t here_allot_comma = size_t(forth.dataStack().pop().integer());
     ASSERT_EQ(here_allot_comma, here_allot + 1);
 
     // 1 cell
@@ -485,7 +560,7 @@ TEST(CheckForth, Here)
     ASSERT_EQ(forth.dataStack().depth(), 0);
     ASSERT_EQ(forth.interpretString("HERE"), true);
     ASSERT_EQ(forth.dataStack().depth(), 1);
-    here_allot_comma = size_t(forth.dataStack().pop().i);
+    here_allot_comma = size_t(forth.dataStack().pop().integer());
     ASSERT_EQ(here_allot_comma, here_allot + 1 + size::cell / size::token);
 }
 
@@ -666,6 +741,896 @@ TEST(CheckForth, DetectUnsecureCode)
     EXPECT_THAT(buffer.str().c_str(), HasSubstr("ried to execute a token outside the last definition"));
 }
 
+//
+TEST(CheckForth, StackGuards)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+
+    auto failure = [&forth](char const* script) -> std::string
+    {
+        std::stringstream buffer;
+        std::streambuf* old = std::cerr.rdbuf(buffer.rdbuf());
+        bool res = forth.interpretString(script);
+        std::cerr.rdbuf(old);
+        EXPECT_EQ(res, false);
+        return buffer.str();
+    };
+
+    // Stack underflows detected by guard pages
+    EXPECT_THAT(failure("+"), HasSubstr("Data-Stack underflow caused by word +"));
+    EXPECT_THAT(failure("1 SWAP"), HasSubstr("Data-Stack underflow caused by word SWAP"));
+    EXPECT_THAT(failure("R>"), HasSubstr("Auxiliary-Stack underflow caused by word R>"));
+
+    // Words with side effects check the depth first: memory is unchanged
+    ASSERT_EQ(forth.interpretString("VARIABLE X 7 X ! 0 @ 0 TOKEN@"), true);
+    Cell const token = forth.dataStack().pop();
+    Cell const cell = forth.dataStack().pop();
+    EXPECT_THAT(failure("X !"), HasSubstr("Data-Stack underflow caused by word !"));
+    EXPECT_THAT(failure("!"), HasSubstr("Data-Stack underflow caused by word !"));
+    EXPECT_THAT(failure("X TOKEN!"), HasSubstr("Data-Stack underflow caused by word TOKEN!"));
+    EXPECT_THAT(failure("EXECUTE"), HasSubstr("Data-Stack underflow caused by word EXECUTE"));
+    EXPECT_THAT(failure("2>R"), HasSubstr("Data-Stack underflow caused by word 2>R"));
+    EXPECT_THAT(failure("0 SPAWN"), HasSubstr("Data-Stack underflow caused by word SPAWN"));
+    ASSERT_EQ(forth.interpretString("X @ 0 @ 0 TOKEN@"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 3);
+    EXPECT_EQ(forth.dataStack().pop().integer(), token.integer());
+    EXPECT_EQ(forth.dataStack().pop().integer(), cell.integer());
+    EXPECT_EQ(forth.dataStack().pop().integer(), 7);
+
+    // Return stack overflow on deep recursion
+    ASSERT_EQ(forth.interpretString(": DEEP DUP 0> IF 1- RECURSE THEN ;"), true);
+    EXPECT_THAT(failure("100000 DEEP"), HasSubstr("Return-Stack overflow caused by word DEEP"));
+
+    // The word whose execution hit the guard page is reported
+    ASSERT_EQ(forth.interpretString(": G RECURSE ; : F 1 RECURSE ;"), true);
+    EXPECT_THAT(failure("G"), HasSubstr("Return-Stack overflow caused by word G"));
+    EXPECT_THAT(failure("F"), HasSubstr("Data-Stack overflow caused by word (TOKEN)"));
+
+    // The interpreter is still usable
+    ASSERT_EQ(forth.interpretString("10 DEEP 1 2 +"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 2);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 3);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+
+    // Larger stacks can be requested
+    options.return_stack_depth = 200000u;
+    SimForth big(options);
+    ASSERT_EQ(big.boot(), true);
+    ASSERT_EQ(big.interpretString(": DEEP DUP 0> IF 1- RECURSE THEN ; 100000 DEEP"), true);
+    ASSERT_EQ(big.dataStack().depth(), 1);
+    ASSERT_EQ(big.dataStack().pop().integer(), 0);
+}
+
+//
+TEST(CheckForth, Heap)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+
+    // Buffer larger than the dictionary
+    ASSERT_EQ(forth.interpretString("VARIABLE BUF 100000 CELLS ALLOCATE"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 2);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+    ASSERT_EQ(forth.interpretString("BUF !"), true);
+    ASSERT_EQ(forth.interpretString(
+                  ": FILL-BUF 100000 0 DO I BUF @ I CELLS + ! LOOP ;\n"
+                  "FILL-BUF BUF @ 99999 CELLS + @ BUF @ 42 CELLS + @"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 2);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 42);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 99999);
+
+    // Floats, tokens and bytes
+    ASSERT_EQ(forth.interpretString("4.25 BUF @ FLOAT! BUF @ FLOAT@"), true);
+    ASSERT_EQ(forth.dataStack().pop().real(), 4.25);
+    ASSERT_EQ(forth.interpretString("$1234 BUF @ TOKEN! BUF @ TOKEN@"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0x1234);
+    ASSERT_EQ(forth.interpretString("65 BUF @ 1+ >BYTES[] BYTE! BUF @ 1+ >BYTES[] BYTE@"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 65);
+
+    // Copy from the heap to the dictionary
+    ASSERT_EQ(forth.interpretString("CREATE ARR 4 CELLS ALLOT BUF @ 10 CELLS + ARR 4 CELLS MOVE ARR CELL+ @"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 11);
+
+    // Resizing keeps the content
+    ASSERT_EQ(forth.interpretString("BUF @ 200000 CELLS RESIZE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+    ASSERT_EQ(forth.interpretString("BUF ! BUF @ 1234 CELLS + @"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1234);
+
+    // Freeing
+    ASSERT_EQ(forth.interpretString("BUF @ FREE BUF @ FREE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), -1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+    ASSERT_EQ(forth.interpretString("-1 ALLOCATE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), -1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+
+    // Blocks are released on abort
+    ASSERT_EQ(forth.interpretString("10 ALLOCATE DROP BUF ! UNKNOWN-WORD"), false);
+    std::stringstream buffer;
+    std::streambuf* old = std::cerr.rdbuf(buffer.rdbuf());
+    ASSERT_EQ(forth.interpretString("BUF @ @"), false);
+    std::cerr.rdbuf(old);
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("Invalid heap address"));
+}
+
+//
+TEST(CheckForth, Strings)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+
+    // COMPARE: interned and dictionary strings
+    ASSERT_EQ(forth.interpretString("S\" abc\" S\" abc\" COMPARE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+    ASSERT_EQ(forth.interpretString("S\" abc\" S\" abd\" COMPARE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), -1);
+    ASSERT_EQ(forth.interpretString("S\" abd\" S\" abc\" COMPARE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1);
+    ASSERT_EQ(forth.interpretString("S\" ab\" S\" abc\" COMPARE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), -1);
+    ASSERT_EQ(forth.interpretString(": FOO S\" abc\" ; FOO S\" abc\" COMPARE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+
+    // Identical strings are interned once
+    ASSERT_EQ(forth.interpretString("S\" xyz\" DROP S\" xyz\" DROP =="), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), -1);
+
+    // S+ SEARCH SUBSTRING /STRING
+    ASSERT_EQ(forth.interpretString("S\" 1 2 \" S\" +\" S+ EVALUATE"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 3);
+    ASSERT_EQ(forth.interpretString("S\" hello world\" S\" wor\" SEARCH"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), -1);
+    ASSERT_EQ(forth.dataStack().pick(0).integer(), 5);
+    ASSERT_EQ(forth.interpretString("S\" world\" COMPARE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+    ASSERT_EQ(forth.interpretString("S\" hello\" S\" xyz\" SEARCH ROT DROP"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 5);
+    ASSERT_EQ(forth.interpretString("S\" hello world\" 6 3 SUBSTRING S\" wor\" COMPARE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+    ASSERT_EQ(forth.interpretString("S\" hello world\" 6 /STRING S\" world\" COMPARE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+    ASSERT_EQ(forth.interpretString("S\" hello\" 10 100 SUBSTRING NIP"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+
+    // Transient strings have no size limit and do not consume dictionary
+    std::string big(1000u, 'x');
+    ASSERT_EQ(forth.interpretString("HERE"), true);
+    ASSERT_EQ(forth.interpretString(("S\" " + big + "\" NIP HERE").c_str()), true);
+    ASSERT_EQ(forth.dataStack().depth(), 3);
+    ASSERT_EQ(forth.dataStack().pick(0).integer(), forth.dataStack().pick(2).integer());
+    ASSERT_EQ(forth.dataStack().pick(1).integer(), 1000);
+    forth.dataStack().reset();
+
+    std::stringstream buffer;
+    std::streambuf* old = std::cout.rdbuf(buffer.rdbuf());
+    ASSERT_EQ(forth.interpretString("S\" foo\" S\" bar\" S+ TYPE"), true);
+    std::cout.rdbuf(old);
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("foobar"));
+
+    // Strings no longer referred are released: building 20000 distinct
+    // strings in a loop does not keep them all. Strings stored in variables
+    // or kept on the stack survive.
+    std::string digits;
+    for (int i = 0; i < 20100; ++i)
+        digits += char('0' + (i * 7 + i / 10) % 10);
+    forth.dataStack().reset();
+    ASSERT_EQ(forth.interpretString(("VARIABLE KEPT S\" " + digits + "\" 2DUP DROP KEPT !\n"
+                                     ": CHURN 20000 0 DO 2DUP I 100 SUBSTRING 2DROP LOOP ;\n"
+                                     "CHURN S\" kept\" KEPT @ 5 S+").c_str()), true);
+    ASSERT_LT(forth.m_interpreter->m_strings.live(), 5000u);
+    ASSERT_EQ(forth.interpretString(("S\" kept" + digits.substr(0u, 5u) +
+                                     "\" COMPARE KEPT @ 100 S\" " +
+                                     digits.substr(0u, 100u) + "\" COMPARE").c_str()), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+    ASSERT_EQ(forth.interpretString(("KEPT @ 20100 S\" " + digits + "\" COMPARE").c_str()), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+}
+
+//
+TEST(CheckForth, Checkpoints)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+    ASSERT_EQ(forth.interpretString(
+                  ": FOO 42 ; VARIABLE X 5 X ! 10 ALLOCATE DROP VARIABLE BUF BUF ! "
+                  "7 BUF @ ! 1 2 3 >R"), true);
+    size_t const id = forth.checkpoint();
+    ASSERT_EQ(id, 0u);
+
+    // Several what-if evaluations from the same state
+    for (int i = 0; i < 3; ++i)
+    {
+        ASSERT_EQ(forth.interpretString(
+                      ": BAR 1 ; 8 X ! 9 BUF @ ! 100000 ALLOCATE 2DROP "
+                      "DROP DROP R> DROP : FOO 43 ;"), true);
+        ASSERT_EQ(forth.has("BAR"), true);
+        ASSERT_EQ(forth.rollback(id), true);
+        ASSERT_EQ(forth.has("BAR"), false);
+        ASSERT_EQ(forth.dataStack().depth(), 2);
+        ASSERT_EQ(forth.interpretString("FOO X @ BUF @ @ R>"), true);
+        ASSERT_EQ(forth.dataStack().depth(), 6);
+        ASSERT_EQ(forth.dataStack().pop().integer(), 3);
+        ASSERT_EQ(forth.dataStack().pop().integer(), 7);
+        ASSERT_EQ(forth.dataStack().pop().integer(), 5);
+        ASSERT_EQ(forth.dataStack().pop().integer(), 42);
+        ASSERT_EQ(forth.rollback(id), true);
+    }
+
+    // Nested checkpoints
+    ASSERT_EQ(forth.interpretString("6 X !"), true);
+    ASSERT_EQ(forth.checkpoint(), 1u);
+    ASSERT_EQ(forth.interpretString("4 X !"), true);
+    ASSERT_EQ(forth.rollback(1u), true);
+    ASSERT_EQ(forth.interpretString("X @"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 6);
+    ASSERT_EQ(forth.rollback(0u), true);
+    ASSERT_EQ(forth.rollback(1u), false);
+    ASSERT_EQ(forth.interpretString("X @"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 5);
+
+    // Forth words: the identifier stays on the data stack
+    ASSERT_EQ(forth.interpretString("100 CHECKPOINT"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 4);
+    ASSERT_EQ(forth.dataStack().pick(0).integer(), 1);
+    ASSERT_EQ(forth.interpretString("SWAP 1+ SWAP 9 X ! : TRY ROLLBACK 1 ; TRY"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 4);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 100);
+    ASSERT_EQ(forth.has("TRY"), false);
+    ASSERT_EQ(forth.interpretString("X @"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 5);
+
+    // Rollback after an aborted evaluation
+    ASSERT_EQ(forth.interpretString("S\" foo\" 2DROP 3 X ! UNKNOWN-WORD"), false);
+    ASSERT_EQ(forth.dataStack().depth(), 0);
+    ASSERT_EQ(forth.rollback(0u), true);
+    ASSERT_EQ(forth.dataStack().depth(), 2);
+    ASSERT_EQ(forth.interpretString("X @ BUF @ @"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 7);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 5);
+
+    std::stringstream buffer;
+    std::streambuf* old = std::cerr.rdbuf(buffer.rdbuf());
+    ASSERT_EQ(forth.interpretString("42 ROLLBACK"), false);
+    std::cerr.rdbuf(old);
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("Invalid checkpoint"));
+
+    // Journals are per thread: checkpoints of another interpreter in another
+    // thread do not interfere with the ones of this thread.
+    ASSERT_EQ(forth.checkpoint(), 1u);
+    bool other = false;
+    std::thread thread([&other, &options]()
+    {
+        SimForth forth2(options);
+        other = forth2.boot() &&
+                forth2.interpretString("VARIABLE Y 1 Y !") &&
+                (forth2.checkpoint() == 0u) &&
+                forth2.interpretString("2 Y !") &&
+                forth2.rollback(0u) &&
+                forth2.interpretString("Y @") &&
+                (forth2.dataStack().pop().integer() == 1);
+    });
+    thread.join();
+    ASSERT_EQ(other, true);
+    ASSERT_EQ(forth.interpretString("8 X !"), true);
+    ASSERT_EQ(forth.rollback(1u), true);
+    ASSERT_EQ(forth.interpretString("X @"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 5);
+}
+
+//
+TEST(CheckForth, SharedDictionary)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+    ASSERT_EQ(forth.interpretString(": SQ DUP * ; VARIABLE V 1 V !"), true);
+    SharedDictionary image = forth.freeze();
+
+    // The frozen image is not affected by later modifications
+    ASSERT_EQ(forth.interpretString(": LATE 0 ; 2 V !"), true);
+
+    constexpr int N = 8;
+    std::vector<std::thread> threads;
+    int results[N][3];
+    bool found[N];
+    for (int i = 0; i < N; ++i)
+    {
+        threads.emplace_back([&, i]()
+        {
+            SimForth worker(image, options);
+            std::string script = ": CUBE DUP SQ * ; V @ " + std::to_string(i)
+                + " V ! V @ " + std::to_string(i) + " CUBE";
+            if (!worker.interpretString(script.c_str())
+                || (worker.dataStack().depth() != 3))
+            {
+                results[i][0] = -1;
+                return ;
+            }
+            results[i][2] = int(worker.dataStack().pop().integer());
+            results[i][1] = int(worker.dataStack().pop().integer());
+            results[i][0] = int(worker.dataStack().pop().integer());
+            found[i] = worker.has("LATE");
+        });
+    }
+    for (auto& t: threads)
+        t.join();
+
+    for (int i = 0; i < N; ++i)
+    {
+        ASSERT_EQ(results[i][0], 1);
+        ASSERT_EQ(results[i][1], i);
+        ASSERT_EQ(results[i][2], i * i * i);
+        ASSERT_EQ(found[i], false);
+    }
+
+    // Overlays did not modify the original dictionary
+    ASSERT_EQ(forth.has("CUBE"), false);
+    ASSERT_EQ(forth.interpretString("V @"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 2);
+}
+
+//
+TEST(CheckForth, Tasks)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+    forth.setWorkers(4u);
+
+    // Arguments are copied in, the result stack is copied back
+    ASSERT_EQ(forth.interpretString(": SQ DUP * ; 42 3 1 ' SQ SPAWN AWAIT"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 2);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 9);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 42);
+
+    // Many tasks in flight
+    ASSERT_EQ(forth.interpretString(
+                  ": WORK DUP 0 SWAP 0 DO I + LOOP ;\n"
+                  ": RUN 20 0 DO I 1000 * 1 ['] WORK SPAWN LOOP ;\n"
+                  ": GATHER 20 0 DO AWAIT 2DROP LOOP ;\n"
+                  "RUN GATHER"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 0);
+    ASSERT_EQ(forth.interpretString("1000 1 ' WORK SPAWN 2000 1 ' WORK SPAWN AWAIT ROT AWAIT"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 4);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 499500);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1000);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1999000);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 2000);
+
+    // Nested tasks do not block a pool of a single worker
+    forth.setWorkers(1u);
+    ASSERT_EQ(forth.interpretString(
+                  ": INNER 1+ ; : OUTER 1 ['] INNER SPAWN AWAIT 2 * ; 5 1 ' OUTER SPAWN AWAIT"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 12);
+
+    // Errors are reported by AWAIT
+    std::stringstream buffer;
+    std::streambuf* old = std::cerr.rdbuf(buffer.rdbuf());
+    ASSERT_EQ(forth.interpretString("0 ' DROP SPAWN AWAIT"), false);
+    ASSERT_EQ(forth.interpretString("12345 AWAIT"), false);
+    ASSERT_EQ(forth.interpretString("1 2 ' DROP SPAWN"), false);
+    ASSERT_EQ(forth.interpretString("VARIABLE V : SET 42 V ! ; 0 ' SET SPAWN"), false);
+    ASSERT_EQ(forth.interpretString(": DEF 1 , ; : INDIRECT DEF ; 0 ' INDIRECT SPAWN"), false);
+    ASSERT_EQ(forth.interpretString(": NOTHING ; : FLOOD 5000 0 DO 0 ['] NOTHING SPAWN DROP LOOP ; FLOOD"), false);
+    std::cerr.rdbuf(old);
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("task failed: Data-Stack underflow"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("AWAIT: invalid task"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("SPAWN: invalid number of arguments"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("SPAWN: the word ! is not allowed in the task word SET"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("SPAWN: the word , is not allowed in the task word INDIRECT"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("SPAWN: too many tasks not awaited (4096)"));
+    ASSERT_EQ(forth.interpretString("V @"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+}
+
+//
+TEST(CheckForth, ParallelLoops)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+    forth.setWorkers(4u);
+
+    // Arrays of 1000 cells (several chunks) in the heap
+    ASSERT_EQ(forth.interpretString(
+                  "1000 CELLS ALLOCATE DROP VALUE SRC\n"
+                  "1000 CELLS ALLOCATE DROP VALUE DST\n"
+                  ": INIT 1000 0 DO I SRC I CELLS + ! LOOP ;\n"
+                  "INIT"), true);
+
+    // Words calling other words, values and branches are allowed
+    ASSERT_EQ(forth.interpretString(
+                  "3 VALUE THREE\n"
+                  ": SQ DUP * ;\n"
+                  ": F ( x -- y ) DUP 1 AND IF SQ ELSE THREE + THEN ;\n"
+                  "SRC DST 1000 ' F PAR-MAP\n"
+                  "DST 1 CELLS + @ DST 998 CELLS + @ DST 999 CELLS + @"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 3);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 998001);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1001);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1);
+
+    // Reduction: init is folded once
+    ASSERT_EQ(forth.interpretString("SRC 1000 100 ' + PAR-REDUCE"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 499600);
+    ASSERT_EQ(forth.interpretString("SRC 0 7 ' + PAR-REDUCE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 7);
+
+    // Fixed chunks: same result whatever the number of threads, even for a
+    // non associative word
+    ASSERT_EQ(forth.interpretString("SRC 1000 0 ' - PAR-REDUCE"), true);
+    Int const expected = forth.dataStack().pop().integer();
+    forth.setWorkers(1u);
+    ASSERT_EQ(forth.interpretString("SRC 1000 0 ' - PAR-REDUCE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), expected);
+
+    // Arrays of floats: read like FLOAT@, integer results stored as floats
+    ASSERT_EQ(forth.interpretString(
+                  "1000 CELLS ALLOCATE DROP VALUE FSRC\n"
+                  ": FINIT 1000 0 DO I >FLOAT 0.5 * FSRC I CELLS + ! LOOP ;\n"
+                  ": HALF 0.5 * ; : TRUNC FLOOR >INT ;\n"
+                  "FINIT FSRC DST 1000 ' HALF FPAR-MAP\n"
+                  "DST 3 CELLS + FLOAT@ DST 999 CELLS + FLOAT@\n"
+                  "FSRC 1000 0.25 ' + FPAR-REDUCE\n"
+                  "FSRC DST 1000 ' TRUNC FPAR-MAP DST 3 CELLS + FLOAT@"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 4);
+    ASSERT_EQ(forth.dataStack().pick(0).isReal(), true);
+    ASSERT_EQ(forth.dataStack().pop().real(), 1.0);
+    ASSERT_EQ(forth.dataStack().pop().real(), 249750.25);
+    ASSERT_EQ(forth.dataStack().pop().real(), 249.75);
+    ASSERT_EQ(forth.dataStack().pop().real(), 0.75);
+
+    // Words writing memory, doing I/O or changing the stack depth are refused.
+    // Note: the heap is released on errors, arrays are in the dictionary.
+    std::stringstream buffer;
+    std::streambuf* old = std::cerr.rdbuf(buffer.rdbuf());
+    ASSERT_EQ(forth.interpretString("VARIABLE X : BAD DUP X ! ; HERE HERE 10 ' BAD PAR-MAP"), false);
+    ASSERT_EQ(forth.interpretString(": NOISY DUP . ; HERE 10 0 ' NOISY PAR-REDUCE"), false);
+    ASSERT_EQ(forth.interpretString("HERE HERE 10 ' 2DROP PAR-MAP"), false);
+    ASSERT_EQ(forth.interpretString("HERE HERE 100000 ' 1+ PAR-MAP"), false);
+    std::cerr.rdbuf(old);
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("PAR-MAP: the word ! is not allowed in the parallel word BAD"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("PAR-REDUCE: the word . is not allowed"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("PAR-MAP: Data-Stack underflow"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("Invalid range of 100000 cells"));
+}
+
+//
+TEST(CheckForth, CooperativeTasks)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+
+    // Two tasks incrementing their counter in turn with the operator
+    ASSERT_EQ(forth.interpretString(
+                  "VARIABLE A 0 A ! VARIABLE B 0 B !\n"
+                  "TASK T1 TASK T2\n"
+                  ": COUNT-A T1 ACTIVATE BEGIN 1 A +! PAUSE AGAIN ;\n"
+                  ": COUNT-B T2 ACTIVATE BEGIN 10 B +! PAUSE AGAIN ;\n"
+                  "42 COUNT-A COUNT-B PAUSE PAUSE PAUSE A @ B @"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 3);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 30);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 3);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 42);
+
+    // The operator can pause inside a definition. Tasks keep their own stacks.
+    ASSERT_EQ(forth.interpretString(
+                  ": RUN 5 0 DO PAUSE LOOP ;\n"
+                  ": DEPTHS T1 ACTIVATE 1 2 3 BEGIN DEPTH A ! PAUSE AGAIN ;\n"
+                  "7 DEPTHS RUN A @"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 2);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 3);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 7);
+
+    // STOP and WAKE. A task returning from its definition ends.
+    ASSERT_EQ(forth.interpretString(
+                  "0 A ! 0 B !\n"
+                  ": SLEEPER T1 ACTIVATE BEGIN 1 A +! STOP AGAIN ;\n"
+                  ": ONCE T2 ACTIVATE 1 B +! ;\n"
+                  "SLEEPER ONCE PAUSE PAUSE PAUSE A @ B @\n"
+                  "T1 WAKE T2 WAKE PAUSE PAUSE A @ B @"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 4);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 2);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1);
+
+    // Thousand anonymous actors, each one ending after three rounds
+    ASSERT_EQ(forth.interpretString(
+                  "0 A !\n"
+                  ": ACTOR ( task -- ) ACTIVATE 3 0 DO 1 A +! PAUSE LOOP ;\n"
+                  ": ACTORS 1000 0 DO NEW-TASK ACTOR LOOP ;\n"
+                  "ACTORS PAUSE A @ PAUSE A @ PAUSE PAUSE A @"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 3);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 3000);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 2000);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1000);
+
+    // Errors stop all tasks and give the hand back to the operator
+    std::stringstream buffer;
+    std::streambuf* old = std::cerr.rdbuf(buffer.rdbuf());
+    ASSERT_EQ(forth.interpretString(": BAD T1 ACTIVATE PAUSE DROP ; BAD PAUSE PAUSE"), false);
+    ASSERT_EQ(forth.interpretString("STOP"), false);
+    ASSERT_EQ(forth.interpretString("T1 ACTIVATE"), false);
+    ASSERT_EQ(forth.interpretString("12345 WAKE"), false);
+    std::cerr.rdbuf(old);
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("Data-Stack underflow caused by word DROP"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("STOP: the operator task cannot be stopped"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("ACTIVATE: shall be used inside a definition"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("WAKE: invalid task"));
+    ASSERT_EQ(forth.interpretString("0 A ! PAUSE PAUSE A @ 1 2"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 3);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 2);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+}
+
+//
+TEST(CheckForth, Channels)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+
+    // Cells are received in the order they have been sent
+    ASSERT_EQ(forth.interpretString(
+                  "3 CHANNEL VALUE CH\n"
+                  "1 CH SEND 2 CH SEND CH RECV CH RECV CH TRY-RECV\n"
+                  "10 20 30 40 4 CH SEND-N 4 CH RECV-N 5 CH SEND CH TRY-RECV"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 9);
+    ASSERT_EQ(forth.dataStack().pop().integer(), -1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 5);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 40);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 30);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 20);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 10);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 2);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1);
+
+    // Cooperative tasks give the hand on full or empty channels
+    ASSERT_EQ(forth.interpretString(
+                  "TASK T1\n"
+                  ": PRODUCE T1 ACTIVATE 101 1 DO I CH SEND LOOP ;\n"
+                  ": CONSUME 0 100 0 DO CH RECV + LOOP ;\n"
+                  "PRODUCE CONSUME\n"
+                  ": PRODUCE-N T1 ACTIVATE 1 2 3 4 5 6 7 8 8 CH SEND-N ;\n"
+                  ": CONSUME-N 8 CH RECV-N ;\n"
+                  "PRODUCE-N CONSUME-N"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 9);
+    for (Int i = 8; i >= 1; --i)
+    {
+        ASSERT_EQ(forth.dataStack().pop().integer(), i);
+    }
+    ASSERT_EQ(forth.dataStack().pop().integer(), 5050);
+
+    // Streaming with a host thread: blocking calls sleep until cells come
+    Int const in = forth.createChannel(16);
+    Int const out = forth.createChannel(1);
+    ASSERT_NE(in, 0);
+    ASSERT_NE(forth.channel(out), nullptr);
+    std::thread host([&]()
+    {
+        for (Int i = 1; i <= 10000; ++i)
+            forth.channel(in)->send(Cell::integer(i));
+    });
+    forth.dataStack().push(Cell::integer(in));
+    forth.dataStack().push(Cell::integer(out));
+    ASSERT_EQ(forth.interpretString(
+                  "VALUE OUT VALUE IN\n"
+                  ": SUM 0 10000 0 DO IN RECV + LOOP OUT SEND ; SUM"), true);
+    host.join();
+    ASSERT_EQ(forth.channel(out)->recv().integer(), 50005000);
+    ASSERT_EQ(forth.dataStack().depth(), 0);
+
+    // Errors
+    std::stringstream buffer;
+    std::streambuf* old = std::cerr.rdbuf(buffer.rdbuf());
+    ASSERT_EQ(forth.interpretString("0 CHANNEL"), false);
+    ASSERT_EQ(forth.interpretString("12345678 RECV"), false);
+    ASSERT_EQ(forth.interpretString("1 2 3 5 CH SEND-N"), false);
+    ASSERT_EQ(forth.interpretString("TASK T2 : FEED T2 ACTIVATE 7 CH SEND ; FEED CH RECV"), false);
+    std::cerr.rdbuf(old);
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("CHANNEL: invalid capacity"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("RECV: invalid channel 12345678"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("SEND-N: invalid number of cells 5"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("RECV: deadlock: the channel is waited outside a definition"));
+    ASSERT_EQ(forth.channel(0), nullptr);
+}
+
+//
+TEST(CheckForth, Watchdog)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+    ASSERT_EQ(forth.interpretString(": FOREVER BEGIN AGAIN ; : COUNT 0 DO LOOP ;"), true);
+
+    // Scripts within their budget
+    forth.options().budget = 5000u;
+    ASSERT_EQ(forth.interpretString("500 COUNT 500 COUNT 42"), true);
+    ASSERT_EQ(forth.status(), forth::Status::Success);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 42);
+
+    // Runaway scripts are stopped and the interpreter stays usable
+    std::stringstream buffer;
+    std::streambuf* old = std::cerr.rdbuf(buffer.rdbuf());
+    ASSERT_EQ(forth.interpretString("5000 COUNT"), false);
+    ASSERT_EQ(forth.status(), forth::Status::OutOfBudget);
+    ASSERT_EQ(forth.interpretString("FOREVER"), false);
+    ASSERT_EQ(forth.status(), forth::Status::OutOfBudget);
+
+    forth.options().budget = 0u;
+    forth.options().timeout = 50u;
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_EQ(forth.interpretString("1 2 FOREVER"), false);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(forth.status(), forth::Status::Timeout);
+    ASSERT_LT(elapsed, std::chrono::seconds(5));
+
+    ASSERT_EQ(forth.interpretString("DROP"), false);
+    ASSERT_EQ(forth.status(), forth::Status::Failure);
+    std::cerr.rdbuf(old);
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("Instruction budget of 5000 exhausted"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("Deadline of 50 ms exceeded"));
+
+    ASSERT_EQ(forth.interpretString("1 2 + 100000 COUNT"), true);
+    ASSERT_EQ(forth.status(), forth::Status::Success);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 3);
+}
+
+//
+TEST(CheckForth, Slices)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+
+    // The script is copied and executed by slices keeping the stacks and IP
+    {
+        std::string script(": COUNT 0 DO LOOP ; : NESTED 10 0 DO 1000 COUNT LOOP ;\n"
+                           "42 NESTED 10000 COUNT 1 2 +");
+        ASSERT_EQ(forth.start(script.c_str()), true);
+    }
+    ASSERT_EQ(forth.status(), forth::Status::Running);
+    ASSERT_EQ(forth.start("1"), false);
+    size_t slices = 0u;
+    while (forth.run(100u) == forth::Status::Running)
+    {
+        ++slices;
+        ASSERT_GE(forth.dataStack().depth(), 1);
+        ASSERT_EQ(forth.dataStack().pick(forth.dataStack().depth() - 1).integer(), 42);
+    }
+    ASSERT_GT(slices, 100u);
+    ASSERT_EQ(forth.status(), forth::Status::Success);
+    ASSERT_EQ(forth.dataStack().depth(), 2);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 3);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 42);
+    ASSERT_EQ(forth.run(100u), forth::Status::Success);
+
+    // Until the end
+    ASSERT_EQ(forth.start("1000 COUNT 5"), true);
+    ASSERT_EQ(forth.run(0u), forth::Status::Success);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 5);
+
+    // Errors and budget
+    std::stringstream buffer;
+    std::streambuf* old = std::cerr.rdbuf(buffer.rdbuf());
+    ASSERT_EQ(forth.start("1000 COUNT DROP"), true);
+    ASSERT_EQ(forth.interpretString("1"), false);
+    ASSERT_EQ(forth.status(), forth::Status::Running);
+    while (forth.run(10u) == forth::Status::Running) {}
+    ASSERT_EQ(forth.status(), forth::Status::Failure);
+
+    forth.options().budget = 1000u;
+    ASSERT_EQ(forth.start("100000 COUNT"), true);
+    while (forth.run(10u) == forth::Status::Running) {}
+    ASSERT_EQ(forth.status(), forth::Status::OutOfBudget);
+    forth.options().budget = 0u;
+    std::cerr.rdbuf(old);
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("is not finished"));
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("Data-Stack underflow caused by word DROP"));
+
+    ASSERT_EQ(forth.interpretString("1 2 +"), true);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 3);
+}
+
+//
+TEST(CheckForth, Bind)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+    ASSERT_EQ(forth.interpretString(": AREA * ; : FOREVER BEGIN AGAIN ;"), true);
+
+    auto area = forth.bind<Real(Int, Real)>("AREA");
+    auto swap = forth.bind<std::tuple<int, long>(long, int)>("SWAP");
+    auto equal = forth.bind<bool(Int, Int)>("==");
+    auto drop = forth.bind<void(Cell)>("DROP");
+    ASSERT_DOUBLE_EQ(area(2, 1.5), 3.0);
+    ASSERT_EQ(swap(1, 2), std::make_tuple(2, 1l));
+    ASSERT_EQ(equal(3, 3), true);
+    ASSERT_EQ(equal(3, 4), false);
+    drop(Cell::integer(5));
+    ASSERT_EQ(forth.dataStack().depth(), 0);
+
+    Int sum = 0;
+    auto plus = forth.bind<Int(Int, Int)>("+");
+    for (Int i = 0; i < 100000; ++i)
+        sum = plus(sum, i);
+    ASSERT_EQ(sum, 4999950000);
+    ASSERT_EQ(forth.status(), forth::Status::Success);
+
+    // Bulk transfers
+    Cell cells[3] = { Cell::integer(1), Cell::integer(2), Cell::integer(3) };
+    ASSERT_EQ(forth.dataStack().push(cells, 3u), true);
+    ASSERT_EQ(forth.interpretString("+ + 10 20"), true);
+    ASSERT_EQ(forth.dataStack().pop(cells, 3u), true);
+    ASSERT_EQ(cells[0].integer(), 6);
+    ASSERT_EQ(cells[1].integer(), 10);
+    ASSERT_EQ(cells[2].integer(), 20);
+    ASSERT_EQ(forth.dataStack().pop(cells, 1u), false);
+
+    // Errors abort the interpreter which stays usable
+    ASSERT_THROW(forth.bind<void()>("NOT-A-WORD"), forth::Exception);
+    ASSERT_THROW(forth.bind<Int()>("DROP")(), forth::Exception);
+    ASSERT_EQ(forth.status(), forth::Status::Failure);
+    ASSERT_EQ(forth.interpretString("1 2"), true);
+    ASSERT_EQ(forth.status(), forth::Status::Success);
+    ASSERT_THROW(forth.bind<Int(Int)>("DROP")(1), forth::Exception);
+    ASSERT_EQ(forth.status(), forth::Status::Failure);
+    ASSERT_EQ(forth.dataStack().depth(), 0);
+    forth.options().budget = 100u;
+    ASSERT_THROW(forth.bind<void()>("FOREVER")(), forth::Exception);
+    ASSERT_EQ(forth.status(), forth::Status::OutOfBudget);
+    forth.options().budget = 0u;
+    ASSERT_DOUBLE_EQ(area(4, 0.5), 2.0);
+    ASSERT_EQ(forth.dataStack().depth(), 0);
+}
+
+//
+TEST(CheckForth, Script)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+    ASSERT_EQ(forth.interpretString(": OFFSET 1 ;"), true);
+
+    forth::Script script = forth.compile("OFFSET + \\ comment");
+    ASSERT_EQ(script.compilations(), 1u);
+    ASSERT_EQ(forth.dataStack().depth(), 0);
+    forth.dataStack().push(Cell::integer(0));
+    for (int i = 0; i < 1000; ++i)
+        script.run();
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1000);
+    ASSERT_EQ(forth.status(), forth::Status::Success);
+
+    // New words not used by the script: no compilation
+    ASSERT_EQ(forth.interpretString(": FOO 42 ;"), true);
+    forth.dataStack().push(Cell::integer(0));
+    script.run();
+    ASSERT_EQ(forth.dataStack().pop().integer(), 1);
+    ASSERT_EQ(script.compilations(), 1u);
+
+    // Redefined word
+    ASSERT_EQ(forth.interpretString(": OFFSET 10 ;"), true);
+    forth.dataStack().push(Cell::integer(0));
+    script.run();
+    ASSERT_EQ(forth.dataStack().pop().integer(), 10);
+    ASSERT_EQ(script.compilations(), 2u);
+
+    // Script removed by a rollback
+    size_t id = forth.checkpoint();
+    forth::Script later = forth.compile("OFFSET 2 *");
+    ASSERT_EQ(forth.rollback(id), true);
+    ASSERT_EQ(forth.interpretString(": BAR 1 2 3 ;"), true);
+    later.run();
+    ASSERT_EQ(forth.dataStack().pop().integer(), 20);
+    ASSERT_EQ(later.compilations(), 2u);
+
+    // The last definition is replaced when compiled again
+    ASSERT_EQ(forth.interpretString(": OFFSET 100 ;"), true);
+    forth::Script last = forth.compile("OFFSET 1+");
+    ASSERT_EQ(forth.interpretString("HERE"), true);
+    Int const here = forth.dataStack().pop().integer();
+    ASSERT_EQ(forth.interpretString("HIDE OFFSET"), true);
+    last.run();
+    ASSERT_EQ(forth.dataStack().pop().integer(), 11);
+    ASSERT_EQ(last.compilations(), 2u);
+    ASSERT_EQ(forth.interpretString("HERE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), here);
+
+    // Errors keep the stacks and the dictionary of the host
+    forth.dataStack().push(Cell::integer(7));
+    ASSERT_THROW(forth.compile("NOT-A-WORD"), forth::Exception);
+    ASSERT_EQ(forth.status(), forth::Status::Failure);
+    ASSERT_THROW(forth.compile("1 ; 2"), forth::Exception);
+    ASSERT_THROW(forth.compile("[ DROP ] 1"), forth::Exception);
+    ASSERT_EQ(forth.dataStack().depth(), 1);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 7);
+    ASSERT_EQ(forth.interpretString("HERE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), here);
+    forth.dataStack().push(Cell::integer(5));
+    script.run();
+    ASSERT_EQ(forth.dataStack().pop().integer(), 15);
+}
+
+//
+static Int twice(Int x) { return 2 * x; }
+
+TEST(CheckForth, RegisterPrimitive)
+{
+    Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+
+    ASSERT_EQ(forth.boot(), true);
+
+    Int calls = 0;
+    Token xt = forth.registerPrimitive("TWICE", twice, "( x -- 2x )");
+    ASSERT_EQ(forth.interpreter().isPrimitive(xt), true);
+    forth.registerPrimitive("HYPOT", [](Real x, Real y) { return std::hypot(x, y); },
+                            "( x y -- z )");
+    forth.registerPrimitive("DIVMOD", [](Int a, Int b) { return std::make_tuple(a % b, a / b); },
+                            "( a b -- r q )");
+    forth.registerPrimitive("COUNT-CALLS", [&calls]() { ++calls; }, "( -- )");
+    forth.registerPrimitive("3DROP", [](forth::DataStack& ds) { ds.top() -= 3; },
+                            "( a b c -- )");
+    forth.registerPrimitive("BAD", [](forth::DataStack& ds) { ds.drop(); }, "( a -- a )");
+
+    ASSERT_EQ(forth.interpretString("21 TWICE 3.0 4.0 HYPOT 17 5 DIVMOD"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 3);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 2);
+    ASSERT_DOUBLE_EQ(forth.dataStack().pop().real(), 5.0);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 42);
+
+    // Compiled inside definitions and in loops
+    ASSERT_EQ(forth.interpretString(": FOO 1000 0 DO COUNT-CALLS 1 TWICE DROP LOOP ; FOO"), true);
+    ASSERT_EQ(calls, 1000);
+    ASSERT_EQ(forth.interpretString("1 2 3 3DROP DEPTH"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 0);
+    ASSERT_EQ(forth.bind<Int(Int)>("TWICE")(5), 10);
+
+    // Stack effects are checked
+    ASSERT_EQ(forth.interpretString("TWICE"), false);
+    ASSERT_EQ(forth.interpretString("1 2 3DROP"), false);
+    ASSERT_EQ(forth.interpretString("1 BAD"), false);
+    ASSERT_THROW(forth.registerPrimitive("NEG", [](Int x) { return -x; }, "( x y -- z )"),
+                 forth::Exception);
+    ASSERT_THROW(forth.registerPrimitive("NEG", [](Int x) { return -x; }, "( x )"),
+                 forth::Exception);
+    ASSERT_EQ(forth.interpretString("2 TWICE"), true);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 4);
+}
+
 //
 TEST(CheckForth, ImmediateCompile)
 {
@@ -757,3 +1722,25 @@ TEST(CheckForth, SelfTests)
     EXPECT_THAT(buffer.str().c_str(), HasSubstr(" ok"));
     ASSERT_EQ(forth.dataStack().depth(), 0);
 }
+
+// Launch self tests written in Forth with the lexer thread
+TEST(CheckForth, SelfTestsPipeline)
+{
+    Options options; options.pipeline = true;
+    SimForth forth(options);
+    ASSERT_EQ(forth.boot(), true);
+
+    std::stringstream buffer;
+    std::streambuf* old = std::cout.rdbuf(buffer.rdbuf());
+    ASSERT_EQ(forth.interpretFile("SelfTests/Tester.fth"), true);
+    std::cout.rdbuf(old);
+    ASSERT_EQ(forth.dataStack().depth(), 0);
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr(" ok"));
+
+    buffer.str(std::string());
+    old = std::cout.rdbuf(buffer.rdbuf());
+    ASSERT_EQ(forth.interpretFile("SelfTests/tests-core.fth"), true);
+    std::cout.rdbuf(old);
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr(" ok"));
+    ASSERT_EQ(forth.dataStack().depth(), 0);
+}
@@ -97,6 +97,39 @@ TEST(Dico, Dummy)
     ASSERT_EQ(d[Token(d.here() - 1)], 42);
 }
 
+TEST(Dico, AppendString)
+{
+    Dictionary dictionary;
+
+    Token here = 0u;
+    dictionary.append("hello", here);
+    ASSERT_EQ(here, 4u);
+    ASSERT_EQ(dictionary[0], 5u);
+
+    // Strings longer than the space left are refused, HERE is unchanged
+    std::string big(size::string, 'x');
+    here = Token(size::dictionary - 100u);
+    ASSERT_THROW(dictionary.append(big, here), forth::Exception);
+    ASSERT_EQ(here, Token(size::dictionary - 100u));
+
+    // Exactly fitting the end of the dictionary
+    std::string last(197u, 'y');
+    dictionary.append(last, here);
+    ASSERT_EQ(here, 0u);
+
+    // Compiled by S" near the end of the dictionary
+    forth::Options options; options.show_stack = false; options.quiet = true;
+    SimForth forth(options);
+    ASSERT_EQ(forth.boot(), true);
+    ASSERT_EQ(forth.interpretString("60000 HERE - ALLOT"), true);
+    std::string script(": TOO-BIG S\" " + std::string(20000u, 'x') + "\" ;");
+    std::stringstream buffer;
+    std::streambuf* old = std::cerr.rdbuf(buffer.rdbuf());
+    ASSERT_EQ(forth.interpretString(script.c_str()), false);
+    std::cerr.rdbuf(old);
+    EXPECT_THAT(buffer.str().c_str(), HasSubstr("Dictionary full"));
+}
+
 TEST(Dico, LoadSaveNominal)
 {
     Dictionary dictionary;
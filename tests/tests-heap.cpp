@@ -0,0 +1,234 @@
+//==============================================================================
+// SimForth: A Forth for SimTaDyn.
+// Copyright 2018-2020 Quentin Quadrat <lecrapouille@gmail.com>
+//
+// This file is part of SimForth.
+//
+// SimForth is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with SimForth.  If not, see <http://www.gnu.org/licenses/>.
+//==============================================================================
+
+#include "main.hpp"
+
+#define protected public
+#define private public
+#  include "Heap.hpp"
+#  include "StringHeap.hpp"
+#undef protected
+#undef private
+
+using namespace forth;
+
+TEST(Heap, AllocateFree)
+{
+    Heap heap(1_z << 24);
+
+    ASSERT_EQ(heap.used(), 0u);
+
+    Int a = heap.allocate(10u);
+    ASSERT_TRUE(Heap::owns(a));
+    ASSERT_FALSE(Heap::owns(a - Heap::base));
+    ASSERT_EQ(heap.used(), 32u);
+
+    Int b = heap.allocate(100u);
+    ASSERT_NE(a, b);
+    ASSERT_EQ(heap.used(), 32u + 128u);
+
+    ASSERT_TRUE(heap.store<Int>(a, 42));
+    ASSERT_TRUE(heap.store<Real>(b, 4.2));
+    Int i; Real r;
+    ASSERT_TRUE(heap.fetch<Int>(a, i));
+    ASSERT_TRUE(heap.fetch<Real>(b, r));
+    ASSERT_EQ(i, 42);
+    ASSERT_EQ(r, 4.2);
+
+    // Freed blocks are recycled
+    ASSERT_TRUE(heap.free(a));
+    ASSERT_FALSE(heap.free(a));
+    ASSERT_FALSE(heap.free(a + 1));
+    ASSERT_EQ(heap.used(), 128u);
+    ASSERT_EQ(heap.allocate(16u), a);
+}
+
+TEST(Heap, Resize)
+{
+    Heap heap(1_z << 24);
+
+    Int a = heap.allocate(8u);
+    ASSERT_TRUE(heap.store<Int>(a, 42));
+
+    // Still fitting inside the block
+    ASSERT_EQ(heap.resize(a, 16u), a);
+
+    // Moved
+    Int b = heap.resize(a, 1000u);
+    ASSERT_NE(b, 0);
+    ASSERT_NE(b, a);
+    Int i;
+    ASSERT_TRUE(heap.fetch<Int>(b, i));
+    ASSERT_EQ(i, 42);
+    ASSERT_FALSE(heap.free(a));
+    ASSERT_EQ(heap.resize(a, 2000u), 0);
+}
+
+TEST(Heap, LargeAndReset)
+{
+    Heap heap(1_z << 28);
+
+    // Multi-megabytes buffer
+    Int a = heap.allocate(64_z << 20);
+    ASSERT_NE(a, 0);
+    ASSERT_NE(heap.at(a, 64_z << 20), nullptr);
+    ASSERT_EQ(heap.at(a, 128_z << 20), nullptr);
+    std::memset(heap.at(a, 64_z << 20), 0xAB, 64_z << 20);
+
+    // Exhausted
+    ASSERT_EQ(heap.allocate(1_z << 28), 0);
+
+    // Out of bounds accesses
+    Int i;
+    ASSERT_FALSE(heap.fetch<Int>(Heap::base - 1, i));
+    ASSERT_FALSE(heap.fetch<Int>(a + (64 << 20), i));
+
+    // Released at once
+    heap.reset();
+    ASSERT_EQ(heap.used(), 0u);
+    ASSERT_FALSE(heap.fetch<Int>(a, i));
+    ASSERT_FALSE(heap.free(a));
+    ASSERT_EQ(heap.allocate(64_z << 20), a);
+}
+
+TEST(Heap, Bounds)
+{
+    Heap heap(1_z << 24);
+
+    // Sizes overflowing the header or the arena
+    ASSERT_EQ(heap.allocate(SIZE_MAX), 0);
+    ASSERT_EQ(heap.allocate(SIZE_MAX - 8u), 0);
+    ASSERT_EQ(heap.resize(heap.allocate(8u), SIZE_MAX), 0);
+
+    // Blocks are aligned on their size
+    Int a = heap.allocate(10u);
+    Int b = heap.allocate(100u);
+    ASSERT_EQ(((b - Heap::base) * Int(size::token)) % 128, Int(sizeof(Heap::Block)));
+
+    // Only the payload of allocated blocks is accessible: not the headers,
+    // not the padding between blocks, not the freed blocks.
+    Int const header = Int(sizeof(Heap::Block) / size::token);
+    ASSERT_NE(heap.at(b, 112u), nullptr);
+    ASSERT_EQ(heap.at(b, 113u), nullptr);
+    ASSERT_EQ(heap.at(b - header, 8u), nullptr);
+    ASSERT_EQ(heap.at(b - 1, 4u), nullptr);
+    ASSERT_EQ(heap.byteAt(2 * b - 1, 1u), nullptr);
+    ASSERT_EQ(heap.at(a + 8, 8u), nullptr);
+    ASSERT_TRUE(heap.free(a));
+    ASSERT_EQ(heap.at(a, 8u), nullptr);
+
+    // Bytes mimicking a header inside a payload give at most this payload
+    Heap::Block fake = { Heap::MAGIC_USED, 5u, Heap::NONE };
+    std::memcpy(heap.at(b + 16 - header, sizeof(fake)), &fake, sizeof(fake));
+    ASSERT_EQ(heap.at(b + 16, 24u), heap.at(b, 112u) + 32);
+    ASSERT_EQ(heap.at(b + 16, 100u), nullptr);
+
+    // A corrupted free list is dropped instead of being followed
+    Int c = heap.allocate(100u);
+    ASSERT_TRUE(heap.free(c));
+    heap.m_free[7] = 12345u;
+    Int d = heap.allocate(100u);
+    ASSERT_NE(d, 0);
+    ASSERT_NE(d, Heap::address(12345u));
+}
+
+TEST(StringHeap, Interning)
+{
+    StringHeap strings;
+
+    Int a = strings.intern("hello");
+    Int b = strings.intern("world");
+    ASSERT_TRUE(StringHeap::owns(a));
+    ASSERT_FALSE(StringHeap::owns(Heap::base));
+    ASSERT_NE(a, b);
+    ASSERT_EQ(strings.size(), 2u);
+
+    // Same content, same handle
+    std::string h("hel");
+    h += "lo";
+    ASSERT_EQ(strings.intern(h), a);
+    ASSERT_EQ(strings.size(), 2u);
+
+    ASSERT_STREQ(strings.get(a)->c_str(), "hello");
+    ASSERT_EQ(strings.get(b)->size(), 5u);
+    ASSERT_EQ(strings.get(b + 1), nullptr);
+    ASSERT_EQ(strings.get(a - 1), nullptr);
+
+    // No size limit
+    std::string big(100000u, 'x');
+    Int c = strings.intern(big);
+    ASSERT_EQ(strings.get(c)->size(), 100000u);
+
+    // Views stored in the hash table stay valid when growing
+    for (int i = 0; i < 1000; ++i)
+        strings.intern(std::to_string(i));
+    ASSERT_EQ(strings.intern("hello"), a);
+    ASSERT_EQ(strings.intern("999"), strings.intern(std::to_string(999)));
+
+    strings.reset();
+    ASSERT_EQ(strings.size(), 0u);
+    ASSERT_EQ(strings.get(a), nullptr);
+
+    // Handles are not heap addresses
+    ASSERT_FALSE(Heap::owns(StringHeap::base));
+    ASSERT_FALSE(Heap::ownsByte(StringHeap::base));
+    ASSERT_FALSE(Heap::owns(Heap::end));
+    ASSERT_TRUE(Heap::owns(Heap::end - 1));
+}
+
+TEST(StringHeap, Collection)
+{
+    StringHeap strings;
+
+    Int a = strings.intern("a");
+    Int b = strings.intern("b");
+    Int c = strings.intern("c");
+    ASSERT_EQ(strings.live(), 3u);
+
+    // Unmarked strings are released, marks are cleared by the sweep
+    strings.mark(b);
+    strings.mark(42);
+    ASSERT_EQ(strings.sweep(0u), 2u);
+    ASSERT_EQ(strings.live(), 1u);
+    ASSERT_EQ(strings.get(a), nullptr);
+    ASSERT_STREQ(strings.get(b)->c_str(), "b");
+    ASSERT_EQ(strings.get(c), nullptr);
+
+    // Released handles are recycled, the content index is updated
+    Int d = strings.intern("d");
+    ASSERT_TRUE((d == a) || (d == c));
+    ASSERT_STREQ(strings.get(d)->c_str(), "d");
+    ASSERT_EQ(strings.intern("b"), b);
+    ASSERT_EQ(strings.size(), 3u);
+
+    // Strings below the floor are kept
+    ASSERT_EQ(strings.sweep(3u), 0u);
+    ASSERT_EQ(strings.live(), 2u);
+    ASSERT_EQ(strings.sweep(0u), 2u);
+    ASSERT_EQ(strings.live(), 0u);
+
+    // Truncation forgets released handles above the count
+    strings.intern("e");
+    strings.truncate(1u);
+    ASSERT_EQ(strings.size(), 1u);
+    ASSERT_LE(strings.live(), 1u);
+    Int f = strings.intern("f");
+    ASSERT_LT(f - StringHeap::base, 2);
+}
@@ -36,7 +36,25 @@ TEST(Stack, Nominal)
     ASSERT_EQ(s.depth(), 0);
     ASSERT_FALSE(s.hasOverflowed());
     ASSERT_FALSE(s.hasUnderflowed());
-    ASSERT_EQ(s.sp0, s.data + Stack<int32_t>::security_margin);
+    ASSERT_EQ(reinterpret_cast<char*>(s.sp0), s.m_memory + s.m_page);
+    ASSERT_GE(s.capacity(), int32_t(size::stack));
+    ASSERT_EQ(s.guarded(s.sp0), 0);
+    ASSERT_EQ(s.guarded(s.sp0 - 1), -1);
+    ASSERT_EQ(s.guarded(s.spM - 1), 0);
+    ASSERT_EQ(s.guarded(s.spM), 1);
+    ASSERT_EQ(s.guarded(&s), 0);
+}
+
+TEST(Stack, Sized)
+{
+    Stack<int32_t> s("foo", 100000u);
+
+    ASSERT_GE(s.capacity(), 100000);
+    ASSERT_EQ((s.capacity() * sizeof(int32_t)) % s.m_page, 0u);
+    for (int32_t i = 0; i < 100000; ++i)
+        s.push(i);
+    ASSERT_EQ(s.depth(), 100000);
+    ASSERT_EQ(s.pop(), 99999);
 }
 
 TEST(Stack, PushPop)
@@ -68,20 +86,12 @@ TEST(Stack, Underflow)
 {
     Stack<int32_t> s("foo");
 
-    s.pop();
+    s.drop();
     ASSERT_EQ(s.depth(), -1);
     ASSERT_FALSE(s.hasOverflowed());
     ASSERT_TRUE(s.hasUnderflowed());
+    ASSERT_EQ(s.guarded(&s.tos()), -1);
 
-    s.push(42);
-    ASSERT_EQ(s.depth(), 0);
-    ASSERT_EQ(s.pick(0), 42);
-
-    ASSERT_FALSE(s.hasOverflowed());
-    ASSERT_FALSE(s.hasUnderflowed());
-
-    s.pop();
-    ASSERT_EQ(s.depth(), -1);
     s.reset();
     ASSERT_EQ(s.depth(), 0);
     ASSERT_FALSE(s.hasOverflowed());
@@ -91,35 +101,43 @@ TEST(Stack, Underflow)
 TEST(Stack, Overflow)
 {
     Stack<int32_t> s("foo");
-    int32_t const M = int32_t(size::stack - 2u * Stack<int32_t>::security_margin);
+    int32_t const M = s.capacity();
 
     for (int32_t i = 0; i < M; ++i)
     {
         s.push(i);
-        ASSERT_EQ(s.sp0, s.data + Stack<int32_t>::security_margin);
     }
     ASSERT_EQ(s.depth(), M);
     ASSERT_FALSE(s.hasOverflowed());
     ASSERT_FALSE(s.hasUnderflowed());
-
-    s.push(M);
-    ASSERT_EQ(s.sp0, s.data + Stack<int32_t>::security_margin);
-    ASSERT_EQ(s.depth(), M+1);
-    ASSERT_TRUE(s.hasOverflowed());
-    ASSERT_FALSE(s.hasUnderflowed());
+    ASSERT_EQ(s.guarded(s.top()), 1);
 
     s.pop();
-    ASSERT_EQ(s.depth(), M);
-    ASSERT_FALSE(s.hasOverflowed());
-    ASSERT_FALSE(s.hasUnderflowed());
-
-    s.push(M);
-    ASSERT_TRUE(s.hasOverflowed());
+    ASSERT_EQ(s.depth(), M - 1);
     s.reset();
     ASSERT_EQ(s.depth(), 0);
     ASSERT_FALSE(s.hasOverflowed());
 }
 
+TEST(StackDeathTest, GuardPages)
+{
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+    // Reading below the bottom of the stack hits the lower guard page
+    EXPECT_DEATH({
+        Stack<int32_t> s("foo");
+        volatile int32_t x = s.pop();
+        (void) x;
+    }, "");
+
+    // Writing above the top of the stack hits the upper guard page
+    EXPECT_DEATH({
+        Stack<int32_t> s("foo");
+        for (int32_t i = 0; i <= s.capacity(); ++i)
+            s.push(i);
+    }, "");
+}
+
 TEST(Stack, CheckDepth)
 {
     Stack<int32_t> s("foo");
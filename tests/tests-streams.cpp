@@ -31,6 +31,8 @@
 #include "Interpreter.hpp"
 #include "Primitives.hpp"
 #include "Streams.hpp"
+#include <chrono>
+#include <thread>
 
 using namespace forth;
 
@@ -42,12 +44,12 @@ TEST(StringStream, Nominal)
     LOGD("StringStream split step 0\n");
     ASSERT_STREQ(ss.m_name.c_str(), "");
     ASSERT_STREQ(ss.m_scriptLine.c_str(), "");
-    ASSERT_STREQ(ss.m_splitWord.c_str(), "");
+    ASSERT_EQ(ss.m_splitWord, "");
     ASSERT_EQ(ss.m_splitStart, 0u);
     ASSERT_EQ(ss.m_splitEnd, 0u);
-    ASSERT_EQ(ss.m_countLines, 0u);
-    ASSERT_EQ(ss.m_countChar, 0u);
-    ASSERT_STREQ(ss.word().c_str(), "");
+    ASSERT_EQ(ss.cursor().first, 0u);
+    ASSERT_EQ(ss.cursor().second, 0u);
+    ASSERT_EQ(ss.word(), "");
     ASSERT_EQ(ss.m_eol, true);
     ASSERT_EQ(ss.eol(), true);
 
@@ -55,12 +57,12 @@ TEST(StringStream, Nominal)
     ASSERT_EQ(ss.feed(script), true);
     ASSERT_STREQ(ss.m_name.c_str(), "String");
     ASSERT_STREQ(ss.m_scriptLine.c_str(), script);
-    ASSERT_STREQ(ss.m_splitWord.c_str(), "");
+    ASSERT_EQ(ss.m_splitWord, "");
     ASSERT_EQ(ss.m_splitStart, 0u);
     ASSERT_EQ(ss.m_splitEnd, 0u);
-    ASSERT_EQ(ss.m_countLines, 0u);
-    ASSERT_EQ(ss.m_countChar, 0u);
-    ASSERT_STREQ(ss.word().c_str(), "");
+    ASSERT_EQ(ss.cursor().first, 0u);
+    ASSERT_EQ(ss.cursor().second, 0u);
+    ASSERT_EQ(ss.word(), "");
     ASSERT_EQ(ss.m_eol, true);
     ASSERT_EQ(ss.eol(), true);
 
@@ -68,12 +70,12 @@ TEST(StringStream, Nominal)
     ASSERT_EQ(ss.split(), true);
     ASSERT_STREQ(ss.m_name.c_str(), "String");
     ASSERT_STREQ(ss.m_scriptLine.c_str(), script);
-    ASSERT_STREQ(ss.m_splitWord.c_str(), ":");
+    ASSERT_EQ(ss.m_splitWord, ":");
     ASSERT_EQ(ss.m_splitStart, 0u);
     ASSERT_EQ(ss.m_splitEnd, 1u);
-    ASSERT_EQ(ss.m_countLines, 0u);
-    ASSERT_EQ(ss.m_countChar, 0u);
-    ASSERT_STREQ(ss.word().c_str(), ":");
+    ASSERT_EQ(ss.cursor().first, 0u);
+    ASSERT_EQ(ss.cursor().second, 0u);
+    ASSERT_EQ(ss.word(), ":");
     ASSERT_EQ(ss.m_eol, false);
     ASSERT_EQ(ss.eol(), false);
 
@@ -81,12 +83,12 @@ TEST(StringStream, Nominal)
     ASSERT_EQ(ss.split(), true);
     ASSERT_STREQ(ss.m_name.c_str(), "String");
     ASSERT_STREQ(ss.m_scriptLine.c_str(), script);
-    ASSERT_STREQ(ss.m_splitWord.c_str(), "FOO");
+    ASSERT_EQ(ss.m_splitWord, "FOO");
     ASSERT_EQ(ss.m_splitStart, 2u);
     ASSERT_EQ(ss.m_splitEnd, 5u);
-    ASSERT_EQ(ss.m_countLines, 0u);
-    //ASSERT_EQ(ss.m_countChar, 2u);
-    ASSERT_STREQ(ss.word().c_str(), "FOO");
+    ASSERT_EQ(ss.cursor().first, 0u);
+    ASSERT_EQ(ss.cursor().second, 2u);
+    ASSERT_EQ(ss.word(), "FOO");
     ASSERT_EQ(ss.m_eol, false);
     ASSERT_EQ(ss.eol(), false);
 
@@ -94,23 +96,23 @@ TEST(StringStream, Nominal)
     ASSERT_EQ(ss.split(), true);
     ASSERT_STREQ(ss.m_name.c_str(), "String");
     ASSERT_STREQ(ss.m_scriptLine.c_str(), script);
-    ASSERT_STREQ(ss.m_splitWord.c_str(), "+");
+    ASSERT_EQ(ss.m_splitWord, "+");
     ASSERT_EQ(ss.m_splitStart, 6u);
     ASSERT_EQ(ss.m_splitEnd, 7u);
-    ASSERT_EQ(ss.m_countLines, 0u);
-    //ASSERT_EQ(ss.m_countChar, 2u);
-    ASSERT_STREQ(ss.word().c_str(), "+");
+    ASSERT_EQ(ss.cursor().first, 0u);
+    ASSERT_EQ(ss.cursor().second, 6u);
+    ASSERT_EQ(ss.word(), "+");
 
     LOGD("StringStream split step 5\n");
     ASSERT_EQ(ss.split(), true);
     ASSERT_STREQ(ss.m_name.c_str(), "String");
     ASSERT_STREQ(ss.m_scriptLine.c_str(), script);
-    ASSERT_STREQ(ss.m_splitWord.c_str(), ".");
+    ASSERT_EQ(ss.m_splitWord, ".");
     ASSERT_EQ(ss.m_splitStart, 8u);
     ASSERT_EQ(ss.m_splitEnd, 9u);
-    ASSERT_EQ(ss.m_countLines, 0u);
-    //ASSERT_EQ(ss.m_countChar, 2u);
-    ASSERT_STREQ(ss.word().c_str(), ".");
+    ASSERT_EQ(ss.cursor().first, 0u);
+    ASSERT_EQ(ss.cursor().second, 8u);
+    ASSERT_EQ(ss.word(), ".");
     ASSERT_EQ(ss.m_eol, false);
     ASSERT_EQ(ss.eol(), false);
 
@@ -118,12 +120,12 @@ TEST(StringStream, Nominal)
     ASSERT_EQ(ss.split(), true);
     ASSERT_STREQ(ss.m_name.c_str(), "String");
     ASSERT_STREQ(ss.m_scriptLine.c_str(), script);
-    ASSERT_STREQ(ss.m_splitWord.c_str(), ";");
+    ASSERT_EQ(ss.m_splitWord, ";");
     ASSERT_EQ(ss.m_splitStart, 10u);
     ASSERT_EQ(ss.m_splitEnd, 11u);
-    ASSERT_EQ(ss.m_countLines, 0u);
-    //ASSERT_EQ(ss.m_countChar, 2u);
-    ASSERT_STREQ(ss.word().c_str(), ";");
+    ASSERT_EQ(ss.cursor().first, 0u);
+    ASSERT_EQ(ss.cursor().second, 10u);
+    ASSERT_EQ(ss.word(), ";");
     ASSERT_EQ(ss.m_eol, true);
     ASSERT_EQ(ss.eol(), true);
 
@@ -131,12 +133,12 @@ TEST(StringStream, Nominal)
     ASSERT_EQ(ss.split(), true);
     ASSERT_STREQ(ss.m_name.c_str(), "String");
     ASSERT_STREQ(ss.m_scriptLine.c_str(), script);
-    ASSERT_STREQ(ss.m_splitWord.c_str(), "12");
+    ASSERT_EQ(ss.m_splitWord, "12");
     ASSERT_EQ(ss.m_splitStart, 14u);
     ASSERT_EQ(ss.m_splitEnd, 16u);
-    ASSERT_EQ(ss.m_countLines, 1u);
-    //ASSERT_EQ(ss.m_countChar, 2u);
-    ASSERT_STREQ(ss.word().c_str(), "12");
+    ASSERT_EQ(ss.cursor().first, 1u);
+    ASSERT_EQ(ss.cursor().second, 2u);
+    ASSERT_EQ(ss.word(), "12");
     ASSERT_EQ(ss.m_eol, false);
     ASSERT_EQ(ss.eol(), false);
 
@@ -144,12 +146,12 @@ TEST(StringStream, Nominal)
     ASSERT_EQ(ss.split(), true);
     ASSERT_STREQ(ss.m_name.c_str(), "String");
     ASSERT_STREQ(ss.m_scriptLine.c_str(), script);
-    ASSERT_STREQ(ss.m_splitWord.c_str(), "4245");
+    ASSERT_EQ(ss.m_splitWord, "4245");
     ASSERT_EQ(ss.m_splitStart, 17u);
     ASSERT_EQ(ss.m_splitEnd, 21u);
-    ASSERT_EQ(ss.m_countLines, 1u);
-    //ASSERT_EQ(ss.m_countChar, 2u);
-    ASSERT_STREQ(ss.word().c_str(), "4245");
+    ASSERT_EQ(ss.cursor().first, 1u);
+    ASSERT_EQ(ss.cursor().second, 5u);
+    ASSERT_EQ(ss.word(), "4245");
     ASSERT_EQ(ss.m_eol, true);
     ASSERT_EQ(ss.eol(), true);
 
@@ -157,12 +159,12 @@ TEST(StringStream, Nominal)
     ASSERT_EQ(ss.split(), false);
     ASSERT_STREQ(ss.m_name.c_str(), "String");
     ASSERT_STREQ(ss.m_scriptLine.c_str(), script);
-    ASSERT_STREQ(ss.m_splitWord.c_str(), "");
+    ASSERT_EQ(ss.m_splitWord, "");
     ASSERT_EQ(ss.m_splitStart, std::string::npos);
     ASSERT_EQ(ss.m_splitEnd, std::string::npos);
-    ASSERT_EQ(ss.m_countLines, 1u);
-    //ASSERT_EQ(ss.m_countChar, 2u);
-    ASSERT_STREQ(ss.word().c_str(), "");
+    ASSERT_EQ(ss.cursor().first, 1u);
+    ASSERT_EQ(ss.cursor().second, 12u);
+    ASSERT_EQ(ss.word(), "");
     ASSERT_EQ(ss.m_eol, true);
     ASSERT_EQ(ss.eol(), true);
 
@@ -179,12 +181,12 @@ TEST(StringStream, PathologicalCases)
     ASSERT_EQ(ss.feed(nullptr), false);
     ASSERT_STREQ(ss.m_name.c_str(), "");
     ASSERT_STREQ(ss.m_scriptLine.c_str(), "");
-    ASSERT_STREQ(ss.m_splitWord.c_str(), "");
+    ASSERT_EQ(ss.m_splitWord, "");
     ASSERT_EQ(ss.m_splitStart, 0u);
     ASSERT_EQ(ss.m_splitEnd, 0u);
     ASSERT_EQ(ss.m_countLines, 0u);
-    ASSERT_EQ(ss.m_countChar, 0u);
-    ASSERT_STREQ(ss.word().c_str(), "");
+    ASSERT_EQ(ss.cursor().second, 0u);
+    ASSERT_EQ(ss.word(), "");
     ASSERT_EQ(ss.m_eol, true);
     ASSERT_EQ(ss.eol(), true);
 
@@ -192,12 +194,12 @@ TEST(StringStream, PathologicalCases)
     ASSERT_EQ(ss.feed(""), true);
     ASSERT_STREQ(ss.m_name.c_str(), "String");
     ASSERT_STREQ(ss.m_scriptLine.c_str(), "");
-    ASSERT_STREQ(ss.m_splitWord.c_str(), "");
+    ASSERT_EQ(ss.m_splitWord, "");
     ASSERT_EQ(ss.m_splitStart, 0u);
     ASSERT_EQ(ss.m_splitEnd, 0u);
     ASSERT_EQ(ss.m_countLines, 0u);
-    ASSERT_EQ(ss.m_countChar, 0u);
-    ASSERT_STREQ(ss.word().c_str(), "");
+    ASSERT_EQ(ss.cursor().second, 0u);
+    ASSERT_EQ(ss.word(), "");
     ASSERT_EQ(ss.m_eol, true);
     ASSERT_EQ(ss.eol(), true);
 }
@@ -210,12 +212,12 @@ TEST(FileStream, Nominal)
     LOGD("FileStream split step 0\n");
     ASSERT_STREQ(fs.m_name.c_str(), "");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), "");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), "");
+    ASSERT_EQ(fs.m_splitWord, "");
     ASSERT_EQ(fs.m_splitStart, 0u);
     ASSERT_EQ(fs.m_splitEnd, 0u);
     ASSERT_EQ(fs.m_countLines, 0u);
-    ASSERT_EQ(fs.m_countChar, 0u);
-    ASSERT_STREQ(fs.word().c_str(), "");
+    ASSERT_EQ(fs.cursor().second, 0u);
+    ASSERT_EQ(fs.word(), "");
     ASSERT_EQ(fs.m_eol, true);
     ASSERT_EQ(fs.eol(), true);
 
@@ -223,12 +225,12 @@ TEST(FileStream, Nominal)
     ASSERT_EQ(fs.feed("/tmp/foo.fs"), true);
     ASSERT_STREQ(fs.m_name.c_str(), "/tmp/foo.fs");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), ": FOO + . ;");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), "");
+    ASSERT_EQ(fs.m_splitWord, "");
     ASSERT_EQ(fs.m_splitStart, 0u);
     ASSERT_EQ(fs.m_splitEnd, 0u);
     ASSERT_EQ(fs.m_countLines, 1u);
-    ASSERT_EQ(fs.m_countChar, 0u);
-    ASSERT_STREQ(fs.word().c_str(), "");
+    ASSERT_EQ(fs.cursor().second, 0u);
+    ASSERT_EQ(fs.word(), "");
     ASSERT_EQ(fs.m_eol, true);
     ASSERT_EQ(fs.eol(), true);
 
@@ -236,12 +238,12 @@ TEST(FileStream, Nominal)
     ASSERT_EQ(fs.split(), true);
     ASSERT_STREQ(fs.m_name.c_str(), "/tmp/foo.fs");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), ": FOO + . ;");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), ":");
+    ASSERT_EQ(fs.m_splitWord, ":");
     ASSERT_EQ(fs.m_splitStart, 0u);
     ASSERT_EQ(fs.m_splitEnd, 1u);
     ASSERT_EQ(fs.m_countLines, 1u);
-    ASSERT_EQ(fs.m_countChar, 0u);
-    ASSERT_STREQ(fs.word().c_str(), ":");
+    ASSERT_EQ(fs.cursor().second, 0u);
+    ASSERT_EQ(fs.word(), ":");
     ASSERT_EQ(fs.m_eol, false);
     ASSERT_EQ(fs.eol(), false);
 
@@ -249,12 +251,12 @@ TEST(FileStream, Nominal)
     ASSERT_EQ(fs.split(), true);
     ASSERT_STREQ(fs.m_name.c_str(), "/tmp/foo.fs");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), ": FOO + . ;");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), "FOO");
+    ASSERT_EQ(fs.m_splitWord, "FOO");
     ASSERT_EQ(fs.m_splitStart, 2u);
     ASSERT_EQ(fs.m_splitEnd, 5u);
     ASSERT_EQ(fs.m_countLines, 1u);
-    //ASSERT_EQ(fs.m_countChar, 2u);
-    ASSERT_STREQ(fs.word().c_str(), "FOO");
+    ASSERT_EQ(fs.cursor().second, 2u);
+    ASSERT_EQ(fs.word(), "FOO");
     ASSERT_EQ(fs.m_eol, false);
     ASSERT_EQ(fs.eol(), false);
 
@@ -262,12 +264,12 @@ TEST(FileStream, Nominal)
     ASSERT_EQ(fs.split(), true);
     ASSERT_STREQ(fs.m_name.c_str(), "/tmp/foo.fs");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), ": FOO + . ;");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), "+");
+    ASSERT_EQ(fs.m_splitWord, "+");
     ASSERT_EQ(fs.m_splitStart, 6u);
     ASSERT_EQ(fs.m_splitEnd, 7u);
     ASSERT_EQ(fs.m_countLines, 1u);
-    //ASSERT_EQ(fs.m_countChar, 2u);
-    ASSERT_STREQ(fs.word().c_str(), "+");
+    ASSERT_EQ(fs.cursor().second, 6u);
+    ASSERT_EQ(fs.word(), "+");
     ASSERT_EQ(fs.m_eol, false);
     ASSERT_EQ(fs.eol(), false);
 
@@ -275,12 +277,12 @@ TEST(FileStream, Nominal)
     ASSERT_EQ(fs.split(), true);
     ASSERT_STREQ(fs.m_name.c_str(), "/tmp/foo.fs");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), ": FOO + . ;");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), ".");
+    ASSERT_EQ(fs.m_splitWord, ".");
     ASSERT_EQ(fs.m_splitStart, 8u);
     ASSERT_EQ(fs.m_splitEnd, 9u);
     ASSERT_EQ(fs.m_countLines, 1u);
-    //ASSERT_EQ(fs.m_countChar, 2u);
-    ASSERT_STREQ(fs.word().c_str(), ".");
+    ASSERT_EQ(fs.cursor().second, 8u);
+    ASSERT_EQ(fs.word(), ".");
     ASSERT_EQ(fs.m_eol, false);
     ASSERT_EQ(fs.eol(), false);
 
@@ -288,12 +290,12 @@ TEST(FileStream, Nominal)
     ASSERT_EQ(fs.split(), true);
     ASSERT_STREQ(fs.m_name.c_str(), "/tmp/foo.fs");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), ": FOO + . ;");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), ";");
+    ASSERT_EQ(fs.m_splitWord, ";");
     ASSERT_EQ(fs.m_splitStart, 10u);
     ASSERT_EQ(fs.m_splitEnd, std::string::npos);
     ASSERT_EQ(fs.m_countLines, 1u);
-    //ASSERT_EQ(fs.m_countChar, 2u);
-    ASSERT_STREQ(fs.word().c_str(), ";");
+    ASSERT_EQ(fs.cursor().second, 10u);
+    ASSERT_EQ(fs.word(), ";");
     ASSERT_EQ(fs.m_eol, true);
     ASSERT_EQ(fs.eol(), true);
 
@@ -301,12 +303,12 @@ TEST(FileStream, Nominal)
     ASSERT_EQ(fs.split(), true);
     ASSERT_STREQ(fs.m_name.c_str(), "/tmp/foo.fs");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), "  4245   ");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), "4245");
+    ASSERT_EQ(fs.m_splitWord, "4245");
     ASSERT_EQ(fs.m_splitStart, 2u);
     ASSERT_EQ(fs.m_splitEnd, 6u);
     ASSERT_EQ(fs.m_countLines, 2u);
-    //ASSERT_EQ(fs.m_countChar, 2u);
-    ASSERT_STREQ(fs.word().c_str(), "4245");
+    ASSERT_EQ(fs.cursor().second, 2u);
+    ASSERT_EQ(fs.word(), "4245");
     ASSERT_EQ(fs.m_eol, true);
     ASSERT_EQ(fs.eol(), true);
 
@@ -314,12 +316,12 @@ TEST(FileStream, Nominal)
     ASSERT_EQ(fs.split(), false);
     ASSERT_STREQ(fs.m_name.c_str(), "/tmp/foo.fs");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), "");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), "");
+    ASSERT_EQ(fs.m_splitWord, "");
     ASSERT_EQ(fs.m_splitStart, 0u);
     ASSERT_EQ(fs.m_splitEnd, 0u);
     ASSERT_EQ(fs.m_countLines, 2u);
-    //ASSERT_EQ(fs.m_countChar, 2u);
-    ASSERT_STREQ(fs.word().c_str(), "");
+    ASSERT_EQ(fs.cursor().second, 0u);
+    ASSERT_EQ(fs.word(), "");
     ASSERT_EQ(fs.m_eol, true);
     ASSERT_EQ(fs.eol(), true);
 
@@ -327,12 +329,12 @@ TEST(FileStream, Nominal)
     ASSERT_EQ(fs.feed("/tmp/foo.fs"), true);
     ASSERT_STREQ(fs.m_name.c_str(), "/tmp/foo.fs");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), ": FOO + . ;");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), "");
+    ASSERT_EQ(fs.m_splitWord, "");
     ASSERT_EQ(fs.m_splitStart, 0u);
     ASSERT_EQ(fs.m_splitEnd, 0u);
     ASSERT_EQ(fs.m_countLines, 1u);
-    ASSERT_EQ(fs.m_countChar, 0u);
-    ASSERT_STREQ(fs.word().c_str(), "");
+    ASSERT_EQ(fs.cursor().second, 0u);
+    ASSERT_EQ(fs.word(), "");
     ASSERT_EQ(fs.m_eol, true);
     ASSERT_EQ(fs.eol(), true);
 
@@ -350,12 +352,12 @@ TEST(FileStream, PathologicalCases)
     ASSERT_STREQ(fs.error().c_str(), "");
     ASSERT_STREQ(fs.m_name.c_str(), "");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), "");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), "");
+    ASSERT_EQ(fs.m_splitWord, "");
     ASSERT_EQ(fs.m_splitStart, 0u);
     ASSERT_EQ(fs.m_splitEnd, 0u);
     ASSERT_EQ(fs.m_countLines, 0u);
-    ASSERT_EQ(fs.m_countChar, 0u);
-    ASSERT_STREQ(fs.word().c_str(), "");
+    ASSERT_EQ(fs.cursor().second, 0u);
+    ASSERT_EQ(fs.word(), "");
     ASSERT_EQ(fs.m_eol, true);
     ASSERT_EQ(fs.eol(), true);
 
@@ -364,12 +366,12 @@ TEST(FileStream, PathologicalCases)
     ASSERT_STREQ(fs.error().c_str(), "");
     ASSERT_STREQ(fs.m_name.c_str(), "/tmp/dummy.fs");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), "");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), "");
+    ASSERT_EQ(fs.m_splitWord, "");
     ASSERT_EQ(fs.m_splitStart, 0u);
     ASSERT_EQ(fs.m_splitEnd, 0u);
     ASSERT_EQ(fs.m_countLines, 0u);
-    ASSERT_EQ(fs.m_countChar, 0u);
-    ASSERT_STREQ(fs.word().c_str(), "");
+    ASSERT_EQ(fs.cursor().second, 0u);
+    ASSERT_EQ(fs.word(), "");
     ASSERT_EQ(fs.m_eol, true);
     ASSERT_EQ(fs.eol(), true);
 
@@ -377,12 +379,12 @@ TEST(FileStream, PathologicalCases)
     ASSERT_EQ(fs.split(), false);
     ASSERT_STREQ(fs.m_name.c_str(), "/tmp/dummy.fs");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), "");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), "");
+    ASSERT_EQ(fs.m_splitWord, "");
     ASSERT_EQ(fs.m_splitStart, 0u);
     ASSERT_EQ(fs.m_splitEnd, 0u);
     ASSERT_EQ(fs.m_countLines, 0u);
-    ASSERT_EQ(fs.m_countChar, 0u);
-    ASSERT_STREQ(fs.word().c_str(), "");
+    ASSERT_EQ(fs.cursor().second, 0u);
+    ASSERT_EQ(fs.word(), "");
     ASSERT_EQ(fs.m_eol, true);
     ASSERT_EQ(fs.eol(), true);
 
@@ -392,12 +394,12 @@ TEST(FileStream, PathologicalCases)
     ASSERT_EQ(fs.feed("/tmp/doesnotexit.fs"), false);
     ASSERT_STREQ(fs.m_name.c_str(), "/tmp/doesnotexit.fs");
     ASSERT_STREQ(fs.m_scriptLine.c_str(), "");
-    ASSERT_STREQ(fs.m_splitWord.c_str(), "");
+    ASSERT_EQ(fs.m_splitWord, "");
     ASSERT_EQ(fs.m_splitStart, 0u);
     ASSERT_EQ(fs.m_splitEnd, 0u);
     ASSERT_EQ(fs.m_countLines, 0u);
-    ASSERT_EQ(fs.m_countChar, 0u);
-    ASSERT_STREQ(fs.word().c_str(), "");
+    ASSERT_EQ(fs.cursor().second, 0u);
+    ASSERT_EQ(fs.word(), "");
     ASSERT_EQ(fs.m_eol, true);
     ASSERT_EQ(fs.eol(), true);
     ASSERT_EQ(fs.split(), false);
@@ -411,21 +413,21 @@ TEST(FileStream, SkipLine)
     ASSERT_EQ(fs.feed("/tmp/foo.fs"), true);
 
     ASSERT_EQ(fs.split(), true);
-    ASSERT_STREQ(fs.word().c_str(), "\\");
+    ASSERT_EQ(fs.word(), "\\");
     ASSERT_EQ(fs.eol(), false);
 
     ASSERT_EQ(fs.skipLine(), true);
-    ASSERT_STREQ(fs.word().c_str(), "");
+    ASSERT_EQ(fs.word(), "");
     ASSERT_EQ(fs.eol(), true);
     ASSERT_EQ(fs.m_countLines, 1u);
 
     ASSERT_EQ(fs.split(), true);
-    ASSERT_STREQ(fs.word().c_str(), "1");
+    ASSERT_EQ(fs.word(), "1");
     ASSERT_EQ(fs.eol(), true);
     ASSERT_EQ(fs.m_countLines, 2u);
 
     ASSERT_EQ(fs.split(), false);
-    ASSERT_STREQ(fs.word().c_str(), "");
+    ASSERT_EQ(fs.word(), "");
     ASSERT_EQ(fs.eol(), true);
     ASSERT_EQ(fs.m_countLines, 2u);
     ASSERT_STREQ(fs.error().c_str(), "");
@@ -441,16 +443,16 @@ TEST(FileStream, SkipLineEOF)
     ASSERT_EQ(fs.feed("/tmp/foo.fs"), true);
 
     ASSERT_EQ(fs.split(), true);
-    ASSERT_STREQ(fs.word().c_str(), "\\");
+    ASSERT_EQ(fs.word(), "\\");
     ASSERT_EQ(fs.eol(), false);
 
     ASSERT_EQ(fs.skipLine(), true);
-    ASSERT_STREQ(fs.word().c_str(), "");
+    ASSERT_EQ(fs.word(), "");
     ASSERT_EQ(fs.eol(), true);
     ASSERT_EQ(fs.m_countLines, 1u);
 
     ASSERT_EQ(fs.split(), false);
-    ASSERT_STREQ(fs.word().c_str(), "");
+    ASSERT_EQ(fs.word(), "");
     ASSERT_EQ(fs.eol(), true);
     ASSERT_STREQ(fs.error().c_str(), "");
 
@@ -463,16 +465,16 @@ TEST(StringStream, SkipLine)
     ASSERT_EQ(ss.feed("\\ HELLO"), true);
 
     ASSERT_EQ(ss.split(), true);
-    ASSERT_STREQ(ss.word().c_str(), "\\");
+    ASSERT_EQ(ss.word(), "\\");
     ASSERT_EQ(ss.eol(), false);
 
     ASSERT_EQ(ss.skipLine(), true);
-    ASSERT_STREQ(ss.word().c_str(), "");
+    ASSERT_EQ(ss.word(), "");
     ASSERT_EQ(ss.eol(), true);
     ASSERT_EQ(ss.m_countLines, 0u);
 
     ASSERT_EQ(ss.split(), false);
-    ASSERT_STREQ(ss.word().c_str(), "");
+    ASSERT_EQ(ss.word(), "");
     ASSERT_EQ(ss.eol(), true);
     ASSERT_STREQ(ss.error().c_str(), "");
 }
@@ -546,6 +548,237 @@ TEST(StringStream, SkipFile)
     ASSERT_EQ(forth.boot(), true);
     ASSERT_EQ(forth.interpretFile("/tmp/f1.fth"), true);
     ASSERT_EQ(forth.dataStack().depth(), 2);
-    ASSERT_EQ(forth.dataStack().pop().i, 9);
-    ASSERT_EQ(forth.dataStack().pop().i, 3);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 9);
+    ASSERT_EQ(forth.dataStack().pop().integer(), 3);
+}
+
+TEST(MappedFileStream, Nominal)
+{
+    MappedFileStream fs;
+    ASSERT_EQ(system("echo \": FOO + . ;\n  4245   \" > /tmp/foo.fs"), 0);
+
+    LOGD("MappedFileStream split step 0\n");
+    ASSERT_EQ(fs.m_data, nullptr);
+    ASSERT_EQ(fs.m_buffer, "");
+    ASSERT_EQ(fs.word(), "");
+    ASSERT_EQ(fs.eol(), true);
+
+    LOGD("MappedFileStream split step 1\n");
+    ASSERT_EQ(fs.feed("/tmp/foo.fs"), true);
+    ASSERT_STREQ(fs.m_name.c_str(), "/tmp/foo.fs");
+    ASSERT_NE(fs.m_data, nullptr);
+    ASSERT_EQ(fs.m_size, 22u);
+    ASSERT_EQ(fs.m_buffer, ": FOO + . ;");
+    ASSERT_STREQ(fs.m_scriptLine.c_str(), "");
+    ASSERT_EQ(fs.m_countLines, 1u);
+
+    LOGD("MappedFileStream split step 2\n");
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), ":");
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), "FOO");
+    ASSERT_EQ(fs.cursor().first, 1u);
+    ASSERT_EQ(fs.cursor().second, 2u);
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), "+");
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), ".");
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), ";");
+    ASSERT_EQ(fs.eol(), true);
+
+    LOGD("MappedFileStream split step 3\n");
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.m_buffer, "  4245   ");
+    ASSERT_EQ(fs.word(), "4245");
+    ASSERT_EQ(fs.cursor().first, 2u);
+    ASSERT_EQ(fs.cursor().second, 2u);
+    ASSERT_EQ(fs.eol(), true);
+
+    LOGD("MappedFileStream split step 4\n");
+    ASSERT_EQ(fs.split(), false);
+    ASSERT_EQ(fs.word(), "");
+    ASSERT_EQ(fs.m_countLines, 2u);
+    ASSERT_STREQ(fs.error().c_str(), "");
+
+    LOGD("MappedFileStream split step 5\n");
+    ASSERT_EQ(fs.feed("/tmp/foo.fs"), true);
+    ASSERT_EQ(fs.m_buffer, ": FOO + . ;");
+    ASSERT_EQ(fs.m_countLines, 1u);
+    ASSERT_EQ(fs.skipLine(), true);
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), "4245");
+
+    ASSERT_EQ(system("rm -fr /tmp/foo.fs"), 0);
+
+    LOGD("MappedFileStream pathological cases\n");
+    ASSERT_EQ(fs.feed(nullptr), false);
+    ASSERT_EQ(system("rm -fr /tmp/dummy.fs 2> /dev/null; touch /tmp/dummy.fs"), 0);
+    ASSERT_EQ(fs.feed("/tmp/dummy.fs"), false);
+    ASSERT_STREQ(fs.error().c_str(), "");
+    ASSERT_EQ(fs.m_data, nullptr);
+    ASSERT_EQ(fs.split(), false);
+    ASSERT_EQ(system("rm -fr /tmp/dummy.fs"), 0);
+    ASSERT_EQ(fs.feed("/tmp/doesnotexit.fs"), false);
+    ASSERT_STRNE(fs.error().c_str(), "");
+    ASSERT_EQ(fs.split(), false);
+}
+
+TEST(PipelinedFileStream, Nominal)
+{
+    PipelinedFileStream fs;
+    Cell number;
+    ASSERT_EQ(system("echo \": FOO + . ;\n  4245 S\\\" 12\\\"3 -1.5  \" > /tmp/foo.fs"), 0);
+
+    LOGD("PipelinedFileStream split step 0\n");
+    ASSERT_EQ(fs.m_buffer, "");
+    ASSERT_EQ(fs.word(), "");
+    ASSERT_EQ(fs.eol(), true);
+    ASSERT_EQ(fs.split(), false);
+
+    LOGD("PipelinedFileStream split step 1\n");
+    ASSERT_EQ(fs.feed("/tmp/foo.fs"), true);
+    ASSERT_STREQ(fs.m_name.c_str(), "/tmp/foo.fs");
+    ASSERT_EQ(fs.m_buffer, ": FOO + . ;");
+    ASSERT_EQ(fs.m_lexemes.size(), 5u);
+    ASSERT_EQ(fs.m_countLines, 1u);
+
+    LOGD("PipelinedFileStream split step 2\n");
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), ":");
+    ASSERT_EQ(fs.number(10, number), false);
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), "FOO");
+    ASSERT_EQ(fs.cursor().first, 1u);
+    ASSERT_EQ(fs.cursor().second, 2u);
+    ASSERT_EQ(fs.eol(), false);
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), "+");
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), ".");
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), ";");
+    ASSERT_EQ(fs.eol(), true);
+
+    LOGD("PipelinedFileStream split step 3: pre-converted numbers\n");
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.m_buffer, "  4245 S\" 12\"3 -1.5  ");
+    ASSERT_EQ(fs.word(), "4245");
+    ASSERT_EQ(fs.cursor().first, 2u);
+    ASSERT_EQ(fs.cursor().second, 2u);
+    ASSERT_EQ(fs.number(16, number), false);
+    ASSERT_EQ(fs.number(10, number), true);
+    ASSERT_EQ(number.isInteger(), true);
+    ASSERT_EQ(number.integer(), 4245);
+
+    LOGD("PipelinedFileStream split step 4: parsing word\n");
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), "S\"");
+    ASSERT_EQ(fs.split("\""), true);
+    ASSERT_EQ(fs.word(), "12");
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), "3");
+    ASSERT_EQ(fs.number(10, number), false);
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), "-1.5");
+    ASSERT_EQ(fs.number(10, number), true);
+    ASSERT_EQ(number.isReal(), true);
+    ASSERT_EQ(number.real(), -1.5);
+    ASSERT_EQ(fs.eol(), true);
+
+    LOGD("PipelinedFileStream split step 5\n");
+    ASSERT_EQ(fs.split(), false);
+    ASSERT_EQ(fs.word(), "");
+    ASSERT_EQ(fs.m_countLines, 2u);
+    ASSERT_STREQ(fs.error().c_str(), "");
+
+    LOGD("PipelinedFileStream split step 6\n");
+    ASSERT_EQ(fs.feed("/tmp/foo.fs"), true);
+    ASSERT_EQ(fs.m_buffer, ": FOO + . ;");
+    ASSERT_EQ(fs.m_countLines, 1u);
+    ASSERT_EQ(fs.skipLine(), true);
+    ASSERT_EQ(fs.split(), true);
+    ASSERT_EQ(fs.word(), "4245");
+    ASSERT_EQ(fs.skipFile(), true);
+    ASSERT_EQ(fs.skipLine(), true);
+    ASSERT_EQ(fs.split(), false);
+
+    ASSERT_EQ(system("rm -fr /tmp/foo.fs"), 0);
+
+    LOGD("PipelinedFileStream pathological cases\n");
+    ASSERT_EQ(fs.feed(nullptr), false);
+    ASSERT_EQ(system("rm -fr /tmp/dummy.fs 2> /dev/null; touch /tmp/dummy.fs"), 0);
+    ASSERT_EQ(fs.feed("/tmp/dummy.fs"), false);
+    ASSERT_STREQ(fs.error().c_str(), "");
+    ASSERT_EQ(fs.split(), false);
+    ASSERT_EQ(system("rm -fr /tmp/dummy.fs"), 0);
+    ASSERT_EQ(fs.feed("/tmp/doesnotexit.fs"), false);
+    ASSERT_STRNE(fs.error().c_str(), "");
+    ASSERT_EQ(fs.split(), false);
+}
+
+TEST(PipelinedFileStream, LongFile)
+{
+    // More lines than the ring buffer: the lexer sleeps while it is full and
+    // the interpreter while it is empty.
+    ASSERT_EQ(system("seq 1 5000 > /tmp/long.fs"), 0);
+
+    PipelinedFileStream fs;
+    Cell number;
+    Int sum = 0;
+    ASSERT_EQ(fs.feed("/tmp/long.fs"), true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    while (fs.split())
+    {
+        ASSERT_EQ(fs.number(10, number), true);
+        sum += number.integer();
+        if ((number.integer() % 1000) == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(sum, 5000 * 5001 / 2);
+    ASSERT_EQ(fs.m_countLines, 5000u);
+    ASSERT_STREQ(fs.error().c_str(), "");
+
+    // Stopped while the lexer is sleeping on a full ring buffer
+    ASSERT_EQ(fs.feed("/tmp/long.fs"), true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ASSERT_EQ(fs.skipFile(), true);
+    ASSERT_EQ(fs.skipLine(), true);
+    ASSERT_EQ(fs.split(), false);
+
+    ASSERT_EQ(system("rm -fr /tmp/long.fs"), 0);
+}
+
+TEST(StringStream, Borrow)
+{
+    std::string script(": FOO + . ;\n  12");
+    StringStream ss(std::string_view(script.data(), 15u), StringStream::Mode::Borrow);
+
+    // No copy has been made
+    ASSERT_STREQ(ss.m_scriptLine.c_str(), "");
+    ASSERT_EQ(ss.m_buffer.data(), script.data());
+    ASSERT_EQ(ss.m_buffer.size(), 15u);
+
+    ASSERT_EQ(ss.split(), true);
+    ASSERT_EQ(ss.word(), ":");
+    ASSERT_EQ(ss.word().data(), script.data());
+    ASSERT_EQ(ss.split(), true);
+    ASSERT_EQ(ss.split(), true);
+    ASSERT_EQ(ss.split(), true);
+    ASSERT_EQ(ss.split(), true);
+    ASSERT_EQ(ss.word(), ";");
+
+    // Chars after the given size are ignored
+    ASSERT_EQ(ss.split(), true);
+    ASSERT_EQ(ss.word(), "1");
+    ASSERT_EQ(ss.cursor().first, 1u);
+    ASSERT_EQ(ss.cursor().second, 2u);
+    ASSERT_EQ(ss.split(), false);
+
+    // Copy mode
+    ASSERT_EQ(ss.feed(std::string_view(script), StringStream::Mode::Copy), true);
+    ASSERT_STREQ(ss.m_scriptLine.c_str(), script.c_str());
+    ASSERT_NE(ss.m_buffer.data(), script.data());
+    ASSERT_EQ(ss.split(), true);
+    ASSERT_EQ(ss.word(), ":");
 }
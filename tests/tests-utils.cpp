@@ -306,6 +306,67 @@ TEST(Utils, ChecktoInteger)
     ret = forth::toInteger("$-7b", 16, number);
     ASSERT_EQ(ret, true);
     ASSERT_EQ(number.integer(), -123);
+
+    // Other bases and prefixes
+    ret = forth::toInteger("%1111011", 10, number);
+    ASSERT_EQ(ret, true);
+    ASSERT_EQ(number.integer(), 123);
+
+    ret = forth::toInteger("#123", 16, number);
+    ASSERT_EQ(ret, true);
+    ASSERT_EQ(number.integer(), 123);
+
+    ret = forth::toInteger("3F", 36, number);
+    ASSERT_EQ(ret, true);
+    ASSERT_EQ(number.integer(), 3 * 36 + 15);
+
+    ret = forth::toInteger("BEEF", 16, number);
+    ASSERT_EQ(ret, true);
+    ASSERT_EQ(number.integer(), 0xBEEF);
+
+    // Malformed numbers
+    ret = forth::toInteger("12", 2, number);
+    ASSERT_EQ(ret, false);
+
+    ret = forth::toInteger("-", 10, number);
+    ASSERT_EQ(ret, false);
+
+    ret = forth::toInteger("$", 10, number);
+    ASSERT_EQ(ret, false);
+
+    ret = forth::toInteger("1.5", 10, number);
+    ASSERT_EQ(ret, false);
+
+    ret = forth::toInteger("12", 37, number);
+    ASSERT_EQ(ret, false);
+}
+
+//------------------------------------------------------------------------------
+TEST(Utils, ChecktoReal)
+{
+    forth::Cell number;
+    bool ret;
+
+    ret = forth::toReal("1.5", number);
+    ASSERT_EQ(ret, true);
+    ASSERT_EQ(number.real(), 1.5);
+
+    ret = forth::toReal("-2.5e3", number);
+    ASSERT_EQ(ret, true);
+    ASSERT_EQ(number.real(), -2500.0);
+
+    ret = forth::toReal("+0.25", number);
+    ASSERT_EQ(ret, true);
+    ASSERT_EQ(number.real(), 0.25);
+
+    ret = forth::toReal("1,5", number);
+    ASSERT_EQ(ret, false);
+
+    ret = forth::toReal("1.5x", number);
+    ASSERT_EQ(ret, false);
+
+    ret = forth::toReal("+-1.5", number);
+    ASSERT_EQ(ret, false);
 }
 
 //------------------------------------------------------------------------------
@@ -339,20 +400,29 @@ TEST(Utils, CheckBigNumber)
     bool ret;
 
     // No integer out of range error
-    ret = forth::toInteger("9223372036854775807", 10, number);
+    ret = forth::toInteger(std::to_string(forth::Cell::MAX_INTEGER), 10, number);
     ASSERT_EQ(ret, true);
     ASSERT_EQ(number.isInteger(), true);
-    ASSERT_EQ(number.integer(), 9223372036854775807);
-
-    // Integer out of range error
-    try {
-        ret = forth::toInteger("92233720368547758078", 10, number);
-        ASSERT_TRUE(false && "Exception out_of_range expected");
-    }
-    catch (const std::out_of_range&)
-    {
-        ASSERT_TRUE(true);
-    }
+    ASSERT_EQ(number.integer(), forth::Cell::MAX_INTEGER);
+
+    ret = forth::toInteger(std::to_string(-forth::Cell::MAX_INTEGER - 1), 10, number);
+    ASSERT_EQ(ret, true);
+    ASSERT_EQ(number.isInteger(), true);
+    ASSERT_EQ(number.integer(), -forth::Cell::MAX_INTEGER - 1);
+
+    // Integer out of range: no exception but converted to float
+    ret = forth::toInteger("92233720368547758078", 10, number);
+    ASSERT_EQ(ret, true);
+    ASSERT_EQ(number.isReal(), true);
+    ASSERT_EQ(number.real(), 92233720368547758080.000);
+
+    ret = forth::toInteger("$10000000000000000", 10, number);
+    ASSERT_EQ(ret, true);
+    ASSERT_EQ(number.isReal(), true);
+    ASSERT_EQ(number.real(), 18446744073709551616.000);
+
+    ret = forth::toInteger("92233720368547758078Z", 10, number);
+    ASSERT_EQ(ret, false);
 
     // Integer out of range error: convert to float
     ASSERT_EQ(forth.interpreter().m_base, 10);